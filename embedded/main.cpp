@@ -18,11 +18,22 @@
 
 #include "mbed.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 
 #include <peripheral/accel/accel.hpp>
 #include <peripheral/bc26/bc26.hpp>
 #include <peripheral/bc26/bc26_config.hpp>
+#include <peripheral/bc26/connection_manager.hpp>
+#include <peripheral/bc26/dns_cache.hpp>
+#include <peripheral/bc26/report_queue.hpp>
+#include <peripheral/bc26/transmit_scheduler.hpp>
+#include <peripheral/bc26/udp_reporter.hpp>
 #include <peripheral/buzzer/buzzer.hpp>
 #include <peripheral/feedback_message.hpp>
 #include <peripheral/feedback_message_queue.hpp>
@@ -31,16 +42,26 @@
 #include <utils/app.hpp>
 #include <utils/debug.hpp>
 #include <utils/msg_data.hpp>
+#include <utils/ring_buffer.hpp>
+#include <utils/utc_clock.hpp>
 
 using namespace std::literals;
 
 class Main
 {
     peripheral::feedback_message_queue fmq;
+    // TCP 指令 Socket 收到的数据。由 BC26 子模块写入，需要比 bc26 后析构。
+    utils::static_ring_buffer<512> rx_buffer;
+    // TCP 上报 Socket 收到的数据。只在指令使用单独的 Socket 时使用。
+    utils::static_ring_buffer<128> report_rx_buffer;
+    // 各 TCP Socket 上一次读出的数据中最后一个分隔符之后的部分，
+    // 即还没有收完的指令。
+    std::string rx_carry;
+    std::string report_rx_carry;
     peripheral::bc26 bc26{fmq};
-    mbed::DigitalOut gps_en{PIN_GPS_EN};
-    std::unique_ptr<peripheral::gps> gps{
-        std::make_unique<peripheral::gps>(fmq)};
+    // GPS 的辅助数据。由 GPS 子模块读写，需要比 gps 后析构。
+    peripheral::gps_aiding aiding{"/kv/gps"};
+    peripheral::gps gps{fmq, aiding};
     peripheral::accel accel{fmq};
     peripheral::buzzer buzzer;
     mbed::DigitalOut debug_led{PIN_LED};
@@ -49,8 +70,42 @@ class Main
     using pos_t = peripheral::nmea_parser::position_t;
 
     /**
-     * @brief 生成要发送的位置信息字符串。
-     * 格式：pos: 纬度,经度;
+     * @brief 把以 1e-7 度为单位的坐标格式化为度分格式。
+     * 服务器按度分格式解析，且不包含半球，因此取绝对值。
+     *
+     * @param value 坐标，单位 1e-7 度。
+     * @return std::string 形如 3150.78220 的字符串。
+     */
+    static std::string format_degree_minute(int32_t value)
+    {
+        uint32_t abs_value = value < 0 ? 0u - static_cast<uint32_t>(value)
+                                       : static_cast<uint32_t>(value);
+        uint32_t degree = abs_value / 10000000;
+        // 1e-7 度为 1e-5 分的 60 / 100 倍，四舍五入。
+        uint32_t minute = (abs_value % 10000000 * 3 + 2) / 5;
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%lu%02lu.%05lu",
+                      static_cast<unsigned long>(degree),
+                      static_cast<unsigned long>(minute / 100000),
+                      static_cast<unsigned long>(minute % 100000));
+        return buffer;
+    }
+    /**
+     * @brief 上报的时间戳。优先取定位时刻，没有时取当前时刻，
+     * 时钟也未校准时为 0。暂存后合并发送时，服务器据此排序。
+     */
+    static uint32_t report_utc(const pos_t& pos)
+    {
+        if (pos.utc)
+            return pos.utc;
+        if (utils::utc.is_valid())
+            return static_cast<uint32_t>(utils::utc.now());
+        return 0;
+    }
+    /**
+     * @brief 生成要发布的位置信息字符串。只用于 MQTT。
+     * 格式：t: UNIX 时间戳;pos: 纬度,经度;
+     * 时间戳为 0 时省略。
      *
      * @param pos 位置信息。
      * @return std::string 可发送的字符串。
@@ -59,12 +114,36 @@ class Main
     {
         if (!pos.is_valid)
             return "";
-        std::string ret = "pos: ";
-        ret += pos.latitude;
-        ret += "," + pos.longitude;
+        std::string ret;
+        if (uint32_t utc = report_utc(pos))
+            ret += "t: " + std::to_string(utc) + ";";
+        ret += "pos: ";
+        ret += format_degree_minute(pos.latitude);
+        ret += "," + format_degree_minute(pos.longitude);
         ret += ";";
         return ret;
     }
+    /**
+     * @brief 生成要发送的二进制位置记录。用于 TCP 与 UDP。
+     * 格式：UNIX 时间戳 (u32)，纬度 (i32)，经度 (i32)，单位 1e-7 度，小端。
+     * 定长 12 字节，合并发送时直接拼接，约为文本格式的三分之一。
+     *
+     * @param pos 位置信息。
+     * @return std::string 可发送的数据。位置无效时为空。
+     */
+    static std::string make_sent_record(const pos_t& pos)
+    {
+        if (!pos.is_valid)
+            return "";
+        const uint32_t values[] = {report_utc(pos),
+                                   static_cast<uint32_t>(pos.latitude),
+                                   static_cast<uint32_t>(pos.longitude)};
+        std::string ret;
+        for (uint32_t value : values)
+            for (int i = 0; i < 4; i++)
+                ret.push_back(static_cast<char>(value >> (i * 8) & 0xFF));
+        return ret;
+    }
 
     // 定义状态。
 
@@ -74,14 +153,78 @@ class Main
     sys_clock::time_point count_down_start_time = sys_clock::now();
     // 进入低功耗模式的倒计时预设时间。
     static constexpr auto count_down_elapse = 3min;
-    // 是否已经连接服务器。
-    bool is_server_connected = false;
+    // 进入低功耗模式的时刻。
+    sys_clock::time_point low_power_start_time = sys_clock::now();
+    // 上一次低功耗模式持续的时间。据此估计下一次唤醒的时刻。
+    sys_clock::duration last_low_power_duration{};
+    // GPS 保持备份模式的最长时间。超过后星历过期，备份模式不再有意义。
+    static constexpr auto gps_backup_elapse = 2h;
+    // GPS 处于备份模式时，切断电源的时刻。
+    std::optional<sys_clock::time_point> gps_backup_deadline;
+    // 与服务器连接的状态机。
+    peripheral::connection_manager connection;
+    // 服务器域名的解析结果。
+    peripheral::dns_cache dns{remote_transport == remote_transport_t::mqtt
+                                  ? mqtt_host
+                                  : remote_address,
+                              "/kv/dns"};
     // 上次发送的位置信息。
     pos_t last_pos{};
     // 上次收到心跳的时刻。
     sys_clock::time_point last_pulse_time = sys_clock::now();
     // 心跳维持的预设时间。
     static constexpr auto pulse_time_elapse = 2min;
+    // 卡号。用作 MQTT 客户端标识符。
+    std::string card_id;
+    // 上报使用的 Socket 服务索引。
+    static constexpr int report_connect_id = 0;
+    // 接收指令与心跳使用的 Socket 服务索引。
+    // 只有 TCP 且设置了指令端口时才单独使用一个 Socket。
+    static constexpr int command_connect_id =
+        remote_transport == remote_transport_t::tcp && remote_command_port ? 1
+                                                                           : 0;
+    // 本次连接的 AT+QIOPEN 是否已有失败的结果。
+    // 上报与指令使用两个 Socket 时，一次连接只算一次失败。
+    bool is_qiopen_failed{};
+    // 使用的 MQTT Socket 标识符。
+    static constexpr int mqtt_connect_id = 0;
+    // 上次发布消息使用的数据包标识符。
+    int mqtt_msg_id{};
+    // UDP 上报的序号、确认与重传。
+    peripheral::udp_reporter udp_reporter;
+    // 连接断开时暂存的上报。
+    peripheral::report_queue outbox{report_queue_policy, report_queue_capacity};
+    // 一次发送的上报的最大长度。QISEND 最多 1024 字节，留出 UDP 帧头的余量。
+    static constexpr size_t max_report_batch_length = 1000;
+    // 正在以数据模式发送的上报。BC26 子模块不复制数据，
+    // 收到 AT+QISEND 的反馈前不能修改。
+    std::string sending_report;
+    // 是否有上报在以数据模式发送。
+    bool is_report_sending{};
+    // 按信号质量安排上报的时机。
+    peripheral::transmit_scheduler scheduler{signal_sample_interval,
+                                             max_transmit_defer};
+    // 定时任务中已经为之尝试过发送的推迟时刻，同一时刻只尝试一次。
+    std::optional<sys_clock::time_point> flushed_defer_deadline;
+    // 上次调试输出 BC26 收发统计的时刻。
+    sys_clock::time_point last_stats_dump_time = sys_clock::now();
+    // 上次查询网络时间的时刻。
+    sys_clock::time_point last_cclk_time = sys_clock::now();
+
+    /**
+     * @brief 上报位置的 MQTT 主题。
+     */
+    std::string mqtt_report_topic() const
+    {
+        return mqtt_topic_prefix + card_id + "/pos";
+    }
+    /**
+     * @brief 接收指令的 MQTT 主题。
+     */
+    std::string mqtt_command_topic() const
+    {
+        return mqtt_topic_prefix + card_id + "/cmd";
+    }
 
     /**
      * @brief 系统是否处于低功耗模式。
@@ -90,6 +233,43 @@ class Main
     {
         return low_power_mode;
     }
+    /**
+     * @brief 是否可以向服务器发送数据。
+     * MQTT 需要订阅成功，TCP 与 UDP 打开 Socket 即可。
+     */
+    bool is_server_connected() const
+    {
+        using state_t = peripheral::connection_manager::state_t;
+        if (remote_transport == remote_transport_t::mqtt)
+            return connection.state() == state_t::healthy;
+        return connection.state() >= state_t::socket_open;
+    }
+    /**
+     * @brief 给定 Socket 收到的数据所写入的缓冲区。
+     */
+    utils::ring_buffer& rx_buffer_of(int connect_id)
+    {
+        if (connect_id == command_connect_id)
+            return rx_buffer;
+        return report_rx_buffer;
+    }
+    /**
+     * @brief 给定 Socket 还没有收完的指令。
+     */
+    std::string& rx_carry_of(int connect_id)
+    {
+        if (connect_id == command_connect_id)
+            return rx_carry;
+        return report_rx_carry;
+    }
+    /**
+     * @brief 是否是与服务器通信使用的 Socket。
+     */
+    static bool is_own_socket(int connect_id)
+    {
+        return connect_id == report_connect_id ||
+               connect_id == command_connect_id;
+    }
     /**
      * @brief 进入低功耗模式倒计时是否已结束。
      */
@@ -108,73 +288,341 @@ class Main
      * @brief 进入低功耗模式。
      * - 修改状态变量。
      * - 关闭 GPS。
+     * - 令 BC26 模块进入 PSM，并允许其睡眠。
      */
     void invoke_low_power_mode()
     {
         if (!low_power_mode)
         {
             utils::debug_printf("[I] Enter lp.\n");
+            bc26.send_at_cpsms(true, psm_periodic_tau, psm_active_time);
+            bc26.send_at_qsclk(1);
+            low_power_start_time = sys_clock::now();
+            power_down_gps();
         }
 
         low_power_mode = true;
-        gps.reset();
-        // 关闭 GPS。
-        gps_en = 1;
+    }
+    /**
+     * @brief 关闭 GPS。
+     * 上一次低功耗模式较短时，预计很快会再次唤醒，令模块进入备份模式，
+     * 保留星历，唤醒后几秒内即可定位。否则直接断电，下次冷启动。
+     */
+    void power_down_gps()
+    {
+        // 备份模式可能因超时转为断电，所以两种情况都读出星历。
+        gps.poll_aiding();
+        aiding.save();
+        bool is_backup = last_low_power_duration < gps_backup_elapse;
+        if (is_backup)
+        {
+            utils::debug_printf("[I] gps backup.\n");
+            gps_backup_deadline = sys_clock::now() + gps_backup_elapse;
+        }
+        gps.suspend(is_backup);
+    }
+    /**
+     * @brief 切断处于备份模式的 GPS 的电源。
+     */
+    void power_off_gps()
+    {
+        gps.power_off();
+        gps_backup_deadline.reset();
     }
     /**
      * @brief 退出低功耗模式。如果已经退出，只更新状态。
      * - 修改状态变量。
      * - 打开 GPS。
+     * - 令 BC26 模块退出 PSM，并恢复轮询。
      */
     void revoke_low_power_mode()
     {
         if (low_power_mode)
         {
             utils::debug_printf("[I] Exit lp.\n");
-            // TODO: 如果 GPS 的初始化不是什么都不干，需要补充。
-            gps = std::move(std::make_unique<peripheral::gps>(fmq));
+            last_low_power_duration = sys_clock::now() - low_power_start_time;
+            gps_backup_deadline.reset();
+            // 断电或备份模式下模块丢失配置，恢复时重新配置。
+            // 结果在 transfer 中处理。
+            gps.resume();
+
+            // 子模块会先唤醒 BC26 模块，再发送指令。
+            bc26.send_at_qsclk(0);
+            bc26.send_at_cpsms(false);
+            // 低功耗模式下不检查心跳，所以需要重新开始。
+            last_pulse_time = sys_clock::now();
+            // 读出可能漏掉的数据。
+            if (is_server_connected() &&
+                remote_transport == remote_transport_t::tcp)
+            {
+                bc26.send_at_qird_drain(rx_buffer, command_connect_id);
+                if (command_connect_id != report_connect_id)
+                    bc26.send_at_qird_drain(report_rx_buffer,
+                                            report_connect_id);
+            }
         }
 
         low_power_mode = false;
         renew_count_down();
-        // 打开 GPS。
-        gps_en = 0;
-
-        // 请求获得定位信息。
-        gps->request_notify();
     }
 
-    // 尝试连接服务器的次数。尝试次数太多直接重置整个系统。
-    int try_connect_times{};
     /**
-     * @brief 异步请求连接服务器。
+     * @brief 异步请求连接服务器。结果由对应的反馈消息处理。
+     * 没有有效的解析结果时先解析域名，解析完成后再连接。
      */
     void connect_server()
     {
-        try_connect_times++;
-        if (try_connect_times > 10)
+        auto address = dns.lookup();
+        if (!address)
+        {
+            bc26.send_at_qidnsgip(dns.host_name());
+            return;
+        }
+        connect_server(*address);
+    }
+    /**
+     * @brief 异步请求连接服务器的给定地址。
+     *
+     * @param address 服务器的 IP 地址。
+     */
+    void connect_server(const std::string& address)
+    {
+        if (remote_transport == remote_transport_t::mqtt)
         {
-            fmq.post_message(peripheral::feedback_message_enum_t::quit,
-                             nullptr);
+            // 先关闭可能残留的连接。结果不重要。
+            bc26.send_at_qmtclose(mqtt_connect_id);
+            bc26.send_at_qmtcfg_keepalive(mqtt_connect_id, mqtt_keep_alive);
+            // 保留会话，重连后服务器会补发离线期间的指令。
+            bc26.send_at_qmtcfg_session(mqtt_connect_id, false);
+            bc26.send_at_qmtopen(mqtt_connect_id, address, mqtt_port);
+        }
+        else if (remote_transport == remote_transport_t::udp)
+        {
+            // UDP 没有连接过程，打开 Socket 即可。
+            is_qiopen_failed = false;
+            bc26.send_at_qiclose(report_connect_id);
+            bc26.send_at_qiopen(address, remote_port, report_connect_id,
+                                false);
         }
         else
         {
             last_pulse_time = sys_clock::now(); // 更新心跳时间。
-            bc26.send_at_qiclose();
-            bc26.send_at_qiopen(remote_address, remote_port);
+            is_qiopen_failed = false;
+            bc26.send_at_qiclose(report_connect_id);
+            bc26.send_at_qiopen(address, remote_port, report_connect_id);
+            // 指令使用单独的 Socket，上报较慢时也能及时收到指令。
+            if (command_connect_id != report_connect_id)
+            {
+                bc26.send_at_qiclose(command_connect_id);
+                bc26.send_at_qiopen(address, remote_command_port,
+                                    command_connect_id);
+            }
         }
     }
     /**
-     * @brief 检查是否需要发送数据。如果需要，就发送 last_pos。
+     * @brief 把 last_pos 加入待发送的队列，并尝试发送。
      */
     void check_and_send_position()
     {
-        auto content = make_sent_string(last_pos);
-        if (is_server_connected) // 如果服务器已连接则发送，否则不发送。
+        outbox.push(remote_transport == remote_transport_t::mqtt
+                        ? make_sent_string(last_pos)
+                        : make_sent_record(last_pos));
+        flush_reports();
+    }
+    /**
+     * @brief 如果服务器已连接且覆盖不差，把队列中的上报合并为一次发送。
+     * 否则留在队列中，等连接恢复或覆盖好转后再发送。
+     */
+    void flush_reports()
+    {
+        if (!is_server_connected() || is_report_sending)
+            return;
+        // UDP 同时至多一条上报未确认，等确认或放弃后再发送下一批。
+        if (remote_transport == remote_transport_t::udp &&
+            udp_reporter.has_pending())
+            return;
+        if (outbox.empty() || outbox.is_in_flight())
+            return;
+        // 采样结果过期时先采样，得到结果后再决定是否发送。
+        if (scheduler.needs_sample())
+        {
+            scheduler.on_sampling();
+            bc26.send_at_qeng();
+            return;
+        }
+        // 只保留最近若干条时，队列将满则不再推迟，以免丢弃。
+        bool is_urgent = report_queue_policy ==
+                             peripheral::report_queue::policy_t::keep_all &&
+                         outbox.is_full();
+        bool was_deferring = scheduler.is_deferring();
+        if (!scheduler.should_send(is_urgent))
+        {
+            // 只在开始推迟时输出，推迟期间每次检查都会来到这里。
+            if (!was_deferring)
+                utils::debug_printf(
+                    "[I] poor coverage, %u reports deferred.\n",
+                    static_cast<unsigned>(outbox.size()));
+            return;
+        }
+        size_t n_dropped = outbox.take_n_dropped();
+        auto content = outbox.take_batch(max_report_batch_length);
+        if (content.empty())
+            return;
+        if (n_dropped)
+            utils::debug_printf("[W] %u reports dropped.\n",
+                                static_cast<unsigned>(n_dropped));
+        if (remote_transport == remote_transport_t::mqtt)
+        {
+            mqtt_msg_id = mqtt_msg_id % 65535 + 1; // 范围 1-65535。
+            bc26.send_at_qmtpub(mqtt_connect_id, mqtt_msg_id, 1, false,
+                                mqtt_report_topic(), content);
+        }
+        else if (remote_transport == remote_transport_t::udp)
+        {
+            send_report(udp_reporter.make_frame(content));
+        }
+        else
+        {
+            send_report(std::move(content));
+        }
+    }
+    /**
+     * @brief 以数据模式发送上报。上报是二进制的，不能用引号包围发送。
+     *
+     * @param data 要发送的数据。保存到发送完成为止。
+     */
+    void send_report(std::string data)
+    {
+        sending_report = std::move(data);
+        is_report_sending = true;
+        bc26.send_at_qisend_data(sending_report.data(), sending_report.size(),
+                                 report_connect_id);
+    }
+    /**
+     * @brief 连接失败或断开。由状态机决定何时、如何恢复。
+     */
+    void on_connection_failure()
+    {
+        utils::debug_printf("[W] connection failure.\n");
+        connection.on_failure();
+    }
+    /**
+     * @brief 执行状态机要求的恢复动作。
+     */
+    void check_connection()
+    {
+        using action_t = peripheral::connection_manager::action_t;
+        switch (connection.poll())
+        {
+        case action_t::check_attach:
+        {
+            bc26.send_at_cgatt_get();
+            break;
+        }
+        case action_t::open_socket:
+        {
+            connect_server();
+            break;
+        }
+        case action_t::toggle_cfun:
+        {
+            utils::debug_printf("[W] toggle cfun.\n");
+            bc26.send_at_cfun_set(0);
+            bc26.send_at_cfun_set(1);
+            connection.retry_now(); // 接着查询是否已附着网络。
+            break;
+        }
+        case action_t::reset_module:
+        {
+            // 只重置 BC26 模块，不影响 GPS 与加速度计。
+            utils::debug_printf("[W] reset bc26.\n");
+            bc26.init();
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    /**
+     * @brief 检查定时任务。包括连接的恢复、心跳的检查、UDP 上报的重传与
+     * 统计的输出。
+     */
+    void check_timers()
+    {
+        check_connection();
+        // TCP 下如果长时间没有收到心跳，则认为已断开连接。
+        // 低功耗模式下不检查，退出时重新开始计时。
+        if (remote_transport == remote_transport_t::tcp &&
+            !is_low_power_mode() && is_server_connected() &&
+            sys_clock::now() - last_pulse_time > pulse_time_elapse)
+        {
+            utils::debug_printf("[W] pulse reset\n");
+            on_connection_failure();
+        }
+        // 调试输出不需要唤醒，所以不计入 next_deadline。
+        if (sys_clock::now() - last_stats_dump_time >= bc26_stats_dump_interval)
+        {
+            last_stats_dump_time = sys_clock::now();
+            bc26.dump_stats();
+        }
+        // 时钟长时间没有校准时（例如 GPS 一直关闭），重新查询网络时间。
+        // 不急于校准，所以也不计入 next_deadline。
+        if (utils::utc.since_sync() >= clock_resync_interval &&
+            sys_clock::now() - last_cclk_time >= clock_resync_interval)
+        {
+            last_cclk_time = sys_clock::now();
+            bc26.send_at_cclk();
+        }
+        // GPS 长时间处于备份模式时，星历已经过期，切断电源。
+        if (gps_backup_deadline && sys_clock::now() >= *gps_backup_deadline)
         {
-            bc26.send_at_qisend(content);
+            utils::debug_printf("[I] gps power off.\n");
+            power_off_gps();
+        }
+        bool was_pending = udp_reporter.has_pending();
+        // 上次的数据还在发送时不能替换，等发送完成后再检查重传。
+        std::optional<std::string> frame;
+        if (!is_report_sending)
+            frame = udp_reporter.poll_retransmit();
+        if (frame && is_server_connected())
+        {
+            utils::debug_printf("[W] udp retransmit.\n");
+            send_report(std::move(*frame));
+        }
+        // 放弃重传时，发送中的上报放回队列头部，接着重新发送。
+        if (was_pending && !udp_reporter.has_pending())
+        {
+            utils::debug_printf("[W] udp give up.\n");
+            outbox.on_sent(false);
+            flush_reports();
+        }
+        // 推迟期间，到了重新采样或推迟到期的时刻再尝试发送。
+        // 其余的发送时机都由事件触发，不需要在这里反复尝试。
+        auto defer_deadline = scheduler.next_deadline();
+        if (defer_deadline && sys_clock::now() >= *defer_deadline &&
+            defer_deadline != flushed_defer_deadline)
+        {
+            flushed_defer_deadline = defer_deadline;
+            flush_reports();
         }
     }
+    /**
+     * @brief 下一次需要检查定时任务的时刻。没有定时任务时为空。
+     */
+    std::optional<sys_clock::time_point> next_deadline() const
+    {
+        std::optional<sys_clock::time_point> ret;
+        // 已经尝试过的推迟时刻不再唤醒，否则会立即返回而空转。
+        auto defer_deadline = scheduler.next_deadline();
+        if (defer_deadline == flushed_defer_deadline)
+            defer_deadline.reset();
+        for (auto deadline :
+             {connection.next_deadline(), udp_reporter.next_deadline(),
+              defer_deadline, gps_backup_deadline})
+            if (deadline && (!ret || *deadline < *ret))
+                ret = deadline;
+        return ret;
+    }
     /**
      * @brief 根据远程发送的指令进行操作。
      *
@@ -238,12 +686,12 @@ class Main
             }
             case fmq_e_t::bc26_init:
             {
-                // TODO: 记录并使用辅助信息。
                 auto [is_success, card_id, is_activated, intensity] =
                     msg_data<std::tuple<bool, std::string, bool, int>>(msg);
                 if (is_success)
                 {
                     utils::debug_printf("[D] Init bc26.\n");
+                    on_bc26_init(card_id, is_activated, intensity);
                 }
                 else
                 {
@@ -262,9 +710,8 @@ class Main
                 }
                 else
                 {
-                    utils::debug_printf("[F] Init gps.\n");
-                    // 一个模块初始化失败则整体初始化失败。
-                    return false;
+                    // 配置失败时模块仍按出厂设置输出 NMEA，不影响定位。
+                    utils::debug_printf("[W] Init gps.\n");
                 }
                 break;
             }
@@ -289,8 +736,11 @@ class Main
             // 低功耗？
             if (is_low_power_mode())
             {
-                // 等待。
-                msg = fmq.get_message();
+                // 等待。有定时任务时，至多等待到定时任务的时刻。
+                if (auto deadline = next_deadline())
+                    msg = fmq.get_message_until(*deadline);
+                else
+                    msg = fmq.get_message();
             }
             else
             {
@@ -311,7 +761,7 @@ class Main
         using fmq_e_t = peripheral::feedback_message_enum_t;
         switch (msg.first)
         {
-        // 非低功耗模式下，进行额外的处理与控制。
+        // 非低功耗模式下或等待超时，进行额外的处理与控制。
         case fmq_e_t::null:
         {
             on_idle();
@@ -330,6 +780,53 @@ class Main
             on_gps_notify(pos);
             break;
         }
+        // 运行中重置 BC26 模块后的初始化结果。
+        case fmq_e_t::bc26_init:
+        {
+            using param_type = std::tuple<bool, std::string, bool, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            if (std::get<0>(t))
+                on_bc26_init(std::get<1>(t), std::get<2>(t), std::get<3>(t));
+            else
+                on_connection_failure();
+            break;
+        }
+        case fmq_e_t::bc26_send_at_cgatt_get:
+        {
+            using param_type = std::tuple<bool, bool>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_cgatt_get(std::get<0>(t), std::get<1>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qeng:
+        {
+            using param_type = std::tuple<bool, int, int, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qeng(std::get<0>(t), std::get<1>(t),
+                                 std::get<2>(t), std::get<3>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_cclk:
+        {
+            using param_type = std::tuple<bool, int64_t>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_cclk(std::get<0>(t), std::get<1>(t));
+            break;
+        }
+        case fmq_e_t::bc26_nitz:
+        {
+            auto epoch = utils::msg_data<int64_t>(msg);
+            on_bc26_nitz(epoch);
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qidnsgip:
+        {
+            using param_type = std::tuple<bool, std::string, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qidnsgip(std::get<0>(t), std::get<1>(t),
+                                     std::get<2>(t));
+            break;
+        }
         case fmq_e_t::bc26_send_at_qiopen:
         {
             using param_type = std::tuple<bool, int, int>;
@@ -340,21 +837,102 @@ class Main
         }
         case fmq_e_t::bc26_send_at_qiclose:
         {
-            auto is_ok = utils::msg_data<bool>(msg);
-            on_bc26_send_at_qiclose(is_ok);
+            using param_type = std::tuple<bool, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qiclose(std::get<0>(t), std::get<1>(t));
             break;
         }
         case fmq_e_t::bc26_send_at_qisend:
         {
-            auto is_ok = utils::msg_data<bool>(msg);
-            on_bc26_send_at_qisend(is_ok);
+            using param_type = std::tuple<bool, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qisend(std::get<0>(t), std::get<1>(t));
             break;
         }
         case fmq_e_t::bc26_send_at_qird:
         {
-            using param_type = std::tuple<bool, std::string>;
+            using param_type = std::tuple<bool, std::string, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qird(std::get<0>(t), std::get<1>(t),
+                                 std::get<2>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qird_drain:
+        {
+            using param_type = std::tuple<bool, size_t, bool, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qird_drain(std::get<0>(t), std::get<1>(t),
+                                       std::get<2>(t), std::get<3>(t));
+            break;
+        }
+        case fmq_e_t::bc26_qiurc_closed:
+        {
+            auto connect_id = utils::msg_data<int>(msg);
+            on_bc26_qiurc_closed(connect_id);
+            break;
+        }
+        case fmq_e_t::bc26_qiurc_recv:
+        {
+            auto connect_id = utils::msg_data<int>(msg);
+            on_bc26_qiurc_recv(connect_id);
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qmtopen:
+        {
+            using param_type = std::tuple<bool, int, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qmtopen(std::get<0>(t), std::get<2>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qmtconn:
+        {
+            using param_type = std::tuple<bool, int, int, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qmtconn(std::get<0>(t), std::get<2>(t),
+                                    std::get<3>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qmtsub:
+        {
+            using param_type = std::tuple<bool, int, int, int, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qmtsub(std::get<0>(t), std::get<3>(t),
+                                   std::get<4>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_qmtpub:
+        {
+            using param_type = std::tuple<bool, int, int, int>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_send_at_qmtpub(std::get<0>(t), std::get<3>(t));
+            break;
+        }
+        case fmq_e_t::bc26_mqtt_recv:
+        {
+            using param_type = std::tuple<int, int, std::string, std::string>;
+            const auto& t = utils::msg_data<param_type>(msg);
+            on_bc26_mqtt_recv(std::get<2>(t), std::get<3>(t));
+            break;
+        }
+        case fmq_e_t::bc26_mqtt_stat:
+        {
+            using param_type = std::tuple<int, int>;
             const auto& t = utils::msg_data<param_type>(msg);
-            on_bc26_send_at_qird(std::get<0>(t), std::get<1>(t));
+            on_bc26_mqtt_stat(std::get<1>(t));
+            break;
+        }
+        case fmq_e_t::bc26_send_at_cpsms:
+        case fmq_e_t::bc26_send_at_qsclk:
+        {
+            auto is_ok = utils::msg_data<bool>(msg);
+            on_bc26_power_saving(is_ok);
+            break;
+        }
+        // 退出低功耗模式后重新配置 GPS 的结果。
+        case fmq_e_t::gps_init:
+        {
+            auto is_success = utils::msg_data<bool>(msg);
+            utils::debug_printf("[%c] Init gps.\n", is_success ? 'D' : 'W');
             break;
         }
         default:
@@ -363,13 +941,14 @@ class Main
     }
     /**
      * @brief 非低功耗模式下，轮询检查是否进入低功耗模式。
+     * 低功耗模式下，等待超时时检查定时任务。
      *
      * @note 轮询是最简单的，也能保证系统的响应速度最快。
      */
     void on_idle()
     {
-        // 此时一定处于非低功耗模式。
-        if (is_count_down_timeout())
+        check_timers();
+        if (!is_low_power_mode() && is_count_down_timeout())
         {
             // 进入低功耗模式。进入后就一定不会进入 on_idle。
             invoke_low_power_mode();
@@ -391,67 +970,315 @@ class Main
 
         // 发送位置。
         check_and_send_position();
-
-        // 如果是非低功耗模式，则请求下一次 GPS 信息。
-        if (!is_low_power_mode())
+    }
+    void on_bc26_send_at_qidnsgip(bool is_ok, const std::string& address,
+                                  int ttl)
+    {
+        if (is_ok)
+            dns.on_resolved(address, ttl);
+        // 解析失败时使用最近一次解析成功的地址。
+        auto last_good = dns.last_good();
+        if (!last_good)
         {
-            gps->request_notify();
+            utils::debug_printf("[W] dns failure.\n");
+            on_connection_failure();
+            return;
         }
+        if (!is_ok)
+            utils::debug_printf("[W] dns failure, use %s.\n",
+                                last_good->c_str());
+        connect_server(*last_good);
     }
     void on_bc26_send_at_qiopen(bool is_ok, int connect_id, int result)
     {
+        using state_t = peripheral::connection_manager::state_t;
         if (is_ok && !result) // 如果服务器连接成功。
         {
-            is_server_connected = true; // 更新状态。
-            bc26.send_at_qird();        // 开始轮询。
+            // 收到数据时模块会主动上报，不需要轮询。
+            // UDP 收到服务器的数据报之前，不能确认服务器可达。
+            if (remote_transport == remote_transport_t::udp)
+            {
+                connection.set_state(state_t::socket_open);
+            }
+            else
+            {
+                // 之后收到数据时模块会主动上报，先读出已经收到的数据。
+                auto& buffer = rx_buffer_of(connect_id);
+                buffer.clear();
+                rx_carry_of(connect_id).clear();
+                bc26.send_at_qird_drain(buffer, connect_id);
+                // 上报与指令的 Socket 都打开后才算连接成功。
+                if (!bc26.is_socket_open(report_connect_id) ||
+                    !bc26.is_socket_open(command_connect_id))
+                    return;
+                connection.set_state(state_t::healthy);
+            }
+            // 发送断开期间暂存的上报。
+            flush_reports();
         }
         else
         {
-            is_server_connected = false; // 保证状态变量正确。
-            // 等待 5 s 后，尝试重新连接服务器。
-            rtos::ThisThread::sleep_for(5s);
-            connect_server();
+            // 两个 Socket 都打开失败时，只算一次失败。
+            if (is_qiopen_failed)
+                return;
+            is_qiopen_failed = true;
+            // 服务器的地址可能已经变化，下次重新解析。
+            dns.invalidate();
+            on_connection_failure();
         }
     }
-    void on_bc26_send_at_qiclose(bool is_ok)
+    void on_bc26_send_at_qiclose(bool is_ok, int connect_id)
     {
-        is_server_connected = false; // 更新状态。
-        // 如果失败，就尝试重连。在 qiopen 中处理。
+        // 关闭只是打开前的清理，状态由 qiopen 的结果决定。
     }
-    void on_bc26_send_at_qisend(bool is_ok)
+    void on_bc26_send_at_qisend(bool is_ok, int connect_id)
     {
-        // 如果失败，认为服务器已断开连接。
+        // 只有上报使用 AT+QISEND。
+        if (connect_id != report_connect_id)
+            return;
+        is_report_sending = false;
+        // 如果失败，认为服务器已断开连接。发送中的上报放回队列。
+        if (!is_ok)
+        {
+            // UDP 的上报已放回队列，不再重传，避免重复。
+            if (remote_transport == remote_transport_t::udp &&
+                outbox.is_in_flight())
+                udp_reporter.reset();
+            outbox.on_sent(false);
+            on_connection_failure();
+            return;
+        }
+        // UDP 发送成功不代表服务器已收到，收到确认后才算发送成功。
+        if (remote_transport == remote_transport_t::udp)
+            return;
+        outbox.on_sent(true);
+        flush_reports();
+    }
+    void on_bc26_qiurc_closed(int connect_id)
+    {
+        // 服务器主动关闭了连接，立即重连，而不是等到下次收发失败。
+        if (remote_transport != remote_transport_t::mqtt &&
+            is_own_socket(connect_id))
+        {
+            utils::debug_printf("[W] socket %d closed.\n", connect_id);
+            on_connection_failure();
+        }
+    }
+    void on_bc26_qiurc_recv(int connect_id)
+    {
+        if (!is_server_connected() || !is_own_socket(connect_id))
+            return;
+        // UDP 一次读取一个数据报，TCP 一次读完。
+        if (remote_transport == remote_transport_t::udp)
+            bc26.send_at_qird(connect_id);
+        else if (remote_transport == remote_transport_t::tcp)
+            bc26.send_at_qird_drain(rx_buffer_of(connect_id), connect_id);
+    }
+    void on_bc26_send_at_qmtopen(bool is_ok, int result)
+    {
+        // 2 表示标识符被占用，说明网络已经打开。
+        if (is_ok && (!result || result == 2))
+        {
+            connection.set_state(
+                peripheral::connection_manager::state_t::socket_open);
+            bc26.send_at_qmtconn(mqtt_connect_id, card_id, mqtt_username,
+                                 mqtt_password);
+        }
+        else
+        {
+            // 服务器的地址可能已经变化，下次重新解析。
+            dns.invalidate();
+            on_connection_failure();
+        }
+    }
+    void on_bc26_send_at_qmtconn(bool is_ok, int result, int ret_code)
+    {
+        if (is_ok && !result && !ret_code) // 如果服务器接受连接。
+        {
+            // 会话恢复时订阅仍然存在，重复订阅也没有副作用。
+            bc26.send_at_qmtsub(mqtt_connect_id, 1, mqtt_command_topic(), 1);
+        }
+        else
+        {
+            on_connection_failure();
+        }
+    }
+    void on_bc26_send_at_qmtsub(bool is_ok, int result, int value)
+    {
+        // value 为 128 表示服务器拒绝订阅。
+        if (is_ok && !result && value != 128)
+        {
+            utils::debug_printf("[I] mqtt connected.\n");
+            // 更新状态。之后不需要轮询。
+            connection.set_state(
+                peripheral::connection_manager::state_t::healthy);
+            // 发送断开期间暂存的上报。
+            flush_reports();
+        }
+        else
+        {
+            on_connection_failure();
+        }
+    }
+    void on_bc26_send_at_qmtpub(bool is_ok, int result)
+    {
+        // 如果失败，认为服务器已断开连接。重传不算失败。
+        bool is_success = is_ok && result != 2;
+        outbox.on_sent(is_success);
+        if (!is_success)
+        {
+            on_connection_failure();
+            return;
+        }
+        flush_reports();
+    }
+    void on_bc26_mqtt_recv(const std::string& topic,
+                           const std::string& payload)
+    {
+        if (topic == mqtt_command_topic())
+            check_command(payload);
+    }
+    void on_bc26_mqtt_stat(int err_code)
+    {
+        // 收到该消息说明 MQTT 连接已断开。
+        utils::debug_printf("[W] mqtt stat %d.\n", err_code);
+        on_connection_failure();
+    }
+    void on_bc26_init(const std::string& card_id, bool is_activated,
+                      int intensity)
+    {
+        using state_t = peripheral::connection_manager::state_t;
+        this->card_id = card_id;
+        // 初始化时已经查询过信号强度，作为第一次采样。
+        scheduler.on_sample(
+            peripheral::transmit_scheduler::from_cesq(intensity));
+        // 卡号各不相同，用作抖动的种子。
+        auto seed = std::hash<std::string>{}(card_id);
+        connection.seed(static_cast<uint32_t>(seed));
+        connection.set_state(is_activated ? state_t::attached
+                                          : state_t::detached);
+        connection.retry_now();
+        // 重置后模块的上报设置会丢失。之后网络时间变化时主动上报。
+        bc26.send_at_ctzr(3);
+        bc26.send_at_cclk();
+        // 重置后模块的 DNS 设置会丢失。
+        if (*dns_primary_server)
+            bc26.send_at_qidnscfg(dns_primary_server, dns_secondary_server);
+        // 重置后模块的睡眠设置会丢失。
+        if (is_low_power_mode())
+        {
+            bc26.send_at_cpsms(true, psm_periodic_tau, psm_active_time);
+            bc26.send_at_qsclk(1);
+        }
+    }
+    void on_bc26_send_at_cclk(bool is_ok, int64_t epoch)
+    {
+        // 还没有从网络获取到时间时会失败，之后由 +CTZEU 上报。
         if (!is_ok)
+            return;
+        on_bc26_nitz(epoch);
+    }
+    void on_bc26_nitz(int64_t epoch)
+    {
+        using source_t = utils::utc_clock::source_t;
+        if (utils::utc.on_sync(epoch, source_t::network))
+            utils::debug_printf("[I] network time %lld.\n",
+                                static_cast<long long>(epoch));
+    }
+    void on_bc26_send_at_qeng(bool is_ok, int rsrp, int sinr, int ecl)
+    {
+        using scheduler_t = peripheral::transmit_scheduler;
+        // 采样失败时不推迟，照常发送。
+        if (is_ok)
+        {
+            utils::debug_printf("[I] rsrp %d dBm, sinr %d dB, ecl %d.\n", rsrp,
+                                sinr, ecl);
+            scheduler.on_sample(scheduler_t::from_qeng(rsrp, ecl));
+        }
+        else
         {
-            is_server_connected = false;
-            connect_server(); // 异步请求重新连接服务器。
+            scheduler.on_sample(scheduler_t::coverage_t::unknown);
         }
+        flush_reports();
     }
-    void on_bc26_send_at_qird(bool is_ok, const std::string& content)
+    void on_bc26_send_at_cgatt_get(bool is_ok, bool is_activated)
     {
-        // 如果失败，认为服务器已断开连接。
+        if (is_ok && is_activated)
+        {
+            connection.set_state(
+                peripheral::connection_manager::state_t::attached);
+            connection.retry_now(); // 接着打开 Socket。
+        }
+        else
+        {
+            on_connection_failure();
+        }
+    }
+    void on_bc26_power_saving(bool is_ok)
+    {
+        // 省电设置失败不影响功能，只是功耗更高。
+        if (!is_ok)
+            utils::debug_printf("[W] bc26 power saving.\n");
+    }
+    void on_bc26_send_at_qird(bool is_ok, const std::string& content,
+                              int connect_id)
+    {
+        // 只有 UDP 使用。如果失败，认为 Socket 已不可用。
         if (!is_ok)
         {
-            is_server_connected = false;
-            connect_server(); // 异步请求重新连接服务器。
+            on_connection_failure();
             return;
         }
-        // 否则，根据内容转移状态，并且等待 1 s 轮询。
-        if (content.length())
-            check_command(content);
-        // 如果没有收到心跳，则认为已断开连接。
-        if (sys_clock::now() - last_pulse_time > pulse_time_elapse)
+        if (content.empty())
+            return;
+        // 收到服务器的数据报，说明服务器可达。
+        connection.set_state(peripheral::connection_manager::state_t::healthy);
+        // 确认中可能捎带指令。
+        bool was_pending = udp_reporter.has_pending();
+        auto command = udp_reporter.on_datagram(content);
+        // 上报已确认，发送中的上报才算发送成功。
+        if (was_pending && !udp_reporter.has_pending())
+            outbox.on_sent(true);
+        if (command.length())
+            check_command(command);
+        // 上一条上报可能已确认，接着发送队列中的上报。
+        flush_reports();
+        // 一次只读出一个数据报，可能还有剩余，继续读取。
+        bc26.send_at_qird(connect_id);
+    }
+    void on_bc26_send_at_qird_drain(bool is_ok, size_t total, bool is_complete,
+                                    int connect_id)
+    {
+        // 只有 TCP 使用。如果失败，认为服务器已断开连接。
+        auto& rx_buffer = rx_buffer_of(connect_id);
+        auto& carry = rx_carry_of(connect_id);
+        if (!is_ok)
         {
-            utils::debug_printf("[W] pulse reset\n");
-            is_server_connected = false;
-            connect_server(); // 异步请求重新连接服务器。
+            rx_buffer.clear();
+            carry.clear();
+            on_connection_failure();
+            return;
         }
-        else if (is_server_connected)
+        // 指令之间以空白字符分隔，服务器在每条指令后加换行。
+        // 一条指令可能被拆到两次读取中，最后一个分隔符之后的部分留到下次。
+        std::string content = std::move(carry) + rx_buffer.read_all();
+        carry.clear();
+        size_t begin = 0;
+        while (true)
         {
-            // 等待 1 s 轮询。
-            rtos::ThisThread::sleep_for(1s);
-            bc26.send_at_qird();
+            auto end = content.find_first_of(" \t\r\n", begin);
+            if (end == std::string::npos)
+                break;
+            if (end > begin)
+                check_command(content.substr(begin, end - begin));
+            begin = end + 1;
         }
+        // 没有分隔符的超长数据不是指令，丢弃。
+        if (content.length() - begin <= rx_buffer.capacity())
+            carry = content.substr(begin);
+        // 缓冲区满了，模块中还有数据。
+        if (!is_complete)
+            bc26.send_at_qird_drain(rx_buffer, connect_id);
     }
 
 public:
@@ -462,6 +1289,11 @@ public:
         rtos::ThisThread::sleep_for(50ms);
         debug_led = 1;
 
+        // 重启前解析的服务器地址。解析失败时使用。
+        dns.load();
+        // 上次关机前的位置。GPS 上电时注入。
+        aiding.load();
+
         // 异步初始化各模块。
         {
             utils::debug_printf("[-] Init accel.\n");
@@ -469,7 +1301,7 @@ public:
             utils::debug_printf("[-] Init bc26.\n");
             bc26.init();
             utils::debug_printf("[-] Init gps.\n");
-            gps->init();
+            gps.init();
         }
 
         // 等待初始化完成。
@@ -479,12 +1311,12 @@ public:
             return; // 异常情况，退出。
         }
 
-        // 连接服务器。
-        connect_server();
+        // 连接服务器。由状态机在空闲时发起。
+        connection.retry_now();
 
         // 获取位置并发送。
-        // 请求等待 GPS 模块发送第一条定位信息。
-        gps->request_notify();
+        // 订阅定位信息，GPS 模块每次定位后发送通知。
+        gps.subscribe_notify();
 
         // 消息循环。
         main_loop();
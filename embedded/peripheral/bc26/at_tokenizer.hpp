@@ -0,0 +1,488 @@
+/**
+ * @file at_tokenizer.hpp
+ * @author UnnamedOrange
+ * @brief AT 指令回复的分词器。不分配内存，不依赖 Mbed。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace peripheral
+{
+    /**
+     * @brief AT 指令回复中一行的类型。
+     */
+    enum class at_line_type_t : uint8_t
+    {
+        /**
+         * @brief 最终结果码 OK。
+         */
+        ok,
+        /**
+         * @brief 表示失败的最终结果码。ERROR、+CME ERROR: <n> 或 SEND FAIL。
+         */
+        error,
+        /**
+         * @brief 其他结果码。例如 SEND OK、CLOSE OK。
+         */
+        result,
+        /**
+         * @brief 数据模式的提示符 >。
+         */
+        prompt,
+        /**
+         * @brief 信息响应。+<前缀>: <参数>。
+         */
+        information,
+        /**
+         * @brief 模块主动上报的消息（URC）。前缀在已知的 URC 表中。
+         */
+        urc,
+        /**
+         * @brief 指令的回显。以 AT 开头。
+         */
+        echo,
+        /**
+         * @brief 其他文本。例如 AT+CIMI 返回的卡号。
+         */
+        text,
+    };
+
+    /**
+     * @brief 以逗号分隔的参数。引号内的逗号不分隔参数。
+     */
+    class at_fields
+    {
+    private:
+        std::string_view _rest;
+        bool _is_end;
+
+    public:
+        explicit at_fields(std::string_view params)
+            : _rest(params), _is_end(params.empty())
+        {
+        }
+
+        /**
+         * @brief 去掉首尾成对的引号。
+         */
+        static std::string_view unquote(std::string_view field)
+        {
+            if (field.length() >= 2 && field.front() == '"' &&
+                field.back() == '"')
+                field = field.substr(1, field.length() - 2);
+            return field;
+        }
+        /**
+         * @brief 解析十进制整数。允许首尾的空格与引号。
+         *
+         * @return bool 是否是完整的整数。
+         */
+        static bool parse_int(std::string_view field, int& value)
+        {
+            while (!field.empty() && field.front() == ' ')
+                field.remove_prefix(1);
+            while (!field.empty() && field.back() == ' ')
+                field.remove_suffix(1);
+            field = unquote(field);
+            bool is_negative = false;
+            if (!field.empty() &&
+                (field.front() == '-' || field.front() == '+'))
+            {
+                is_negative = field.front() == '-';
+                field.remove_prefix(1);
+            }
+            if (field.empty() || field.length() > 10)
+                return false;
+            int64_t ret = 0;
+            for (char ch : field)
+            {
+                if (ch < '0' || ch > '9')
+                    return false;
+                ret = ret * 10 + (ch - '0');
+            }
+            if (ret > INT32_MAX)
+                return false;
+            value = static_cast<int>(is_negative ? -ret : ret);
+            return true;
+        }
+
+    public:
+        /**
+         * @brief 是否还有参数。
+         */
+        bool has_next() const
+        {
+            return !_is_end;
+        }
+        /**
+         * @brief 取出下一个参数，不去掉引号。
+         *
+         * @return bool 是否还有参数。
+         */
+        bool next_raw(std::string_view& field)
+        {
+            if (_is_end)
+                return false;
+            bool is_quoted = false;
+            size_t i = 0;
+            for (; i < _rest.length(); i++)
+            {
+                if (_rest[i] == '"')
+                    is_quoted = !is_quoted;
+                else if (_rest[i] == ',' && !is_quoted)
+                    break;
+            }
+            field = _rest.substr(0, i);
+            if (i < _rest.length())
+                _rest.remove_prefix(i + 1);
+            else
+                _is_end = true;
+            return true;
+        }
+        /**
+         * @brief 取出下一个参数，并去掉引号。
+         */
+        bool next(std::string_view& field)
+        {
+            if (!next_raw(field))
+                return false;
+            field = unquote(field);
+            return true;
+        }
+        /**
+         * @brief 取出下一个参数，并解析为整数。
+         */
+        bool next(int& value)
+        {
+            std::string_view field;
+            return next_raw(field) && parse_int(field, value);
+        }
+        /**
+         * @brief 剩余的全部内容，不再分隔。用于可能包含逗号的最后一个参数。
+         */
+        std::string_view rest() const
+        {
+            return _is_end ? std::string_view() : _rest;
+        }
+    };
+
+    /**
+     * @brief AT 指令回复中的一行。均指向原始输入，不包含换行。
+     */
+    struct at_line_t
+    {
+        at_line_type_t type;
+        /**
+         * @brief 整行内容。
+         */
+        std::string_view text;
+        /**
+         * @brief 前缀，包含 +，不包含冒号。例如 +QIOPEN。没有前缀时为空。
+         */
+        std::string_view prefix;
+        /**
+         * @brief 冒号之后的参数，去掉了开头的空格。
+         */
+        std::string_view params;
+
+        /**
+         * @brief 依次解析参数。参数的类型可以是 int 或 std::string_view。
+         *
+         * @return size_t 成功解析的参数个数。
+         */
+        template <typename... T>
+        size_t parse(T&... out) const
+        {
+            at_fields fields{params};
+            size_t n_parsed = 0;
+            bool is_ok = true;
+            // 遇到第一个失败后不再解析。
+            ((is_ok = is_ok && fields.next(out), n_parsed += is_ok), ...);
+            return n_parsed;
+        }
+    };
+
+    /**
+     * @brief AT 指令回复的分词器。一次遍历，把收到的内容分为有类型的行。
+     *
+     * @note 不分配内存，所有结果都指向原始输入，输入需在使用结果期间有效。
+     */
+    class at_tokenizer
+    {
+    private:
+        struct code_t
+        {
+            std::string_view text;
+            at_line_type_t type;
+        };
+        /**
+         * @brief 整行匹配的结果码。
+         */
+        static constexpr std::array<code_t, 5> codes{{
+            {"OK", at_line_type_t::ok},
+            {"ERROR", at_line_type_t::error},
+            {"SEND OK", at_line_type_t::result},
+            {"SEND FAIL", at_line_type_t::error},
+            {"CLOSE OK", at_line_type_t::result},
+        }};
+        /**
+         * @brief 已知的 URC 前缀。指令的异步结果（例如 +QIOPEN）
+         * 不在其中，视为信息响应。
+         */
+        static constexpr std::array<std::string_view, 9> urc_prefixes{{
+            "+QIURC",
+            "+QMTRECV",
+            "+QMTSTAT",
+            "+QMTPING",
+            "+CEREG",
+            "+CSCON",
+            "+QATWAKEUP",
+            "+CEDRXP",
+            "+CTZEU",
+        }};
+
+        /**
+         * @brief 比较两个字符串是否相同。先比较长度，再从末尾逐个比较。
+         * 前缀的开头通常相同（例如 +QI、+QM），末尾的区分度更高。
+         */
+        static bool equals(std::string_view a, std::string_view b)
+        {
+            if (a.length() != b.length())
+                return false;
+            for (size_t i = a.length(); i-- > 0;)
+                if (a[i] != b[i])
+                    return false;
+            return true;
+        }
+
+    public:
+        /**
+         * @brief 对一行分类。
+         *
+         * @param text 不包含换行的一行。不能为空。
+         * @param line 分类的结果。直接写入输出，避免复制。
+         */
+        static void classify(std::string_view text, at_line_t& line)
+        {
+            line.type = at_line_type_t::text;
+            line.text = text;
+            line.prefix = std::string_view();
+            line.params = std::string_view();
+            char first = text.front();
+            if (first == '>')
+            {
+                line.type = at_line_type_t::prompt;
+                return;
+            }
+            if (first != '+')
+            {
+                // 先比较首字符，大多数行只需比较一次。
+                for (const auto& code : codes)
+                {
+                    if (first == code.text.front() && equals(text, code.text))
+                    {
+                        line.type = code.type;
+                        return;
+                    }
+                }
+            }
+            else
+            {
+                auto colon = text.find(':');
+                if (colon == std::string_view::npos)
+                    return;
+                line.prefix = std::string_view(text.data(), colon);
+                line.params = std::string_view(text.data() + colon + 1,
+                                               text.length() - colon - 1);
+                while (!line.params.empty() && line.params.front() == ' ')
+                    line.params.remove_prefix(1);
+                if (equals(line.prefix, "+CME ERROR"))
+                    line.type = at_line_type_t::error;
+                else
+                {
+                    line.type = at_line_type_t::information;
+                    for (const auto& prefix : urc_prefixes)
+                    {
+                        if (equals(line.prefix, prefix))
+                        {
+                            line.type = at_line_type_t::urc;
+                            break;
+                        }
+                    }
+                }
+                return;
+            }
+            if (text.length() >= 2 && (text[0] == 'A' || text[0] == 'a') &&
+                (text[1] == 'T' || text[1] == 't'))
+                line.type = at_line_type_t::echo;
+        }
+        /**
+         * @brief 分词。空行被忽略。
+         *
+         * 不以换行结束的最后一行被视为不完整，不输出，除非它是提示符 >。
+         *
+         * @param input 收到的内容。
+         * @param out 输出的行。
+         * @param max_lines 至多输出的行数。
+         * @param complete_length 输出完整行所占的字节数。
+         * 可以从输入中移除这些字节，保留不完整的部分。
+         * @return size_t 输出的行数。
+         */
+        static size_t tokenize(std::string_view input, at_line_t* out,
+                               size_t max_lines, size_t* complete_length)
+        {
+            size_t n_lines = 0;
+            const char* const begin = input.data();
+            const char* const end = begin + input.length();
+            const char* line_begin = begin;
+            for (const char* p = begin; p != end && n_lines < max_lines; p++)
+            {
+                // 换行符只有 \r 与 \n，其余字符都大于 \r。
+                if (*p > '\r' || (*p != '\r' && *p != '\n'))
+                    continue;
+                if (p != line_begin)
+                    classify(std::string_view(line_begin, p - line_begin),
+                             out[n_lines++]);
+                line_begin = p + 1;
+            }
+            size_t consumed = line_begin - begin;
+            // 提示符后没有换行。
+            if (n_lines < max_lines && line_begin != end)
+            {
+                std::string_view rest(line_begin, end - line_begin);
+                while (!rest.empty() && rest.back() == ' ')
+                    rest.remove_suffix(1);
+                if (equals(rest, ">"))
+                {
+                    classify(rest, out[n_lines++]);
+                    consumed = input.length();
+                }
+            }
+            if (complete_length)
+                *complete_length = consumed;
+            return n_lines;
+        }
+    };
+
+    /**
+     * @brief 分词后的 AT 指令回复。
+     *
+     * @tparam max_lines 至多保存的行数。超出的行被丢弃。
+     */
+    template <size_t max_lines = 16>
+    class at_response
+    {
+    private:
+        std::array<at_line_t, max_lines> _lines;
+        size_t _size;
+        size_t _complete_length;
+
+    public:
+        explicit at_response(std::string_view input)
+        {
+            _size = at_tokenizer::tokenize(input, _lines.data(), max_lines,
+                                           &_complete_length);
+        }
+
+    public:
+        const at_line_t* begin() const
+        {
+            return _lines.data();
+        }
+        const at_line_t* end() const
+        {
+            return _lines.data() + _size;
+        }
+        size_t size() const
+        {
+            return _size;
+        }
+        /**
+         * @brief 完整行所占的字节数。
+         */
+        size_t complete_length() const
+        {
+            return _complete_length;
+        }
+
+    public:
+        /**
+         * @brief 是否有某种类型的行。
+         */
+        bool has(at_line_type_t type) const
+        {
+            for (const auto& line : *this)
+                if (line.type == type)
+                    return true;
+            return false;
+        }
+        /**
+         * @brief 是否收到 OK。
+         */
+        bool is_ok() const
+        {
+            return has(at_line_type_t::ok);
+        }
+        /**
+         * @brief 是否收到表示失败的结果码。
+         */
+        bool is_error() const
+        {
+            return has(at_line_type_t::error);
+        }
+        /**
+         * @brief 是否收到了给定的一整行。例如 SEND OK。
+         */
+        bool has_line(std::string_view text) const
+        {
+            for (const auto& line : *this)
+                if (line.text == text)
+                    return true;
+            return false;
+        }
+        /**
+         * @brief 找到第一个给定前缀的信息响应或 URC。
+         *
+         * @param prefix 前缀，包含 +，不包含冒号。
+         * @return const at_line_t* 没有找到时为 nullptr。
+         */
+        const at_line_t* find(std::string_view prefix) const
+        {
+            for (const auto& line : *this)
+                if (line.prefix == prefix)
+                    return &line;
+            return nullptr;
+        }
+        /**
+         * @brief 找到第一个给定类型的行。
+         *
+         * @return const at_line_t* 没有找到时为 nullptr。
+         */
+        const at_line_t* find(at_line_type_t type) const
+        {
+            for (const auto& line : *this)
+                if (line.type == type)
+                    return &line;
+            return nullptr;
+        }
+        /**
+         * @brief 找到第一个给定前缀的行，并依次解析其参数。
+         *
+         * @return size_t 成功解析的参数个数。没有找到时为 0。
+         */
+        template <typename... T>
+        size_t parse(std::string_view prefix, T&... out) const
+        {
+            auto line = find(prefix);
+            return line ? line->parse(out...) : 0;
+        }
+    };
+} // namespace peripheral
@@ -11,20 +11,34 @@
 
 #include "mbed.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "../command_receiver_base.hpp"
 #include "../command_receiver_serial.hpp"
+#include "../command_sender_base.hpp"
 #include "../command_sender_serial.hpp"
 #include "../feedback_message.hpp"
 #include "../feedback_message_queue.hpp"
 #include "../global_peripheral.hpp"
 #include "../peripheral_std_framework.hpp"
+#include "at_tokenizer.hpp"
+#include "bc26_config.hpp"
 #include "bc26_message.hpp"
+#include "bc26_stats.hpp"
+#include "bc26_timer.hpp"
+#include <utils/civil_time.hpp>
 #include <utils/debug.hpp>
 #include <utils/msg_data.hpp>
+#include <utils/ring_buffer.hpp>
 
 namespace peripheral
 {
@@ -36,24 +50,196 @@ namespace peripheral
 
     protected:
         mbed::BufferedSerial serial_bc26{PIN_BC26_TX, PIN_BC26_RX};
-        command_sender_serial sender{serial_bc26};
-        command_receiver_serial receiver{serial_bc26};
+        command_sender_serial serial_sender{serial_bc26};
+        command_receiver_serial serial_receiver{serial_bc26};
+        /**
+         * @brief 实际使用的收发对象。默认为串口，也可以替换为模拟器。
+         */
+        command_sender_base& sender;
+        command_receiver_base& receiver;
         _fmq_t& _external_fmq;
 
+    private:
+        /**
+         * @brief 是否已经允许模块进入睡眠。由 AT+QSCLK 设置。
+         *
+         * @note 只在子线程中访问。
+         */
+        bool _is_sleep_enabled{};
+        /**
+         * @brief 发送的数据是否为十六进制字符串。由 AT+QICFG 设置。
+         *
+         * @note 只在子线程中访问。
+         */
+        bool _is_send_hex{};
+        /**
+         * @brief 接收的数据是否为十六进制字符串。由 AT+QICFG 设置。
+         *
+         * @note 只在子线程中访问。
+         */
+        bool _is_recv_hex{};
+        /**
+         * @brief 各 Socket 服务是否已打开。第 i 位对应索引为 i 的 Socket。
+         *
+         * @note 只在子线程中修改，可以在其他线程中通过 is_socket_open 读取。
+         */
+        std::atomic<uint8_t> _open_sockets{};
+        /**
+         * @brief 记录 Socket 服务的打开与关闭。
+         *
+         * @note 只在子线程中调用。
+         */
+        void set_socket_open(int connect_id, bool is_open)
+        {
+            auto bit = static_cast<uint8_t>(1u << connect_id);
+            if (is_open)
+                _open_sockets.fetch_or(bit);
+            else
+                _open_sockets.fetch_and(static_cast<uint8_t>(~bit));
+            _stats.set_socket_open(false, connect_id, is_open);
+        }
+        /**
+         * @brief 发送指令前检查 Socket 服务是否已打开。
+         * 未打开时不发送指令，直接视为失败，节省一次收发。
+         */
+        bool check_socket_open(int connect_id)
+        {
+            if (_open_sockets.load() & 1u << connect_id)
+                return true;
+            utils::debug_printf("[F] socket %d is not open.\n", connect_id);
+            return false;
+        }
+
+    private:
+        /**
+         * @brief 收发统计与能耗估算。
+         */
+        bc26_stats _stats{{bc26_current_active_ua, bc26_current_idle_ua,
+                           bc26_current_sleep_ua}};
+        /**
+         * @brief 正在执行的指令。收发的统计记到该指令下。
+         *
+         * @note 只在子线程中访问。
+         */
+        bc26_message_t _current_command{bc26_message_t::_message_begin};
+        /**
+         * @brief 发送指令，并记录发送的字节数。
+         */
+        void send_command(std::string_view command)
+        {
+            sender.send_command(command);
+            _stats.add_sent(_current_command, command.length());
+        }
+        /**
+         * @brief 接收回复，并记录等待的时间与收到的字节数。
+         */
+        std::string receive_command(Kernel::Clock::duration_u32 wait_time)
+        {
+            auto start_time = Kernel::Clock::now();
+            std::string ret = receiver.receive_command(wait_time);
+            _stats.add_received(
+                _current_command,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    Kernel::Clock::now() - start_time),
+                ret.length());
+            return ret;
+        }
+
+    private:
+        bool _should_exit{};
+        /**
+         * @brief 用于唤醒 listen_urc 的信号量。
+         * 串口收到数据或队列收到新消息时释放。
+         */
+        rtos::Semaphore _sem_wake{0, 1};
+        /**
+         * @brief 等待 URC 时收到的、尚不完整的一行。
+         *
+         * @note 只在子线程中访问。
+         */
+        std::string _urc_buffer;
+        void sigio_callback()
+        {
+            _sem_wake.try_acquire(); // 先获取再释放，保证接下来可释放。
+            _sem_wake.release();
+        }
+
     public:
-        bc26(_fmq_t& fmq) : _external_fmq(fmq)
+        bc26(_fmq_t& fmq) : bc26(fmq, serial_sender, serial_receiver)
         {
         }
+        /**
+         * @brief 使用给定的收发对象代替串口。用于接入模拟器。
+         *
+         * @param sender 发送指令的对象。生命周期应长于该对象。
+         * @param receiver 接收回复的对象。生命周期应长于该对象。
+         */
+        bc26(_fmq_t& fmq, command_sender_base& sender,
+             command_receiver_base& receiver)
+            : sender(sender), receiver(receiver), _external_fmq(fmq)
+        {
+            receiver.sigio(std::bind(&bc26::sigio_callback, this));
+            listen_urc();
+        }
         ~bc26()
         {
+            receiver.sigio(nullptr); // 防止在信号量销毁后收到中断请求。
+            _should_exit = true;
+            _sem_wake.release(); // 强制释放信号量，以正常退出。
+            // 注意死锁。在执行完 release 后一定不能执行 acquire。
             descendant_exit();
         }
 
+    private:
+        /**
+         * @brief 向子模块的消息队列发送消息，并唤醒 listen_urc。
+         *
+         * @note 隐藏了父类的同名函数。
+         */
+        void post_message(int id, std::shared_ptr<void> data)
+        {
+            peripheral_std_framework::post_message(id, data);
+            sigio_callback();
+        }
+        /**
+         * @brief 向子模块的消息队列发送消息，并唤醒 listen_urc。
+         * 如果这种类型的消息已经存在，则覆盖最晚的消息。
+         *
+         * @note 隐藏了父类的同名函数。
+         */
+        void post_message_unique(int id, std::shared_ptr<void> data)
+        {
+            peripheral_std_framework::post_message_unique(id, data);
+            sigio_callback();
+        }
+        /**
+         * @brief 向子模块的消息队列发送消息，并唤醒 listen_urc。
+         * 如果这种类型的消息已经存在，且满足给定的条件，则覆盖最晚的消息。
+         *
+         * @note 隐藏了父类的同名函数。
+         */
+        template <typename pred_t>
+        void post_message_unique_if(int id, std::shared_ptr<void> data,
+                                    pred_t is_same)
+        {
+            peripheral_std_framework::post_message_unique_if(id, data,
+                                                             is_same);
+            sigio_callback();
+        }
+
         // 以下函数是子模块的回调函数，均在子线程中运行。
     private:
         void on_message(int id, std::shared_ptr<void> data) override
         {
             descendant_callback_begin();
+            _current_command = static_cast<bc26_message_t>(id);
+            _stats.add_command(_current_command);
+            // 模块可能处于睡眠状态，先唤醒。等待 URC 时不需要唤醒。
+            if (static_cast<bc26_message_t>(id) != bc26_message_t::listen_urc)
+            {
+                _stats.set_modem_state(bc26_stats::modem_state_t::active);
+                wake_up();
+            }
             switch (static_cast<bc26_message_t>(id))
             {
             case bc26_message_t::send_at:
@@ -91,11 +277,60 @@ namespace peripheral
                 on_send_at_cesq();
                 break;
             }
+            case bc26_message_t::send_at_qeng:
+            {
+                on_send_at_qeng();
+                break;
+            }
+            case bc26_message_t::send_at_cclk:
+            {
+                on_send_at_cclk();
+                break;
+            }
+            case bc26_message_t::send_at_ctzr:
+            {
+                on_send_at_ctzr(*std::static_pointer_cast<int>(data));
+                break;
+            }
+            case bc26_message_t::send_at_cpsms:
+            {
+                using param_type = std::tuple<bool, std::string, std::string>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_cpsms(std::get<0>(param), std::get<1>(param),
+                                 std::get<2>(param));
+                break;
+            }
+            case bc26_message_t::send_at_cedrxs:
+            {
+                using param_type = std::tuple<int, std::string>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_cedrxs(std::get<0>(param), std::get<1>(param));
+                break;
+            }
+            case bc26_message_t::send_at_qsclk:
+            {
+                on_send_at_qsclk(*std::static_pointer_cast<int>(data));
+                break;
+            }
             case bc26_message_t::init:
             {
                 on_init(*std::static_pointer_cast<int>(data));
                 break;
             }
+            case bc26_message_t::send_at_qidnscfg:
+            {
+                using param_type = std::tuple<std::string, std::string>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_qidnscfg(std::get<0>(param), std::get<1>(param));
+                break;
+            }
+            case bc26_message_t::send_at_qidnsgip:
+            {
+                const auto& host_name =
+                    *std::static_pointer_cast<std::string>(data);
+                on_send_at_qidnsgip(host_name);
+                break;
+            }
             case bc26_message_t::send_at_qiopen:
             {
                 using param_type = std::tuple<std::string, int, int, bool>;
@@ -117,12 +352,36 @@ namespace peripheral
                 on_send_at_qisend(std::get<0>(param), std::get<1>(param));
                 break;
             }
+            case bc26_message_t::send_at_qisend_data:
+            {
+                using param_type = std::tuple<const char*, size_t, int>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_qisend_data(std::get<0>(param), std::get<1>(param),
+                                       std::get<2>(param));
+                break;
+            }
+            case bc26_message_t::send_at_qicfg_dataformat:
+            {
+                using param_type = std::tuple<bool, bool>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_qicfg_dataformat(std::get<0>(param),
+                                            std::get<1>(param));
+                break;
+            }
             case bc26_message_t::send_at_qird:
             {
                 auto connect_id = *std::static_pointer_cast<int>(data);
                 on_send_at_qird(connect_id);
                 break;
             }
+            case bc26_message_t::send_at_qird_drain:
+            {
+                using param_type = std::tuple<int, utils::ring_buffer*>;
+                const auto& param =
+                    *std::static_pointer_cast<param_type>(data);
+                on_send_at_qird_drain(std::get<0>(param), std::get<1>(param));
+                break;
+            }
             case bc26_message_t::send_at_qmtcfg:
             {
                 using param_type =
@@ -168,13 +427,222 @@ namespace peripheral
                                   std::get<2>(param), std::get<3>(param));
                 break;
             }
+            case bc26_message_t::send_at_qmtpub:
+            {
+                using param_type =
+                    std::tuple<int, int, int, bool, std::string, std::string>;
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                on_send_at_qmtpub(std::get<0>(param), std::get<1>(param),
+                                  std::get<2>(param), std::get<3>(param),
+                                  std::get<4>(param), std::get<5>(param));
+                break;
+            }
+            case bc26_message_t::listen_urc:
+            {
+                on_listen_urc();
+                break;
+            }
             default:
             {
                 break;
             }
             }
+            _stats.set_modem_state(_is_sleep_enabled
+                                       ? bc26_stats::modem_state_t::sleep
+                                       : bc26_stats::modem_state_t::idle);
+            if (empty()) // 如果消息队列已空，自动等待 URC。
+            {
+                listen_urc();
+            }
             descendant_callback_end();
         }
+        /**
+         * @brief 接收回复，直到满足条件、收到失败的结果码或超时。
+         *
+         * @param is_done 判断是否收完的条件。参数为已收到内容的分词结果。
+         * @param timeout 超时时间。
+         * @return std::string 收到的所有内容。
+         */
+        template <typename pred_t>
+        std::string receive_until_if(pred_t is_done,
+                                     std::chrono::milliseconds timeout)
+        {
+            std::string received_str;
+            auto start_time = Kernel::Clock::now();
+            do
+            {
+                received_str += receive_command(300ms);
+                at_response<> response{received_str};
+                if (response.is_error() || is_done(response))
+                    break;
+            } while (Kernel::Clock::now() - start_time < timeout);
+            // 额外再收一次，确保收完。
+            received_str += receive_command(50ms);
+            return received_str;
+        }
+        /**
+         * @brief 接收回复，直到收到给定前缀的行、失败的结果码或超时。
+         *
+         * @param prefix 期望的前缀，包含 +，不包含冒号。例如 +QMTOPEN。
+         */
+        std::string receive_until(std::string_view prefix,
+                                  std::chrono::milliseconds timeout)
+        {
+            return receive_until_if(
+                [prefix](const at_response<>& response) {
+                    return response.find(prefix) != nullptr;
+                },
+                timeout);
+        }
+        /**
+         * @brief 接收回复，直到收到给定类型的行、失败的结果码或超时。
+         */
+        std::string receive_until(at_line_type_t type,
+                                  std::chrono::milliseconds timeout)
+        {
+            return receive_until_if(
+                [type](const at_response<>& response) {
+                    return response.has(type);
+                },
+                timeout);
+        }
+        /**
+         * @brief 从收到的内容中找出模块主动上报的消息（URC），
+         * 转换为反馈消息。不完整的行会被忽略。
+         *
+         * @param received 收到的内容。
+         * @return size_t 已处理的完整行所占的字节数。
+         */
+        size_t dispatch_urc(std::string_view received, _fmq_t& fmq)
+        {
+            at_response<> response{received};
+            for (const auto& line : response)
+                if (line.type == at_line_type_t::urc)
+                    dispatch_urc_line(line, fmq);
+            return response.complete_length();
+        }
+        void dispatch_urc_line(const at_line_t& line, _fmq_t& fmq)
+        {
+            if (line.prefix == "+QMTRECV")
+            {
+                // +QMTRECV: <tcpconnectID>,<msgID>,"<topic>",<payload>
+                at_fields fields{line.params};
+                int tcp_connect_id{};
+                int msg_id{};
+                std::string_view topic;
+                if (!fields.next(tcp_connect_id) || !fields.next(msg_id) ||
+                    !fields.next(topic) || !fields.has_next())
+                    return;
+                // 消息内容可能带有逗号与引号，取剩余的全部内容。
+                auto payload = at_fields::unquote(fields.rest());
+                // 参见 feedback_message_enum_t::bc26_mqtt_recv。
+                fmq.post_message(
+                    _fmq_e_t::bc26_mqtt_recv,
+                    std::make_shared<
+                        std::tuple<int, int, std::string, std::string>>(
+                        tcp_connect_id, msg_id, std::string(topic),
+                        std::string(payload)));
+            }
+            else if (line.prefix == "+QMTSTAT")
+            {
+                int tcp_connect_id{};
+                int err_code{};
+                if (2 != line.parse(tcp_connect_id, err_code))
+                    return;
+                _stats.set_socket_open(true, tcp_connect_id, false);
+                // 参见 feedback_message_enum_t::bc26_mqtt_stat。
+                fmq.post_message(_fmq_e_t::bc26_mqtt_stat,
+                                 std::make_shared<std::tuple<int, int>>(
+                                     tcp_connect_id, err_code));
+            }
+            else if (line.prefix == "+CTZEU")
+            {
+                // +CTZEU: <tz>,<dst>,<utime>
+                at_fields fields{line.params};
+                std::string_view time_zone;
+                int dst{};
+                if (!fields.next(time_zone) || !fields.next(dst))
+                    return;
+                int64_t epoch = parse_time(fields.rest());
+                if (epoch < 0)
+                    return;
+                // 参见 feedback_message_enum_t::bc26_nitz。
+                fmq.post_message(_fmq_e_t::bc26_nitz,
+                                 std::make_shared<int64_t>(epoch));
+            }
+            else if (line.prefix == "+QIURC")
+            {
+                std::string_view type;
+                int connect_id{};
+                if (2 != line.parse(type, connect_id))
+                    return;
+                if (type == "closed")
+                {
+                    set_socket_open(connect_id, false);
+                    // 参见 feedback_message_enum_t::bc26_qiurc_closed。
+                    fmq.post_message(_fmq_e_t::bc26_qiurc_closed,
+                                     std::make_shared<int>(connect_id));
+                }
+                else if (type == "recv")
+                {
+                    // 参见 feedback_message_enum_t::bc26_qiurc_recv。
+                    fmq.post_message(_fmq_e_t::bc26_qiurc_recv,
+                                     std::make_shared<int>(connect_id));
+                }
+            }
+        }
+        /**
+         * @brief 等待并处理模块主动上报的消息（URC）。
+         * 串口收到数据或队列收到新消息时返回。
+         */
+        void on_listen_urc(_fmq_t& fmq)
+        {
+            if (_should_exit) // 如果已经退出，则不获取信号量。
+                return; // 防止该子类被销毁后继续使用信号量。
+
+            _sem_wake.acquire(); // 没有新数据和新消息时一直阻塞。
+            if (_should_exit) // 如果已经退出，则不执行后续操作。
+                return;
+
+            // 等待一行收完。
+            _urc_buffer += receive_command(50ms);
+            // 一次分词的行数有上限，因此循环直到没有完整的行。
+            while (size_t length = dispatch_urc(_urc_buffer, fmq))
+            {
+                utils::debug_printf("%.*s", static_cast<int>(length),
+                                    _urc_buffer.c_str());
+                _urc_buffer.erase(0, length);
+            }
+            // 防止不完整的内容无限增长。
+            if (_urc_buffer.length() > MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE)
+                _urc_buffer.clear();
+        }
+        void on_listen_urc()
+        {
+            on_listen_urc(_external_fmq);
+        }
+        /**
+         * @brief 如果允许模块睡眠，则在发送指令前唤醒模块。
+         *
+         * @note 模块处于深睡眠时，串口收到的第一条指令只用于唤醒，
+         * 不会被执行，且模块可能只回复 +QATWAKEUP 或回显而不回复 OK。
+         * 因此先重复发送 AT 直到收到 OK，并丢弃期间收到的所有内容。
+         */
+        void wake_up()
+        {
+            if (!_is_sleep_enabled)
+                return;
+
+            constexpr int max_retry = 3;
+            for (int i = 0; i < max_retry; i++)
+            {
+                send_command("AT\r\n");
+                std::string received_str = receive_command(300ms);
+                if (at_response<>(received_str).is_ok())
+                    return;
+            }
+            utils::debug_printf("[W] BC26 wake up.\n");
+        }
         /**
          * @brief 重复发送 AT 指令，直到收到 OK。
          *
@@ -189,10 +657,10 @@ namespace peripheral
             {
                 using namespace std::literals;
                 utils::debug_printf("[-] AT\n");
-                sender.send_command("AT\r\n");
-                received_str = receiver.receive_command(300ms);
+                send_command("AT\r\n");
+                received_str = receive_command(300ms);
                 utils::debug_printf("%s", received_str.c_str());
-                if (received_str.find("OK") != std::string::npos)
+                if (at_response<>(received_str).is_ok())
                 {
                     utils::debug_printf("[D] AT\n");
                     is_success = true;
@@ -216,10 +684,16 @@ namespace peripheral
         void on_software_reset(_fmq_t& fmq)
         {
             utils::debug_printf("[-] AT+QRST=1\n");
-            sender.send_command("AT+QRST=1\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("AT+QRST=1\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
             utils::debug_printf("[D] AT+QRST=1\n");
+            // 重置后模块恢复默认设置，不会进入睡眠，收发文本数据。
+            _is_sleep_enabled = false;
+            _is_send_hex = false;
+            _is_recv_hex = false;
+            _open_sockets = 0;
+            _stats.clear_sockets();
 
             // 参见 feedback_message_enum_t::bc26_software_reset。
             fmq.post_message(_fmq_e_t::bc26_software_reset, nullptr);
@@ -237,11 +711,11 @@ namespace peripheral
                          _fmq_t& fmq) // 参见 bc26_message_t::send_ate。
         {
             utils::debug_printf("[-] ATE%d\n", static_cast<int>(is_echo));
-            sender.send_command("ATE" + std::to_string(is_echo) + "\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("ATE" + std::to_string(is_echo) + "\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            bool is_success = at_response<>(received_str).is_ok();
             utils::debug_printf("[%c] ATE%d\n", is_success ? 'D' : 'F',
                                 static_cast<int>(is_echo));
             // 参见 feedback_message_enum_t::bc26_send_ate。
@@ -262,11 +736,11 @@ namespace peripheral
             _fmq_t& fmq) // 参见 bc26_message_t::send_at_cfun_set。
         {
             utils::debug_printf("[-] AT+CFUN=%d\n", mode);
-            sender.send_command("AT+CFUN=" + std::to_string(mode) + "\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("AT+CFUN=" + std::to_string(mode) + "\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            bool is_success = at_response<>(received_str).is_ok();
             utils::debug_printf("[%c] AT+CFUN=%d\n", is_success ? 'D' : 'F',
                                 mode);
             // 参见 feedback_message_enum_t::bc26_send_at_cfun_set。
@@ -283,20 +757,23 @@ namespace peripheral
         void on_send_at_cimi(_fmq_t& fmq) // 参见 bc26_message_t::send_at_cimi。
         {
             utils::debug_printf("[-] AT+CIMI\n");
-            sender.send_command("AT+CIMI\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("AT+CIMI\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
-            char id[32]{};
-            // 解析失败时，id 应该为全 0。
-            if (is_success && 1 != sscanf(received_str.c_str(), "%s", id))
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
+            // 卡号是唯一的一行文本。解析失败时，id 为空。
+            std::string_view id;
+            if (auto line = response.find(at_line_type_t::text))
+                id = line->text;
+            else
                 is_success = false;
             utils::debug_printf("[%c] AT+CIMI\n", is_success ? 'D' : 'F');
             // 参见 feedback_message_enum_t::bc26_send_at_cimi。
             fmq.post_message(_fmq_e_t::bc26_send_at_cimi,
                              std::make_shared<std::tuple<bool, std::string>>(
-                                 is_success, id));
+                                 is_success, std::string(id)));
         }
         void on_send_at_cimi()
         {
@@ -309,14 +786,14 @@ namespace peripheral
             _fmq_t& fmq) // 参见 bc26_message_t::send_at_cgatt_get。
         {
             utils::debug_printf("[-] AT+CGATT?\n");
-            sender.send_command("AT+CGATT?\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("AT+CGATT?\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int is_activated{};
-            if (is_success && 1 != sscanf(received_str.c_str(),
-                                          "\r\n+CGATT: %d", &is_activated))
+            if (is_success && 1 != response.parse("+CGATT", is_activated))
                 is_success = false;
             utils::debug_printf("[%c] AT+CGATT?\n", is_success ? 'D' : 'F');
             // 参见 feedback_message_enum_t::bc26_send_at_cgatt_get。
@@ -334,14 +811,14 @@ namespace peripheral
         void on_send_at_cesq(_fmq_t& fmq) // 参见 bc26_message_t::send_at_cesq。
         {
             utils::debug_printf("[-] AT+CESQ\n");
-            sender.send_command("AT+CESQ\r\n");
-            std::string received_str = receiver.receive_command(300ms);
+            send_command("AT+CESQ\r\n");
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int intensity{};
-            if (is_success &&
-                1 != sscanf(received_str.c_str(), "\r\n+CESQ: %d", &intensity))
+            if (is_success && 1 != response.parse("+CESQ", intensity))
                 is_success = false;
             utils::debug_printf("[%c] AT+CESQ\n", is_success ? 'D' : 'F');
             // 参见 feedback_message_enum_t::bc26_send_at_cesq。
@@ -353,6 +830,252 @@ namespace peripheral
         {
             on_send_at_cesq(_external_fmq);
         }
+        /**
+         * @brief 发送 AT+QENG=0 指令。获取服务小区的信号质量与覆盖等级。
+         *
+         * @note 只读取服务小区的一行，邻区的信息被忽略。
+         */
+        void on_send_at_qeng(_fmq_t& fmq) // 参见 bc26_message_t::send_at_qeng。
+        {
+            utils::debug_printf("[-] AT+QENG=0\n");
+            send_command("AT+QENG=0\r\n");
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            // +QENG: 0,<earfcn>,<earfcn_offset>,<pci>,<cell_id>,<rsrp>,<rsrq>,
+            // <rssi>,<sinr>,<band>,<tac>,<ecl>,...
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
+            int mode{};
+            int earfcn{};
+            int earfcn_offset{};
+            int pci{};
+            std::string_view cell_id;
+            int rsrp{};
+            int rsrq{};
+            int rssi{};
+            int sinr{};
+            int band{};
+            std::string_view tac;
+            int ecl{};
+            if (is_success &&
+                12 != response.parse("+QENG", mode, earfcn, earfcn_offset, pci,
+                                     cell_id, rsrp, rsrq, rssi, sinr, band,
+                                     tac, ecl))
+                is_success = false;
+            utils::debug_printf("[%c] AT+QENG=0\n", is_success ? 'D' : 'F');
+            // 参见 feedback_message_enum_t::bc26_send_at_qeng。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qeng,
+                             std::make_shared<std::tuple<bool, int, int, int>>(
+                                 is_success, rsrp, sinr, ecl));
+        }
+        void on_send_at_qeng()
+        {
+            on_send_at_qeng(_external_fmq);
+        }
+        /**
+         * @brief 解析 +CCLK 与 +CTZEU 中的时间。
+         * 格式为 yy/MM/dd,hh:mm:ss，年份也可能是四位，其后可能带有时区。
+         * BC26 返回的时间总是 UTC 时间，时区只供参考，因此忽略。
+         *
+         * @param str 时间字符串。可以带引号。
+         * @return int64_t UNIX 时间戳，单位 s。格式错误或时间无效时为 -1。
+         */
+        static int64_t parse_time(std::string_view str)
+        {
+            // 依次取出 6 个数字，忽略分隔符。
+            int values[6]{};
+            size_t n_value = 0;
+            bool in_number = false;
+            for (char ch : str)
+            {
+                if ('0' <= ch && ch <= '9')
+                {
+                    values[n_value] = values[n_value] * 10 + (ch - '0');
+                    in_number = true;
+                }
+                else if (in_number)
+                {
+                    in_number = false;
+                    if (++n_value == std::size(values))
+                        break;
+                }
+            }
+            if (in_number)
+                n_value++;
+            if (n_value < std::size(values))
+                return -1;
+            utils::civil_time::date_time_t t{values[0], values[1],
+                                             values[2], values[3],
+                                             values[4], values[5]};
+            if (t.year < 100)
+                t.year += 2000;
+            // 未同步网络时间时，模块返回出厂时间（通常早于 2020 年）。
+            if (t.year < 2020 || t.month < 1 || t.month > 12 || t.day < 1 ||
+                t.day > 31 || t.hour > 23 || t.minute > 59 || t.second > 60)
+                return -1;
+            return utils::civil_time::to_epoch(t);
+        }
+        /**
+         * @brief 发送 AT+CCLK? 指令。查询网络时间。
+         */
+        void on_send_at_cclk(_fmq_t& fmq) // 参见 bc26_message_t::send_at_cclk。
+        {
+            utils::debug_printf("[-] AT+CCLK?\n");
+            send_command("AT+CCLK?\r\n");
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            dispatch_urc(received_str, fmq);
+            at_response<> response{received_str};
+            const at_line_t* line = response.find("+CCLK");
+            int64_t epoch = -1;
+            if (response.is_ok() && line)
+                epoch = parse_time(line->params);
+            bool is_success = epoch >= 0;
+            utils::debug_printf("[%c] AT+CCLK?\n", is_success ? 'D' : 'F');
+            // 参见 feedback_message_enum_t::bc26_send_at_cclk。
+            fmq.post_message(
+                _fmq_e_t::bc26_send_at_cclk,
+                std::make_shared<std::tuple<bool, int64_t>>(is_success, epoch));
+        }
+        void on_send_at_cclk()
+        {
+            on_send_at_cclk(_external_fmq);
+        }
+        /**
+         * @brief 发送 AT+CTZR= 指令。设置网络时间（NITZ）的主动上报。
+         *
+         * @param mode 模式。参见 bc26_message_t::send_at_ctzr。
+         */
+        void on_send_at_ctzr(int mode, _fmq_t& fmq)
+        {
+            std::string cmd = "AT+CTZR=" + std::to_string(mode) + "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            dispatch_urc(received_str, fmq);
+            bool is_success = at_response<>(received_str).is_ok();
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_ctzr。
+            fmq.post_message(_fmq_e_t::bc26_send_at_ctzr,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_send_at_ctzr(int mode)
+        {
+            on_send_at_ctzr(mode, _external_fmq);
+        }
+        /**
+         * @brief 发送 AT+CPSMS= 指令。设置省电模式（PSM）。
+         *
+         * @param is_enable 是否启用 PSM。
+         * @param periodic_tau 周期性 TAU 时间。8 位二进制字符串，不包含引号。
+         * 为空时不设置。
+         * @param active_time 激活时间。8 位二进制字符串，不包含引号。
+         * 为空时不设置。
+         */
+        void on_send_at_cpsms(
+            bool is_enable, const std::string& periodic_tau,
+            const std::string& active_time,
+            _fmq_t& fmq) // 参见 bc26_message_t::send_at_cpsms。
+        {
+            std::string cmd = "AT+CPSMS=";
+            cmd += std::to_string(is_enable);
+            if (is_enable && !periodic_tau.empty() && !active_time.empty())
+            {
+                assert(periodic_tau.length() == 8 && active_time.length() == 8);
+                // 跳过 GPRS 相关的两个参数。
+                cmd += ",,,\"" + periodic_tau + "\"";
+                cmd += ",\"" + active_time + "\"";
+            }
+            cmd += "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            bool is_success = at_response<>(received_str).is_ok();
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_cpsms。
+            fmq.post_message(_fmq_e_t::bc26_send_at_cpsms,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_send_at_cpsms(bool is_enable, const std::string& periodic_tau,
+                              const std::string& active_time)
+        {
+            on_send_at_cpsms(is_enable, periodic_tau, active_time,
+                             _external_fmq);
+        }
+        /**
+         * @brief 发送 AT+CEDRXS= 指令。设置 eDRX。
+         *
+         * @param mode 模式。参见 bc26_message_t::send_at_cedrxs。
+         * @param edrx_value eDRX 周期。4 位二进制字符串，不包含引号。
+         * 为空时不设置。
+         */
+        void on_send_at_cedrxs(
+            int mode, const std::string& edrx_value,
+            _fmq_t& fmq) // 参见 bc26_message_t::send_at_cedrxs。
+        {
+            assert(0 <= mode && mode <= 3);
+            std::string cmd = "AT+CEDRXS=" + std::to_string(mode);
+            if ((mode == 1 || mode == 2) && !edrx_value.empty())
+            {
+                assert(edrx_value.length() == 4);
+                cmd += ",5"; // 接入技术类型，5 表示 NB-IoT。
+                cmd += ",\"" + edrx_value + "\"";
+            }
+            cmd += "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            bool is_success = at_response<>(received_str).is_ok();
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_cedrxs。
+            fmq.post_message(_fmq_e_t::bc26_send_at_cedrxs,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_send_at_cedrxs(int mode, const std::string& edrx_value)
+        {
+            on_send_at_cedrxs(mode, edrx_value, _external_fmq);
+        }
+        /**
+         * @brief 发送 AT+QSCLK= 指令。设置模块的睡眠模式。
+         *
+         * @param mode 模式。参见 bc26_message_t::send_at_qsclk。
+         */
+        void on_send_at_qsclk(
+            int mode,
+            _fmq_t& fmq) // 参见 bc26_message_t::send_at_qsclk。
+        {
+            assert(0 <= mode && mode <= 2);
+            std::string cmd = "AT+QSCLK=" + std::to_string(mode) + "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            bool is_success = at_response<>(received_str).is_ok();
+            // 只有设置成功才更新状态。禁止睡眠后不再需要唤醒。
+            if (is_success)
+                _is_sleep_enabled = mode != 0;
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_qsclk。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qsclk,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_send_at_qsclk(int mode)
+        {
+            on_send_at_qsclk(mode, _external_fmq);
+        }
 
         /**
          * @brief 综合地初始化。
@@ -365,8 +1088,8 @@ namespace peripheral
             _fmq_t::message_t msg;
             bool any_success = false;
             std::string card_id;
-            bool is_activated;
-            int intensity;
+            bool is_activated{};
+            int intensity{};
 
             on_software_reset(internal_fmq);
             msg = internal_fmq.get_message();
@@ -463,6 +1186,118 @@ namespace peripheral
             on_init(max_retry, _external_fmq);
         }
 
+        /**
+         * @brief 发送 AT+QIDNSCFG= 指令。设置 DNS 服务器。
+         *
+         * @param primary 首选 DNS 服务器的 IP 地址。不包含引号。
+         * @param secondary 备用 DNS 服务器的 IP 地址。不包含引号。
+         * 为空时不设置。
+         */
+        void on_send_at_qidnscfg(const std::string& primary,
+                                 const std::string& secondary, _fmq_t& fmq)
+        {
+            std::string cmd = "AT+QIDNSCFG=1"; // 场景 ID，目前只能为 1。
+            cmd += ",\"" + primary + "\"";
+            if (!secondary.empty())
+                cmd += ",\"" + secondary + "\"";
+            cmd += "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
+            utils::debug_printf("%s", received_str.c_str());
+
+            bool is_success = at_response<>(received_str).is_ok();
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_qidnscfg。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qidnscfg,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_send_at_qidnscfg(const std::string& primary,
+                                 const std::string& secondary)
+        {
+            on_send_at_qidnscfg(primary, secondary, _external_fmq);
+        }
+        /**
+         * @brief 解析 AT+QIDNSGIP 的结果。
+         * 结果以 URC 的形式给出，先是一行 +QIURC: "dnsgip",<err>,<IP_count>,
+         * <DNS_ttl>，之后每个地址一行 +QIURC: "dnsgip","<IP_addr>"。
+         *
+         * @param response 收到内容的分词结果。
+         * @param err 错误码。0 表示成功。
+         * @param ttl DNS 记录的有效期，单位为秒。
+         * @param address 第一个 IP 地址。
+         * @return bool 结果是否已经收完。
+         */
+        static bool parse_dnsgip(const at_response<>& response, int& err,
+                                 int& ttl, std::string_view& address)
+        {
+            bool has_header = false;
+            int n_address{};
+            int n_received{};
+            for (const auto& line : response)
+            {
+                if (line.prefix != "+QIURC")
+                    continue;
+                at_fields fields{line.params};
+                std::string_view type;
+                if (!fields.next(type) || type != "dnsgip")
+                    continue;
+                if (!has_header)
+                {
+                    has_header = fields.next(err) && fields.next(n_address) &&
+                                 fields.next(ttl);
+                    continue;
+                }
+                std::string_view returned_address;
+                if (fields.next(returned_address) && !n_received++)
+                    address = returned_address;
+            }
+            return has_header && (err || n_received >= n_address);
+        }
+        /**
+         * @brief 发送 AT+QIDNSGIP= 指令。解析域名。
+         *
+         * @param host_name 域名。不包含引号。
+         */
+        void on_send_at_qidnsgip(const std::string& host_name, _fmq_t& fmq)
+        {
+            std::string cmd = "AT+QIDNSGIP=1"; // 场景 ID，目前只能为 1。
+            cmd += ",\"" + host_name + "\"";
+            cmd += "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            // 先回复 OK，解析完成后再以 URC 给出结果。只等待 20 s。
+            std::string received_str = receive_until_if(
+                [](const at_response<>& response) {
+                    int err{};
+                    int ttl{};
+                    std::string_view address;
+                    return parse_dnsgip(response, err, ttl, address);
+                },
+                20s);
+            utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
+
+            at_response<> response{received_str};
+            int err = -1;
+            int ttl{};
+            std::string_view address;
+            bool is_success = response.is_ok() &&
+                              parse_dnsgip(response, err, ttl, address) &&
+                              !err && !address.empty();
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_qidnsgip。
+            fmq.post_message(
+                _fmq_e_t::bc26_send_at_qidnsgip,
+                std::make_shared<std::tuple<bool, std::string, int>>(
+                    is_success, std::string(address), ttl));
+        }
+        void on_send_at_qidnsgip(const std::string& host_name)
+        {
+            on_send_at_qidnsgip(host_name, _external_fmq);
+        }
         /**
          * @brief 发送 AT+QIOPEN= 指令。打开 Socket 服务。
          *
@@ -490,64 +1325,23 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str;
+            send_command(cmd);
             // 至多会等待 60 s。
             // 只等待 10 s。如果没退出，就自动重置模块。
-            int times = 0;
-            do
-            {
-                received_str += receiver.receive_command(300ms);
-                if (received_str.find("ERROR") != std::string::npos)
-                    break;
-                times++;
-                if (300ms * times > 10s)
-                {
-                    init();
-                    break;
-                }
-            } while (received_str.find("+QIOPEN:") == std::string::npos);
-            // 额外再收一次，确保收完。
-            received_str += receiver.receive_command(300ms);
+            std::string received_str = receive_until("+QIOPEN", 10s);
             utils::debug_printf("%s", received_str.c_str());
+            at_response<> response{received_str};
+            if (!response.is_error() && !response.find("+QIOPEN"))
+                init();
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            bool is_success = response.is_ok();
             int returned_connect_id{};
             int result{};
-            if (is_success)
-            {
-                bool found = false;
-                // 逐行解析字符串。
-                auto handle_line = [&](const std::string& line) -> bool {
-                    return 2 == sscanf(line.c_str(), "+QIOPEN: %d,%d",
-                                       &returned_connect_id, &result);
-                };
-                received_str.push_back('\n');
-                std::string buf;
-                for (char ch : received_str)
-                {
-                    buf.push_back(ch);
-                    if (buf.back() == '\n')
-                    {
-                        // 弹出所有的换行。
-                        while (!buf.empty() && buf.back() == '\n')
-                            buf.pop_back();
-                        while (!buf.empty() && buf.back() == '\r')
-                            buf.pop_back();
-                        // 如果不是空行，则处理。
-                        if (!buf.empty() && handle_line(buf))
-                        {
-                            found = true;
-                            break;
-                        }
-                        // 处理完成，清空缓冲区。
-                        buf.clear();
-                    }
-                }
-                // 如果没找到，说明解析失败。
-                if (!found)
-                    is_success = false;
-            }
+            if (is_success &&
+                2 != response.parse("+QIOPEN", returned_connect_id, result))
+                is_success = false;
+            if (is_success && !result)
+                set_socket_open(connect_id, true);
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qiopen。
             fmq.post_message(_fmq_e_t::bc26_send_at_qiopen,
@@ -573,16 +1367,18 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success =
-                received_str.find("CLOSE OK") != std::string::npos;
+            dispatch_urc(received_str, fmq);
+            bool is_success = at_response<>(received_str).has_line("CLOSE OK");
+            set_socket_open(connect_id, false);
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qiclose。
             fmq.post_message(_fmq_e_t::bc26_send_at_qiclose,
-                             std::make_shared<bool>(is_success));
+                             std::make_shared<std::tuple<bool, int>>(
+                                 is_success, connect_id));
         }
         void on_send_at_qiclose(int connect_id)
         {
@@ -597,33 +1393,257 @@ namespace peripheral
         void on_send_at_qisend(const std::string& str, int connect_id,
                                _fmq_t& fmq)
         {
-            std::string cmd = "AT+QISEND=";
-            assert(0 <= connect_id && connect_id <= 4);
-            cmd += std::to_string(connect_id);
-            assert(str.length() <= 1024);
-            cmd += "," + std::to_string(str.length());
-            cmd += ",\"" + str + "\"";
+            std::string cmd = "AT+QISEND=";
+            assert(0 <= connect_id && connect_id <= 4);
+            cmd += std::to_string(connect_id);
+            assert(str.length() <= 1024);
+            cmd += "," + std::to_string(str.length());
+            cmd += ",\"" + str + "\"";
+            cmd += "\r\n";
+
+            bool is_success = check_socket_open(connect_id);
+            if (is_success)
+            {
+                utils::debug_printf("[-] %s", cmd.c_str());
+                send_command(cmd);
+                std::string received_str = receive_command(300ms);
+                utils::debug_printf("%s", received_str.c_str());
+                // 其他 Socket 的 URC 可能夹在回复中。
+                dispatch_urc(received_str, fmq);
+
+                at_response<> response{received_str};
+                is_success = response.is_ok() && response.has_line("SEND OK");
+                utils::debug_printf("[%c] %s", is_success ? 'D' : 'F',
+                                    cmd.c_str());
+            }
+            // 参见 feedback_message_enum_t::bc26_send_at_qisend。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qisend,
+                             std::make_shared<std::tuple<bool, int>>(
+                                 is_success, connect_id));
+        }
+        void on_send_at_qisend(const std::string& str, int connect_id)
+        {
+            on_send_at_qisend(str, connect_id, _external_fmq);
+        }
+        /**
+         * @brief 将二进制数据编码为十六进制字符串。
+         */
+        static std::string to_hex(const char* data, size_t length)
+        {
+            constexpr char digits[] = "0123456789ABCDEF";
+            std::string ret(length * 2, '0');
+            for (size_t i = 0; i < length; i++)
+            {
+                auto byte = static_cast<unsigned char>(data[i]);
+                ret[i * 2] = digits[byte >> 4];
+                ret[i * 2 + 1] = digits[byte & 0xF];
+            }
+            return ret;
+        }
+        /**
+         * @brief 将十六进制字符串解码为二进制数据。
+         *
+         * @return std::string 解码后的数据。如果格式错误，返回空字符串。
+         */
+        static std::string from_hex(std::string_view hex)
+        {
+            auto digit = [](char ch) -> int {
+                if ('0' <= ch && ch <= '9')
+                    return ch - '0';
+                if ('A' <= ch && ch <= 'F')
+                    return ch - 'A' + 10;
+                if ('a' <= ch && ch <= 'f')
+                    return ch - 'a' + 10;
+                return -1;
+            };
+            std::string ret;
+            if (hex.length() % 2)
+                return ret;
+            ret.reserve(hex.length() / 2);
+            for (size_t i = 0; i < hex.length(); i += 2)
+            {
+                int high = digit(hex[i]);
+                int low = digit(hex[i + 1]);
+                if (high < 0 || low < 0)
+                    return std::string();
+                ret.push_back(static_cast<char>(high << 4 | low));
+            }
+            return ret;
+        }
+        /**
+         * @brief 发送 AT+QISEND= 指令。以数据模式发送任意二进制数据。
+         * 如果已设置以十六进制字符串发送，则改为发送十六进制字符串。
+         *
+         * @note 数据模式下，模块先回复 >，再接收恰好 length 字节的数据。
+         * 数据中可以包含引号、换行等任意字节。
+         *
+         * @param data 要发送的数据。数据模式下直接写入串口，不复制；
+         * 十六进制模式下需要先编码为字符串。
+         * @param length 数据的长度。范围 1-1024。
+         * @param connect_id Socket 服务索引。范围 0-4。默认为 0。
+         */
+        void on_send_at_qisend_data(const char* data, size_t length,
+                                    int connect_id, _fmq_t& fmq)
+        {
+            std::string cmd = "AT+QISEND=";
+            assert(0 <= connect_id && connect_id <= 4);
+            cmd += std::to_string(connect_id);
+            assert(1 <= length && length <= 1024);
+            cmd += "," + std::to_string(length);
+            if (_is_send_hex)
+                cmd += ",\"" + to_hex(data, length) + "\"";
+            cmd += "\r\n";
+
+            bool is_success = check_socket_open(connect_id);
+            if (!is_success)
+            {
+                // 参见 feedback_message_enum_t::bc26_send_at_qisend。
+                fmq.post_message(_fmq_e_t::bc26_send_at_qisend,
+                                 std::make_shared<std::tuple<bool, int>>(
+                                     is_success, connect_id));
+                return;
+            }
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str;
+            if (!_is_send_hex)
+            {
+                // 等待模块回复 >，再发送数据。
+                received_str = receive_until(at_line_type_t::prompt, 3s);
+                is_success = at_response<>(received_str).has(
+                    at_line_type_t::prompt);
+                if (is_success)
+                    send_command(std::string_view(data, length));
+            }
+            if (is_success)
+            {
+                // 9600 波特率下，1024 字节需要约 1 s 才能发完。
+                // SEND FAIL 属于失败的结果码，会提前结束等待。
+                std::string result_str = receive_until_if(
+                    [](const at_response<>& response) {
+                        return response.has_line("SEND OK");
+                    },
+                    3s);
+                is_success = at_response<>(result_str).has_line("SEND OK");
+                received_str += result_str;
+            }
+            utils::debug_printf("%s", received_str.c_str());
+            // 其他 Socket 的 URC 可能夹在回复中。
+            dispatch_urc(received_str, fmq);
+
+            utils::debug_printf("[%c] AT+QISEND=%d,%d\n",
+                                is_success ? 'D' : 'F', connect_id,
+                                static_cast<int>(length));
+            // 参见 feedback_message_enum_t::bc26_send_at_qisend。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qisend,
+                             std::make_shared<std::tuple<bool, int>>(
+                                 is_success, connect_id));
+        }
+        void on_send_at_qisend_data(const char* data, size_t length,
+                                    int connect_id)
+        {
+            on_send_at_qisend_data(data, length, connect_id, _external_fmq);
+        }
+        /**
+         * @brief 发送 AT+QICFG="dataformat" 指令。设置收发数据的格式。
+         *
+         * @param is_send_hex 发送的数据是否为十六进制字符串。
+         * @param is_recv_hex 接收的数据是否为十六进制字符串。
+         */
+        void on_send_at_qicfg_dataformat(bool is_send_hex, bool is_recv_hex,
+                                         _fmq_t& fmq)
+        {
+            std::string cmd = "AT+QICFG=\"dataformat\"";
+            cmd += "," + std::to_string(is_send_hex);
+            cmd += "," + std::to_string(is_recv_hex);
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            bool is_success = at_response<>(received_str).is_ok();
+            // 只有设置成功才更新状态。
             if (is_success)
-                is_success &= received_str.find("SEND OK") != std::string::npos;
+            {
+                _is_send_hex = is_send_hex;
+                _is_recv_hex = is_recv_hex;
+            }
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
-            // 参见 feedback_message_enum_t::bc26_send_at_qisend。
-            fmq.post_message(_fmq_e_t::bc26_send_at_qisend,
+            // 参见 feedback_message_enum_t::bc26_send_at_qicfg_dataformat。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qicfg_dataformat,
                              std::make_shared<bool>(is_success));
         }
-        void on_send_at_qisend(const std::string& str, int connect_id)
+        void on_send_at_qicfg_dataformat(bool is_send_hex, bool is_recv_hex)
         {
-            on_send_at_qisend(str, connect_id, _external_fmq);
+            on_send_at_qicfg_dataformat(is_send_hex, is_recv_hex,
+                                        _external_fmq);
+        }
+        /**
+         * @brief 接收 AT+QIRD 的回复，并按 +QIRD: 给出的长度取出数据。
+         * 数据中可以包含换行。数据之外的 URC 会被处理，数据中的不会。
+         *
+         * @param data 取出的数据。十六进制格式下已解码。
+         * @return bool 是否成功收到 OK 且成功解析。
+         */
+        bool receive_qird(std::string& data, _fmq_t& fmq)
+        {
+            constexpr auto timeout = 2s;
+            std::string received_str;
+            bool is_success = false;
+            // +QIRD: 与数据所在的范围。之前与之后的内容可能包含 URC。
+            size_t data_begin = std::string::npos;
+            size_t data_end = std::string::npos;
+            data.clear();
+            auto start_time = Kernel::Clock::now();
+            // 按 50 ms 收取，避免数据较长时串口缓冲区溢出。
+            while (Kernel::Clock::now() - start_time < timeout)
+            {
+                received_str += receive_command(50ms);
+                // 只有 +QIRD: 所在的行及之前的内容按行解析，数据可能包含换行。
+                at_response<> response{received_str};
+                // UDP 下长度后还有远程地址和端口，只取长度。
+                int length{};
+                auto header = response.find("+QIRD");
+                if (!header)
+                {
+                    if (response.is_error())
+                        break;
+                    continue;
+                }
+                if (1 != header->parse(length) || length < 0)
+                    break;
+                data_begin = header->text.data() - received_str.data();
+                size_t header_end = data_begin + header->text.length();
+                data_end = received_str.find('\n', header_end);
+                if (data_end == std::string::npos)
+                    continue;
+                size_t n_chars = _is_recv_hex ? length * 2 : length;
+                data_end += 1 + n_chars;
+                if (received_str.length() < data_end ||
+                    !at_response<>(std::string_view(received_str)
+                                       .substr(data_end))
+                         .is_ok())
+                    continue;
+                data = received_str.substr(data_end - n_chars, n_chars);
+                // 十六进制格式下，读出的是十六进制字符串，需要解码。
+                if (_is_recv_hex)
+                    data = from_hex(data);
+                is_success = true;
+                break;
+            }
+            utils::debug_printf("%s", received_str.c_str());
+            // 其他 Socket 的 URC 可能夹在回复中。
+            std::string_view received = received_str;
+            dispatch_urc(received.substr(0, data_begin), fmq);
+            if (is_success)
+                dispatch_urc(received.substr(data_end), fmq);
+            return is_success;
         }
         /**
          * @brief 发送 AT+QIRD= 指令。读取收到的 TCP/IP 数据。
+         * 只读取一次，UDP 下为一个数据报。
          *
          * @param connect_id Socket 服务索引。范围 0-4。默认为 0。
          */
@@ -638,62 +1658,86 @@ namespace peripheral
             cmd += "," + std::to_string(buffer_size);
             cmd += "\r\n";
 
-            utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
-            utils::debug_printf("%s", received_str.c_str());
-
-            bool is_success = received_str.find("OK") != std::string::npos;
             std::string data_read;
-            // 提取 +QIRD: 后的那一行。
+            bool is_success = check_socket_open(connect_id);
             if (is_success)
             {
-                std::string_view raw{received_str};
-                size_t line_start = 0;
-                bool is_data = false;
-                for (size_t i = 0; i < raw.size(); i++)
-                {
-                    if (raw[i] == '\r')
-                        continue;
-                    if (raw[i] == '\n')
-                    {
-                        if (is_data)
-                        {
-                            while (i && (raw[i] == '\r' || raw[i] == '\n'))
-                                i--;
-                            if (~i)
-                            {
-                                data_read = std::move(std::string(raw.substr(
-                                    line_start, i - line_start + 1)));
-                            }
-                            break;
-                        }
-                        else if (raw.substr(line_start, i - line_start + 1)
-                                     .substr(0, 6) == "+QIRD:")
-                        {
-                            if (raw.substr(line_start, i - line_start + 1)
-                                    .substr(6, 2) == " 0")
-                            {
-                                // 没有数据，退出。严格按文档解析。
-                                break;
-                            }
-                            is_data = true;
-                        }
-                        line_start = i + 1;
-                    }
-                }
+                utils::debug_printf("[-] %s", cmd.c_str());
+                send_command(cmd);
+                is_success = receive_qird(data_read, fmq);
+                utils::debug_printf("[%c] %s", is_success ? 'D' : 'F',
+                                    cmd.c_str());
             }
-
-            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qird。
-            fmq.post_message(_fmq_e_t::bc26_send_at_qird,
-                             std::make_shared<std::tuple<bool, std::string>>(
-                                 is_success, data_read));
+            fmq.post_message(
+                _fmq_e_t::bc26_send_at_qird,
+                std::make_shared<std::tuple<bool, std::string, int>>(
+                    is_success, data_read, connect_id));
         }
         void on_send_at_qird(int connect_id)
         {
             on_send_at_qird(connect_id, _external_fmq);
         }
+        /**
+         * @brief 反复发送 AT+QIRD= 指令，直到模块中没有数据，
+         * 或缓冲区已满。读出的数据依次写入缓冲区。
+         *
+         * @param connect_id Socket 服务索引。范围 0-4。
+         * @param buffer 写入数据的缓冲区。
+         */
+        void on_send_at_qird_drain(int connect_id, utils::ring_buffer* buffer,
+                                   _fmq_t& fmq)
+        {
+            // 按 50 ms 收取时，每次读取的长度不受串口缓冲区大小的限制。
+            constexpr size_t chunk_size = 256;
+
+            assert(0 <= connect_id && connect_id <= 4);
+            bool is_success = check_socket_open(connect_id);
+            bool is_complete = false;
+            size_t total{};
+            while (is_success)
+            {
+                // 十六进制格式下，收到的字符数是数据长度的两倍。
+                size_t length = std::min(
+                    _is_recv_hex ? chunk_size / 2 : chunk_size,
+                    buffer->free_space());
+                if (!length) // 缓冲区已满，剩余的数据留在模块中。
+                    break;
+
+                std::string cmd = "AT+QIRD=";
+                cmd += std::to_string(connect_id);
+                cmd += "," + std::to_string(length);
+                cmd += "\r\n";
+
+                utils::debug_printf("[-] %s", cmd.c_str());
+                send_command(cmd);
+                std::string data_read;
+                if (!receive_qird(data_read, fmq))
+                {
+                    is_success = false;
+                    break;
+                }
+                if (data_read.empty()) // +QIRD: 0，已读完。
+                {
+                    is_complete = true;
+                    break;
+                }
+                total += buffer->write(data_read.data(), data_read.length());
+            }
+
+            utils::debug_printf("[%c] AT+QIRD drain %u\n",
+                                is_success ? 'D' : 'F',
+                                static_cast<unsigned>(total));
+            // 参见 feedback_message_enum_t::bc26_send_at_qird_drain。
+            fmq.post_message(
+                _fmq_e_t::bc26_send_at_qird_drain,
+                std::make_shared<std::tuple<bool, size_t, bool, int>>(
+                    is_success, total, is_complete, connect_id));
+        }
+        void on_send_at_qird_drain(int connect_id, utils::ring_buffer* buffer)
+        {
+            on_send_at_qird_drain(connect_id, buffer, _external_fmq);
+        }
 
         /**
          * @brief 发送 AT+QMTCFG= 指令。配置 MQTT 可选参数。
@@ -712,11 +1756,11 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
+            send_command(cmd);
+            std::string received_str = receive_command(300ms);
             utils::debug_printf("%s", received_str.c_str());
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            bool is_success = at_response<>(received_str).is_ok();
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtcfg。
             fmq.post_message(_fmq_e_t::bc26_send_at_qmtcfg,
@@ -749,25 +1793,23 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str;
-            // 至多会等待 75s。
-            // TODO: 增加等待超时。目前假设总是会成功。
-            do
-            {
-                received_str = receiver.receive_command(300ms);
-            } while (received_str.empty());
-            // 额外再收一次，确保收完。
-            received_str += receiver.receive_command(300ms);
+            send_command(cmd);
+            // 至多会等待 75 s。
+            std::string received_str = receive_until("+QMTOPEN", 75s);
             utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int returned_tcp_connect_id{};
             int result{};
-            if (is_success &&
-                2 != sscanf(received_str.c_str(), "OK\r\n\r\n+QMTOPEN: %d,%d",
-                            &returned_tcp_connect_id, &result))
+            if (is_success && 2 != response.parse("+QMTOPEN",
+                                                  returned_tcp_connect_id,
+                                                  result))
                 is_success = false;
+            // 2 表示标识符被占用，说明网络已经打开。
+            if (is_success && (!result || result == 2))
+                _stats.set_socket_open(true, tcp_connect_id, true);
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtopen。
             fmq.post_message(_fmq_e_t::bc26_send_at_qmtopen,
@@ -793,17 +1835,20 @@ namespace peripheral
                 "AT+QMTCLOSE=" + std::to_string(tcp_connect_id) + "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
+            send_command(cmd);
+            std::string received_str = receive_until("+QMTCLOSE", 2s);
             utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int returned_tcp_connect_id{};
             int result{};
-            if (is_success &&
-                2 != sscanf(received_str.c_str(), "OK\r\n\r\n+QMTCLOSE: %d,%d",
-                            &returned_tcp_connect_id, &result))
+            if (is_success && 2 != response.parse("+QMTCLOSE",
+                                                  returned_tcp_connect_id,
+                                                  result))
                 is_success = false;
+            _stats.set_socket_open(true, tcp_connect_id, false);
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtclose。
             fmq.post_message(_fmq_e_t::bc26_send_at_qmtclose,
@@ -838,25 +1883,21 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str;
-            // 默认至多会等待 10s。
-            // TODO: 增加等待超时。目前假设总是会成功。
-            do
-            {
-                received_str = receiver.receive_command(300ms);
-            } while (received_str.empty());
-            // 额外再收一次，确保收完。
-            received_str += receiver.receive_command(300ms);
+            send_command(cmd);
+            // 默认至多会等待 10 s。
+            std::string received_str = receive_until("+QMTCONN", 15s);
             utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int returned_tcp_connect_id{};
             int result{};
             int ret_code{};
+            // 没有收到 CONNACK 时没有 <ret_code>。
             if (is_success &&
-                2 > sscanf(received_str.c_str(), "OK\r\n\r\n+QMTCONN: %d,%d,%d",
-                           &returned_tcp_connect_id, &result, &ret_code))
+                2 > response.parse("+QMTCONN", returned_tcp_connect_id,
+                                   result, ret_code))
                 is_success = false;
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtconn。
@@ -888,16 +1929,18 @@ namespace peripheral
                 "AT+QMTDISC=" + std::to_string(tcp_connect_id) + "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str = receiver.receive_command(300ms);
+            send_command(cmd);
+            std::string received_str = receive_until("+QMTDISC", 2s);
             utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int returned_tcp_connect_id{};
             int result{};
-            if (is_success &&
-                2 != sscanf(received_str.c_str(), "OK\r\n\r\n+QMTDISC: %d,%d",
-                            &returned_tcp_connect_id, &result))
+            if (is_success && 2 != response.parse("+QMTDISC",
+                                                  returned_tcp_connect_id,
+                                                  result))
                 is_success = false;
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtdisc。
@@ -933,27 +1976,21 @@ namespace peripheral
             cmd += "\r\n";
 
             utils::debug_printf("[-] %s", cmd.c_str());
-            sender.send_command(cmd);
-            std::string received_str;
-            // 默认至多会等待 40s。
-            // TODO: 增加等待超时。目前假设总是会成功。
-            do
-            {
-                received_str = receiver.receive_command(300ms);
-            } while (received_str.empty());
-            // 额外再收一次，确保收完。
-            received_str += receiver.receive_command(300ms);
+            send_command(cmd);
+            // 默认至多会等待 40 s。
+            std::string received_str = receive_until("+QMTSUB", 40s);
             utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
 
-            bool is_success = received_str.find("OK") != std::string::npos;
+            at_response<> response{received_str};
+            bool is_success = response.is_ok();
             int returned_tcp_connect_id{};
             int returned_msg_id{};
             int result{};
             int value{};
-            if (is_success && 3 > sscanf(received_str.c_str(),
-                                         "OK\r\n\r\n+QMTSUB: %d,%d,%d,%d",
-                                         &returned_tcp_connect_id,
-                                         &returned_msg_id, &result, &value))
+            if (is_success &&
+                3 > response.parse("+QMTSUB", returned_tcp_connect_id,
+                                   returned_msg_id, result, value))
                 is_success = false;
             utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
             // 参见 feedback_message_enum_t::bc26_send_at_qmtsub。
@@ -969,6 +2006,74 @@ namespace peripheral
             on_send_at_qmtsub(tcp_connect_id, msg_id, topic, qos,
                               _external_fmq);
         }
+        /**
+         * @brief 发送 AT+QMTPUB= 指令。发布消息。
+         *
+         * @note 先发送指令，收到 > 后发送消息内容，并以 Ctrl+Z 结束。
+         *
+         * @param tcp_connect_id MQTT Socket 标识符。范围 0-5。
+         * @param msg_id 数据包标识符，范围：0-65535。QoS 为 0 时只能为 0。
+         * @param qos QoS 等级。范围 0-2。
+         * @param is_retain 服务器是否保留该消息。
+         * @param topic 主题。最大长度是 255 字节。不包含引号。
+         * @param payload 消息内容。不能包含 Ctrl+Z（0x1A）。
+         */
+        void on_send_at_qmtpub(int tcp_connect_id, int msg_id, int qos,
+                               bool is_retain, const std::string& topic,
+                               const std::string& payload, _fmq_t& fmq)
+        {
+            std::string cmd = "AT+QMTPUB=";
+            assert(0 <= tcp_connect_id && tcp_connect_id <= 5);
+            cmd += std::to_string(tcp_connect_id);
+            assert(0 <= msg_id && msg_id <= 65535);
+            assert(qos || !msg_id);
+            cmd += "," + std::to_string(msg_id);
+            assert(0 <= qos && qos <= 2);
+            cmd += "," + std::to_string(qos);
+            cmd += "," + std::to_string(is_retain);
+            cmd += ",\"" + topic + "\"";
+            cmd += "\r\n";
+
+            utils::debug_printf("[-] %s", cmd.c_str());
+            send_command(cmd);
+            std::string received_str =
+                receive_until(at_line_type_t::prompt, 3s);
+            bool is_success =
+                at_response<>(received_str).has(at_line_type_t::prompt);
+            if (is_success)
+            {
+                assert(payload.find('\x1A') == std::string::npos);
+                send_command(payload);
+                send_command("\x1A");
+                // 默认至多会等待 10 s，重传时更长。
+                received_str += receive_until("+QMTPUB", 40s);
+            }
+            utils::debug_printf("%s", received_str.c_str());
+            dispatch_urc(received_str, fmq);
+
+            at_response<> response{received_str};
+            is_success = is_success && response.is_ok();
+            int returned_tcp_connect_id{};
+            int returned_msg_id{};
+            int result{};
+            if (is_success &&
+                3 != response.parse("+QMTPUB", returned_tcp_connect_id,
+                                    returned_msg_id, result))
+                is_success = false;
+            utils::debug_printf("[%c] %s", is_success ? 'D' : 'F', cmd.c_str());
+            // 参见 feedback_message_enum_t::bc26_send_at_qmtpub。
+            fmq.post_message(_fmq_e_t::bc26_send_at_qmtpub,
+                             std::make_shared<std::tuple<bool, int, int, int>>(
+                                 is_success, returned_tcp_connect_id,
+                                 returned_msg_id, result));
+        }
+        void on_send_at_qmtpub(int tcp_connect_id, int msg_id, int qos,
+                               bool is_retain, const std::string& topic,
+                               const std::string& payload)
+        {
+            on_send_at_qmtpub(tcp_connect_id, msg_id, qos, is_retain, topic,
+                              payload, _external_fmq);
+        }
 
         // 以下函数是主模块的接口，均在主线程中运行。
     public:
@@ -1034,6 +2139,102 @@ namespace peripheral
             post_message(static_cast<int>(bc26_message_t::send_at_cesq),
                          nullptr);
         }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QENG=0 指令。
+         * 获取服务小区的信号质量与覆盖等级。
+         */
+        void send_at_qeng()
+        {
+            post_message(static_cast<int>(bc26_message_t::send_at_qeng),
+                         nullptr);
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CCLK? 指令。查询网络时间。
+         */
+        void send_at_cclk()
+        {
+            post_message_unique(static_cast<int>(bc26_message_t::send_at_cclk),
+                                nullptr);
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CTZR= 指令。
+         * 设置网络时间（NITZ）的主动上报。
+         *
+         * @param mode 模式。参见 bc26_message_t::send_at_ctzr。
+         */
+        void send_at_ctzr(int mode)
+        {
+            post_message(static_cast<int>(bc26_message_t::send_at_ctzr),
+                         std::make_shared<int>(mode));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CPSMS= 指令。设置省电模式（PSM）。
+         *
+         * @param is_enable 是否启用 PSM。
+         * @param periodic_tau 周期性 TAU 时间。会向上取整到可以表示的值。
+         * @param active_time 激活时间。会向上取整到可以表示的值。
+         */
+        void send_at_cpsms(bool is_enable, std::chrono::seconds periodic_tau,
+                           std::chrono::seconds active_time)
+        {
+            using param_type = std::tuple<bool, std::string, std::string>;
+            post_message_unique(
+                static_cast<int>(bc26_message_t::send_at_cpsms),
+                std::make_shared<param_type>(
+                    is_enable, bc26_timer::encode_periodic_tau(periodic_tau),
+                    bc26_timer::encode_active_time(active_time)));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CPSMS= 指令。设置省电模式（PSM）。
+         * 不设置定时器，使用模块已有的设置。
+         *
+         * @param is_enable 是否启用 PSM。
+         */
+        void send_at_cpsms(bool is_enable)
+        {
+            using param_type = std::tuple<bool, std::string, std::string>;
+            post_message_unique(
+                static_cast<int>(bc26_message_t::send_at_cpsms),
+                std::make_shared<param_type>(is_enable, "", ""));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CEDRXS= 指令。启用 eDRX。
+         *
+         * @param cycle eDRX 周期。会向下取整到可以表示的值。
+         */
+        void send_at_cedrxs(std::chrono::milliseconds cycle)
+        {
+            using param_type = std::tuple<int, std::string>;
+            post_message_unique(
+                static_cast<int>(bc26_message_t::send_at_cedrxs),
+                std::make_shared<param_type>(1,
+                                             bc26_timer::encode_edrx(cycle)));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+CEDRXS=0 指令。停用 eDRX。
+         */
+        void send_at_cedrxs_disable()
+        {
+            using param_type = std::tuple<int, std::string>;
+            post_message_unique(
+                static_cast<int>(bc26_message_t::send_at_cedrxs),
+                std::make_shared<param_type>(0, ""));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QSCLK= 指令。设置模块的睡眠模式。
+         *
+         * @note 允许睡眠后，子模块会在每条指令之前自动唤醒模块。
+         *
+         * @param mode 模式。默认为 1。
+         * - 0 禁止进入睡眠。
+         * - 1 允许进入深睡眠和浅睡眠。
+         * - 2 只允许进入浅睡眠。
+         */
+        void send_at_qsclk(int mode = 1)
+        {
+            post_message_unique(static_cast<int>(bc26_message_t::send_at_qsclk),
+                                std::make_shared<int>(mode));
+        }
 
         /**
          * @brief 综合地初始化。
@@ -1046,6 +2247,66 @@ namespace peripheral
                          std::make_shared<int>(max_retry));
         }
 
+        /**
+         * @brief 向子模块发送消息。发送 AT+QIDNSCFG= 指令。设置 DNS 服务器。
+         *
+         * @param primary 首选 DNS 服务器的 IP 地址。不包含引号。
+         * @param secondary 备用 DNS 服务器的 IP 地址。不包含引号。
+         * 为空时不设置。
+         */
+        void send_at_qidnscfg(const std::string& primary,
+                              const std::string& secondary = "")
+        {
+            using param_type = std::tuple<std::string, std::string>;
+            post_message(static_cast<int>(bc26_message_t::send_at_qidnscfg),
+                         std::make_shared<param_type>(primary, secondary));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QIDNSGIP= 指令。解析域名。
+         *
+         * @param host_name 域名。不包含引号。
+         */
+        void send_at_qidnsgip(const std::string& host_name)
+        {
+            post_message_unique(
+                static_cast<int>(bc26_message_t::send_at_qidnsgip),
+                std::make_shared<std::string>(host_name));
+        }
+
+    private:
+        /**
+         * @brief 生成判断已有消息是否属于同一 Socket 的条件。
+         * 不同 Socket 的同类消息互不覆盖。
+         *
+         * @tparam param_type 消息的额外数据的类型。
+         * @tparam index Socket 服务索引在 param_type 中的下标。
+         * param_type 为 int 时忽略。
+         */
+        template <typename param_type, size_t index = 0>
+        static auto is_same_socket(int connect_id)
+        {
+            return [connect_id](const std::shared_ptr<void>& data) {
+                const auto& param = *std::static_pointer_cast<param_type>(data);
+                if constexpr (std::is_same_v<param_type, int>)
+                    return param == connect_id;
+                else
+                    return std::get<index>(param) == connect_id;
+            };
+        }
+
+    public:
+        /**
+         * @brief Socket 服务是否已打开。在 AT+QIOPEN 成功后打开，
+         * 在 AT+QICLOSE、+QIURC: "closed" 或重置模块后关闭。
+         *
+         * @note 可以在任意线程中调用。反馈消息发出前状态已经更新。
+         *
+         * @param connect_id Socket 服务索引。范围 0-4。
+         */
+        bool is_socket_open(int connect_id) const
+        {
+            return _open_sockets.load() & 1u << connect_id;
+        }
         /**
          * @brief 向子模块发送消息。发送 AT+QIOPEN= 指令。打开 Socket 服务。
          *
@@ -1059,10 +2320,11 @@ namespace peripheral
                             int connect_id = 0, bool is_service_type_tcp = true)
         {
             using param_type = std::tuple<std::string, int, int, bool>;
-            post_message_unique(
+            post_message_unique_if(
                 static_cast<int>(bc26_message_t::send_at_qiopen),
                 std::make_shared<param_type>(address, remote_port, connect_id,
-                                             is_service_type_tcp));
+                                             is_service_type_tcp),
+                is_same_socket<param_type, 2>(connect_id));
         }
         /**
          * @brief 向子模块发送消息。发送 AT+QICLOSE= 指令。关闭 Socket 服务。
@@ -1071,9 +2333,10 @@ namespace peripheral
          */
         void send_at_qiclose(int connect_id = 0)
         {
-            post_message_unique(
+            post_message_unique_if(
                 static_cast<int>(bc26_message_t::send_at_qiclose),
-                std::make_shared<int>(connect_id));
+                std::make_shared<int>(connect_id),
+                is_same_socket<int>(connect_id));
         }
         /**
          * @brief 向子模块发送消息。发送 AT+QISEND= 指令。发送文本字符串数据。
@@ -1084,9 +2347,48 @@ namespace peripheral
         void send_at_qisend(const std::string& str, int connect_id = 0)
         {
             using param_type = std::tuple<std::string, int>;
-            post_message_unique(
+            post_message_unique_if(
                 static_cast<int>(bc26_message_t::send_at_qisend),
-                std::make_shared<param_type>(str, connect_id));
+                std::make_shared<param_type>(str, connect_id),
+                is_same_socket<param_type, 1>(connect_id));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QISEND= 指令。以数据模式发送任意
+         * 二进制数据。如果已设置以十六进制字符串发送，
+         * 则改为发送十六进制字符串。
+         *
+         * @note 消息中只保存指针，调用者需保证数据在收到
+         * feedback_message_enum_t::bc26_send_at_qisend 前有效。
+         *
+         * @param data 要发送的数据。
+         * @param length 数据的长度。范围 1-1024。
+         * @param connect_id Socket 服务索引。范围 0-4。默认为 0。
+         */
+        void send_at_qisend_data(const char* data, size_t length,
+                                 int connect_id = 0)
+        {
+            using param_type = std::tuple<const char*, size_t, int>;
+            // 数据不复制，所以不能覆盖之前的消息。
+            post_message(
+                static_cast<int>(bc26_message_t::send_at_qisend_data),
+                std::make_shared<param_type>(data, length, connect_id));
+        }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QICFG="dataformat"
+         * 指令。设置收发数据的格式。
+         *
+         * @note 设置后，send_at_qisend_data 与 send_at_qird
+         * 会自动编码与解码十六进制字符串，接口不变。
+         *
+         * @param is_send_hex 发送的数据是否为十六进制字符串。
+         * @param is_recv_hex 接收的数据是否为十六进制字符串。
+         */
+        void send_at_qicfg_dataformat(bool is_send_hex, bool is_recv_hex)
+        {
+            using param_type = std::tuple<bool, bool>;
+            post_message(
+                static_cast<int>(bc26_message_t::send_at_qicfg_dataformat),
+                std::make_shared<param_type>(is_send_hex, is_recv_hex));
         }
         /**
          * @brief 向子模块发送消息。发送 AT+QIRD= 指令。读取收到的 TCP/IP 数据。
@@ -1095,11 +2397,27 @@ namespace peripheral
          */
         void send_at_qird(int connect_id = 0)
         {
-            post_message_unique(static_cast<int>(bc26_message_t::send_at_qird),
-                                std::make_shared<int>(connect_id));
+            post_message_unique_if(
+                static_cast<int>(bc26_message_t::send_at_qird),
+                std::make_shared<int>(connect_id),
+                is_same_socket<int>(connect_id));
+        }
+        /**
+         * @brief 向子模块发送消息。反复发送 AT+QIRD= 指令，
+         * 把收到的 TCP/IP 数据全部读入缓冲区。
+         *
+         * @param buffer 写入数据的缓冲区。需保证在收到反馈消息前有效。
+         * @param connect_id Socket 服务索引。范围 0-4。默认为 0。
+         */
+        void send_at_qird_drain(utils::ring_buffer& buffer, int connect_id = 0)
+        {
+            using param_type = std::tuple<int, utils::ring_buffer*>;
+            post_message_unique_if(
+                static_cast<int>(bc26_message_t::send_at_qird_drain),
+                std::make_shared<param_type>(connect_id, &buffer),
+                is_same_socket<param_type, 0>(connect_id));
         }
 
-    private:
         /**
          * @brief 向子模块发送消息。发送 AT+QMTCFG= 指令。配置 MQTT 可选参数。
          *
@@ -1191,5 +2509,116 @@ namespace peripheral
                          std::make_shared<param_type>(tcp_connect_id, msg_id,
                                                       topic, qos));
         }
+        /**
+         * @brief 向子模块发送消息。发送 AT+QMTPUB= 指令。发布消息。
+         *
+         * @param tcp_connect_id MQTT Socket 标识符。范围 0-5。
+         * @param msg_id 数据包标识符，范围：0-65535。QoS 为 0 时只能为 0。
+         * @param qos QoS 等级。
+         * - 0 最多发送一次。
+         * - 1 至少发送一次。
+         * - 2 只发送一次。
+         * @param is_retain 服务器是否保留该消息。
+         * @param topic 主题。最大长度是 255 字节。不包含引号。
+         * @param payload 消息内容。不能包含 Ctrl+Z（0x1A）。
+         */
+        void send_at_qmtpub(int tcp_connect_id, int msg_id, int qos,
+                            bool is_retain, const std::string& topic,
+                            const std::string& payload)
+        {
+            using param_type =
+                std::tuple<int, int, int, bool, std::string, std::string>;
+            post_message(static_cast<int>(bc26_message_t::send_at_qmtpub),
+                         std::make_shared<param_type>(tcp_connect_id, msg_id,
+                                                      qos, is_retain, topic,
+                                                      payload));
+        }
+        /**
+         * @brief 向子模块发送消息。配置 MQTT 的保活时间。
+         *
+         * @param tcp_connect_id MQTT Socket 标识符。范围 0-5。
+         * @param keep_alive 保活时间。范围 0-3600 s。0 表示不保活。
+         */
+        void send_at_qmtcfg_keepalive(int tcp_connect_id,
+                                      std::chrono::seconds keep_alive)
+        {
+            send_at_qmtcfg("keepalive",
+                           {std::to_string(tcp_connect_id),
+                            std::to_string(keep_alive.count())});
+        }
+        /**
+         * @brief 向子模块发送消息。配置 MQTT 的会话类型。
+         *
+         * @param tcp_connect_id MQTT Socket 标识符。范围 0-5。
+         * @param is_clean_session 是否清除会话。为 false
+         * 时，服务器会保留订阅和未送达的消息，重连后恢复会话。
+         */
+        void send_at_qmtcfg_session(int tcp_connect_id, bool is_clean_session)
+        {
+            send_at_qmtcfg("session", {std::to_string(tcp_connect_id),
+                                       std::to_string(is_clean_session)});
+        }
+
+    public:
+        /**
+         * @brief 获取收发统计与能耗估算的快照。可以在任意线程中调用。
+         */
+        bc26_stats::snapshot_t stats()
+        {
+            return _stats.snapshot();
+        }
+        /**
+         * @brief 设置估算能耗用的电流模型。可以在任意线程中调用。
+         */
+        void set_current_model(const bc26_stats::current_model_t& model)
+        {
+            _stats.set_current_model(model);
+        }
+        /**
+         * @brief 调试输出收发统计与能耗估算。可以在任意线程中调用。
+         * 只输出执行过的指令，指令以 bc26_message_t 的值表示。
+         */
+        void dump_stats()
+        {
+            auto snapshot = _stats.snapshot();
+            utils::debug_printf("[I] bc26 stats: cmd count wait_ms tx rx\n");
+            for (size_t i = 0; i < snapshot.commands.size(); i++)
+            {
+                const auto& command = snapshot.commands[i];
+                if (!command.count)
+                    continue;
+                utils::debug_printf(
+                    "    %2u %6u %8u %6u %6u\n", static_cast<unsigned>(i),
+                    static_cast<unsigned>(command.count),
+                    static_cast<unsigned>(command.wait_time.count()),
+                    static_cast<unsigned>(command.bytes_sent),
+                    static_cast<unsigned>(command.bytes_received));
+            }
+            auto state_seconds = [&](bc26_stats::modem_state_t state) {
+                return static_cast<unsigned>(
+                    snapshot.state_time[static_cast<size_t>(state)].count() /
+                    1000);
+            };
+            utils::debug_printf(
+                "    active %us, idle %us, sleep %us, socket %us, %u uAh\n",
+                state_seconds(bc26_stats::modem_state_t::active),
+                state_seconds(bc26_stats::modem_state_t::idle),
+                state_seconds(bc26_stats::modem_state_t::sleep),
+                static_cast<unsigned>(snapshot.socket_open_time.count() / 1000),
+                static_cast<unsigned>(snapshot.energy_uah));
+        }
+
+    private:
+        /**
+         * @brief 向子模块发送消息。等待并处理模块主动上报的消息（URC）。
+         *
+         * @note 该函数会在消息队列为空时自动被调用。
+         */
+        void listen_urc()
+        {
+            // 不能唤醒 listen_urc 自身，否则会一直循环。
+            peripheral_std_framework::post_message_unique(
+                static_cast<int>(bc26_message_t::listen_urc), nullptr);
+        }
     };
 } // namespace peripheral
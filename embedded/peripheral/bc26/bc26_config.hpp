@@ -9,11 +9,17 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "report_queue.hpp"
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wc++17-extensions"
 
 /**
- * @brief 服务器地址。
+ * @brief 服务器地址。可以是 IP 地址或域名。域名的解析结果会被缓存。
  */
 inline constexpr char remote_address[] = "39.108.104.19";
 /**
@@ -21,4 +27,125 @@ inline constexpr char remote_address[] = "39.108.104.19";
  */
 inline constexpr int remote_port = 12345;
 
+/**
+ * @brief 与服务器通信的方式。
+ */
+enum class remote_transport_t
+{
+    /**
+     * @brief 使用 TCP 连接上报二进制的位置，并轮询服务器的指令。
+     */
+    tcp,
+    /**
+     * @brief 使用 MQTT 发布位置，并订阅服务器推送的指令。
+     */
+    mqtt,
+    /**
+     * @brief 使用 UDP 数据报上报位置，服务器在确认中捎带指令。
+     * 不需要维持连接和心跳，射频开启的时间最短。
+     */
+    udp,
+};
+/**
+ * @brief 当前使用的通信方式。
+ */
+inline constexpr remote_transport_t remote_transport = remote_transport_t::tcp;
+/**
+ * @brief 接收指令的服务器端口。只用于 TCP。
+ * 为 0 时指令、心跳与上报共用一个 Socket。不为 0 时另开一个长期保持的 Socket
+ * 接收指令与心跳，上报较慢时也能及时收到指令。
+ */
+inline constexpr int remote_command_port = 0;
+
+/**
+ * @brief 首选 DNS 服务器。为空时使用网络分配的 DNS 服务器。
+ */
+inline constexpr char dns_primary_server[] = "";
+/**
+ * @brief 备用 DNS 服务器。为空时不设置。
+ */
+inline constexpr char dns_secondary_server[] = "";
+
+/**
+ * @brief MQTT 服务器地址。可以是 IP 地址或域名。
+ */
+inline constexpr char mqtt_host[] = "39.108.104.19";
+/**
+ * @brief MQTT 服务器端口。
+ */
+inline constexpr int mqtt_port = 1883;
+/**
+ * @brief MQTT 用户名。客户端标识符使用卡号。
+ */
+inline constexpr char mqtt_username[] = "";
+/**
+ * @brief MQTT 用户名对应的密码。
+ */
+inline constexpr char mqtt_password[] = "";
+/**
+ * @brief MQTT 主题的前缀。完整的主题为 <前缀><卡号>/pos 与 <前缀><卡号>/cmd。
+ */
+inline constexpr char mqtt_topic_prefix[] = "laughing-fortnight/";
+/**
+ * @brief MQTT 的保活时间。
+ */
+inline constexpr std::chrono::seconds mqtt_keep_alive =
+    std::chrono::seconds(120);
+
+/**
+ * @brief 进入省电模式（PSM）时申请的周期性 TAU 时间。
+ * 模块每隔该时间与网络同步一次。
+ */
+inline constexpr std::chrono::seconds psm_periodic_tau = std::chrono::hours(1);
+/**
+ * @brief 进入省电模式（PSM）时申请的激活时间。
+ * 模块在空闲该时间后进入 PSM。
+ */
+inline constexpr std::chrono::seconds psm_active_time =
+    std::chrono::seconds(10);
+
+/**
+ * @brief 估算能耗用的 BC26 模块平均电流（μA）。执行指令期间，包括射频收发。
+ * 默认值为典型值，应按实测修改。
+ */
+inline constexpr uint32_t bc26_current_active_ua = 60000;
+/**
+ * @brief 估算能耗用的 BC26 模块平均电流（μA）。唤醒但空闲。
+ */
+inline constexpr uint32_t bc26_current_idle_ua = 6000;
+/**
+ * @brief 估算能耗用的 BC26 模块平均电流（μA）。允许睡眠且空闲。
+ */
+inline constexpr uint32_t bc26_current_sleep_ua = 5;
+/**
+ * @brief 调试输出收发统计的周期。
+ */
+inline constexpr std::chrono::seconds bc26_stats_dump_interval =
+    std::chrono::minutes(10);
+
+/**
+ * @brief 连接断开时暂存上报的策略。
+ */
+inline constexpr peripheral::report_queue::policy_t report_queue_policy =
+    peripheral::report_queue::policy_t::keep_all;
+/**
+ * @brief 最多暂存的上报数。
+ */
+inline constexpr size_t report_queue_capacity = 32;
+/**
+ * @brief 时钟超过该时间没有校准时，重新查询网络时间。
+ */
+inline constexpr std::chrono::seconds clock_resync_interval =
+    std::chrono::hours(6);
+/**
+ * @brief 信号质量采样结果的有效期。过期后发送前重新采样。
+ */
+inline constexpr std::chrono::seconds signal_sample_interval =
+    std::chrono::minutes(2);
+/**
+ * @brief 覆盖差时最长推迟上报的时间。
+ */
+inline constexpr std::chrono::seconds max_transmit_defer =
+    std::chrono::minutes(15);
+
 #pragma GCC diagnostic pop
@@ -0,0 +1,894 @@
+/**
+ * @file bc26_emulator.hpp
+ * @author UnnamedOrange
+ * @brief 可编排的 BC26 模块模拟器。代替串口接入 bc26，用于回归测试与时延测量。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../command_receiver_base.hpp"
+#include "../command_sender_base.hpp"
+#include "at_tokenizer.hpp"
+#include <utils/civil_time.hpp>
+
+namespace peripheral
+{
+    /**
+     * @brief 可编排的 BC26 模块模拟器。
+     *
+     * 同时实现发送与接收的接口，通过 bc26 的对应构造函数代替串口，
+     * 驱动本身不需要任何修改。模拟器按 bc26 使用的 AT 指令回复，包括初始化、
+     * Socket（含数据模式与 AT+QIRD）、域名解析、MQTT 与 URC。
+     * 可以为指定的指令设置回复延迟、注入错误或不回复，
+     * 也可以主动断开连接、推送数据、模拟失去信号。
+     *
+     * @note 回复按时刻排队，到时后通过 sigio 回调通知 bc26，与真实串口一致。
+     *
+     * @note 这个类是线程安全的。编排函数可以在任意线程中调用。
+     */
+    class bc26_emulator : public command_sender_base,
+                          public command_receiver_base
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 注入的故障。
+         */
+        enum class fault_t
+        {
+            /**
+             * @brief 回复 ERROR。
+             */
+            error,
+            /**
+             * @brief 不回复。
+             */
+            no_response,
+        };
+        /**
+         * @brief 没有信号时 AT+CESQ 返回的 <rxlev>。
+         */
+        static constexpr int no_signal = 99;
+        /**
+         * @brief 连接失败时 +QIOPEN 返回的 <result>。
+         */
+        static constexpr int error_connect_failed = 566;
+        /**
+         * @brief 域名解析失败时 +QIURC: "dnsgip" 返回的 <err>。
+         */
+        static constexpr int error_dns_failed = 565;
+
+    private:
+        /**
+         * @brief 针对某些指令的编排。
+         */
+        struct rule_t
+        {
+            // 匹配的指令前缀，例如 AT+QIOPEN。
+            std::string prefix;
+            // 回复延迟。
+            std::chrono::milliseconds delay;
+            // 剩余的故障次数。
+            int n_fault;
+            fault_t fault;
+        };
+        /**
+         * @brief 将在某一时刻输出的内容。
+         */
+        struct chunk_t
+        {
+            clock::time_point due;
+            std::string data;
+        };
+        struct dns_record_t
+        {
+            std::string host_name;
+            std::string address;
+            int ttl;
+        };
+        struct socket_t
+        {
+            bool is_open;
+            bool is_tcp;
+            std::string address;
+            int port;
+            // 模块已收到、尚未被读取的数据。
+            std::string received;
+        };
+        /**
+         * @brief 输入的解析模式。
+         */
+        enum class input_mode_t
+        {
+            command,
+            // AT+QISEND 的数据模式，接收定长的数据。
+            qisend_data,
+            // AT+QMTPUB 的数据模式，接收到 Ctrl+Z 为止。
+            qmtpub_payload,
+        };
+
+    private:
+        rtos::Mutex _mutex;
+        rtos::ConditionVariable _cond_output{_mutex};
+        mbed::Callback<void()> _sigio;
+        mbed::Timeout _timeout;
+        std::deque<chunk_t> _output;
+        std::string _input;
+        input_mode_t _input_mode{input_mode_t::command};
+        // 数据模式下的参数。
+        int _data_connect_id{};
+        size_t _data_length{};
+        int _data_msg_id{};
+        std::chrono::milliseconds _data_delay{};
+        std::vector<rule_t> _rules;
+
+        // 模块的状态。
+        bool _is_echo{true};
+        bool _is_send_hex{};
+        bool _is_recv_hex{};
+        int _cfun{1};
+        int _rxlev{40};
+        std::array<socket_t, 5> _sockets{};
+        std::array<bool, 6> _mqtt_open{};
+        std::vector<dns_record_t> _dns_records;
+        // 网络时间。为 0 表示尚未从网络获取。
+        int64_t _epoch{};
+        Kernel::Clock::time_point _epoch_time{};
+        int _ctzr{};
+        // 异步结果（例如 +QIOPEN）相对 OK 的延迟。
+        std::chrono::milliseconds _async_delay{100};
+        // 驱动通过 Socket 或 MQTT 发出的数据。
+        std::string _sent;
+        int _n_commands{};
+
+    public:
+        bc26_emulator() = default;
+        bc26_emulator(const bc26_emulator&) = delete;
+        bc26_emulator& operator=(const bc26_emulator&) = delete;
+        ~bc26_emulator()
+        {
+            _timeout.detach();
+        }
+
+    private:
+        static std::string to_hex(std::string_view data)
+        {
+            constexpr char digits[] = "0123456789ABCDEF";
+            std::string ret;
+            ret.reserve(data.length() * 2);
+            for (char ch : data)
+            {
+                auto byte = static_cast<unsigned char>(ch);
+                ret.push_back(digits[byte >> 4]);
+                ret.push_back(digits[byte & 0xF]);
+            }
+            return ret;
+        }
+        static std::string from_hex(std::string_view hex)
+        {
+            auto digit = [](char ch) -> int {
+                if ('0' <= ch && ch <= '9')
+                    return ch - '0';
+                if ('A' <= ch && ch <= 'F')
+                    return ch - 'A' + 10;
+                if ('a' <= ch && ch <= 'f')
+                    return ch - 'a' + 10;
+                return 0;
+            };
+            std::string ret;
+            for (size_t i = 0; i + 1 < hex.length(); i += 2)
+                ret.push_back(
+                    static_cast<char>(digit(hex[i]) << 4 | digit(hex[i + 1])));
+            return ret;
+        }
+        bool has_signal() const
+        {
+            return _cfun == 1 && _rxlev != no_signal;
+        }
+        /**
+         * @brief 当前的网络时间，格式为 yy/MM/dd,hh:mm:ss。需要已加锁。
+         *
+         * @param is_full_year 年份是否为四位。
+         */
+        std::string format_time(bool is_full_year) const
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                Kernel::Clock::now() - _epoch_time);
+            auto t = utils::civil_time::from_epoch(_epoch + elapsed.count());
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer),
+                          "%02d/%02d/%02d,%02d:%02d:%02d",
+                          is_full_year ? t.year : t.year % 100, t.month, t.day,
+                          t.hour, t.minute, t.second);
+            return buffer;
+        }
+
+        /**
+         * @brief 在 delay 之后输出 data。需要已加锁。
+         */
+        void push_raw(std::string data, std::chrono::milliseconds delay)
+        {
+            chunk_t chunk{clock::now() + delay, std::move(data)};
+            // 按时刻排序，同一时刻保持先后顺序。
+            auto it = _output.end();
+            while (it != _output.begin() && std::prev(it)->due > chunk.due)
+                --it;
+            _output.insert(it, std::move(chunk));
+            _cond_output.notify_all();
+        }
+        /**
+         * @brief 在 delay 之后输出一行，前后带有换行。需要已加锁。
+         */
+        void push_line(std::string_view line, std::chrono::milliseconds delay)
+        {
+            std::string data = "\r\n";
+            data += line;
+            data += "\r\n";
+            push_raw(std::move(data), delay);
+        }
+        /**
+         * @brief 安排下一次通知。在解锁后调用。
+         */
+        void schedule_sigio()
+        {
+            std::chrono::microseconds delay{};
+            mbed::Callback<void()> func;
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                if (_output.empty() || !_sigio)
+                    return;
+                func = _sigio;
+                delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                    _output.front().due - clock::now());
+            }
+            if (delay.count() <= 0)
+                func();
+            else
+                _timeout.attach(func, delay);
+        }
+        /**
+         * @brief 查找匹配指令的编排。需要已加锁。
+         *
+         * @return rule_t* 没有匹配时为 nullptr。
+         */
+        rule_t* find_rule(std::string_view command)
+        {
+            for (auto& rule : _rules)
+                if (command.substr(0, rule.prefix.length()) == rule.prefix)
+                    return &rule;
+            return nullptr;
+        }
+        rule_t& get_rule(std::string_view prefix)
+        {
+            for (auto& rule : _rules)
+                if (rule.prefix == prefix)
+                    return rule;
+            _rules.push_back(
+                rule_t{std::string(prefix), {}, 0, fault_t::error});
+            return _rules.back();
+        }
+
+        /**
+         * @brief 处理收到的内容。需要已加锁。
+         */
+        void process_input()
+        {
+            while (!_input.empty())
+            {
+                if (_input_mode == input_mode_t::qisend_data)
+                {
+                    if (_input.length() < _data_length)
+                        return;
+                    auto& socket = _sockets[_data_connect_id];
+                    _sent += _input.substr(0, _data_length);
+                    _input.erase(0, _data_length);
+                    _input_mode = input_mode_t::command;
+                    push_line(socket.is_open && has_signal() ? "SEND OK"
+                                                             : "SEND FAIL",
+                              _data_delay);
+                    continue;
+                }
+                if (_input_mode == input_mode_t::qmtpub_payload)
+                {
+                    auto end = _input.find('\x1A');
+                    if (end == std::string::npos)
+                        return;
+                    _sent += _input.substr(0, end);
+                    _input.erase(0, end + 1);
+                    _input_mode = input_mode_t::command;
+                    if (!_mqtt_open[_data_connect_id] || !has_signal())
+                    {
+                        push_line("ERROR", _data_delay);
+                        continue;
+                    }
+                    push_line("OK", _data_delay);
+                    push_line("+QMTPUB: " + std::to_string(_data_connect_id) +
+                                  "," + std::to_string(_data_msg_id) + ",0",
+                              _data_delay + _async_delay);
+                    continue;
+                }
+                auto end = _input.find('\r');
+                if (end == std::string::npos)
+                    return;
+                std::string command = _input.substr(0, end);
+                _input.erase(0, end + 1);
+                // 指令以 \r\n 结束，进入数据模式前也要去掉 \n。
+                if (!_input.empty() && _input.front() == '\n')
+                    _input.erase(0, 1);
+                // 去掉上一条指令残留的 \n。
+                while (!command.empty() &&
+                       (command.front() == '\n' || command.front() == ' '))
+                    command.erase(0, 1);
+                if (!command.empty())
+                    process_command(command);
+            }
+        }
+        /**
+         * @brief 处理一条指令。需要已加锁。
+         */
+        void process_command(const std::string& command)
+        {
+            _n_commands++;
+            std::chrono::milliseconds delay{};
+            if (auto rule = find_rule(command))
+            {
+                delay = rule->delay;
+                if (rule->n_fault > 0)
+                {
+                    rule->n_fault--;
+                    if (rule->fault == fault_t::error)
+                        push_line("ERROR", delay);
+                    return;
+                }
+            }
+            if (_is_echo)
+                push_raw(command + "\r\n", {});
+
+            // 指令名与参数。
+            auto separator = command.find_first_of("=?");
+            std::string_view name = command;
+            std::string_view params;
+            if (separator != std::string::npos)
+            {
+                name = std::string_view(command).substr(0, separator);
+                if (command[separator] == '=')
+                    params = std::string_view(command).substr(separator + 1);
+            }
+            at_fields fields{params};
+
+            if (name == "AT" || name == "AT+CPSMS" || name == "AT+CEDRXS" ||
+                name == "AT+QSCLK" || name == "AT+QMTCFG")
+                push_line("OK", delay);
+            else if (name == "ATE0" || name == "ATE1")
+            {
+                _is_echo = name == "ATE1";
+                push_line("OK", delay);
+            }
+            else if (name == "AT+QRST")
+                on_reset(delay);
+            else if (name == "AT+CFUN")
+            {
+                int mode{};
+                fields.next(mode);
+                _cfun = mode;
+                if (!has_signal())
+                    close_all();
+                push_line("OK", delay);
+            }
+            else if (name == "AT+CIMI")
+            {
+                push_line("460001234567890", delay);
+                push_line("OK", delay);
+            }
+            else if (name == "AT+CGATT")
+            {
+                push_line(has_signal() ? "+CGATT: 1" : "+CGATT: 0", delay);
+                push_line("OK", delay);
+            }
+            else if (name == "AT+CESQ")
+            {
+                int rxlev = _cfun == 1 ? _rxlev : no_signal;
+                push_line("+CESQ: " + std::to_string(rxlev) +
+                              ",99,255,255,12,53",
+                          delay);
+                push_line("OK", delay);
+            }
+            else if (name == "AT+CCLK")
+            {
+                // 返回 UTC 时间，时区以 15 分钟为单位。
+                if (_epoch)
+                {
+                    push_line("+CCLK: " + format_time(false) + "+32", delay);
+                    push_line("OK", delay);
+                }
+                else
+                    push_line("ERROR", delay);
+            }
+            else if (name == "AT+CTZR")
+            {
+                fields.next(_ctzr);
+                push_line("OK", delay);
+            }
+            else if (name == "AT+QENG")
+            {
+                // RSRP 与 <rxlev> 近似为线性关系，覆盖等级随 RSRP 降低而升高。
+                int rsrp = _rxlev - 141;
+                int ecl = rsrp > -110 ? 0 : rsrp > -120 ? 1 : 2;
+                if (has_signal())
+                {
+                    push_line("+QENG: 0,2506,2,131,\"0C82D063\"," +
+                                  std::to_string(rsrp) + ",-7," +
+                                  std::to_string(rsrp + 10) +
+                                  ",12,5,\"5B18\"," + std::to_string(ecl) +
+                                  ",-68,0",
+                              delay);
+                    push_line("OK", delay);
+                }
+                else
+                    push_line("ERROR", delay);
+            }
+            else if (name == "AT+QICFG")
+            {
+                std::string_view type;
+                int is_send_hex{};
+                int is_recv_hex{};
+                fields.next(type);
+                fields.next(is_send_hex);
+                fields.next(is_recv_hex);
+                _is_send_hex = is_send_hex;
+                _is_recv_hex = is_recv_hex;
+                push_line("OK", delay);
+            }
+            else if (name == "AT+QIDNSCFG")
+                push_line("OK", delay);
+            else if (name == "AT+QIDNSGIP")
+                on_qidnsgip(fields, delay);
+            else if (name == "AT+QIOPEN")
+                on_qiopen(fields, delay);
+            else if (name == "AT+QICLOSE")
+            {
+                int connect_id{};
+                fields.next(connect_id);
+                _sockets[connect_id % _sockets.size()].is_open = false;
+                push_line("CLOSE OK", delay);
+            }
+            else if (name == "AT+QISEND")
+                on_qisend(fields, delay);
+            else if (name == "AT+QIRD")
+                on_qird(fields, delay);
+            else if (name == "AT+QMTOPEN" || name == "AT+QMTCLOSE" ||
+                     name == "AT+QMTCONN" || name == "AT+QMTDISC" ||
+                     name == "AT+QMTSUB")
+                on_mqtt(name, fields, delay);
+            else if (name == "AT+QMTPUB")
+            {
+                int tcp_connect_id{};
+                fields.next(tcp_connect_id);
+                fields.next(_data_msg_id);
+                _data_connect_id = tcp_connect_id % _mqtt_open.size();
+                _data_delay = delay;
+                _input_mode = input_mode_t::qmtpub_payload;
+                push_raw("\r\n> ", delay);
+            }
+            else
+                push_line("ERROR", delay);
+        }
+        void on_reset(std::chrono::milliseconds delay)
+        {
+            push_line("OK", delay);
+            // 重置后恢复默认设置。
+            _is_echo = true;
+            _is_send_hex = false;
+            _is_recv_hex = false;
+            _cfun = 1;
+            _ctzr = 0;
+            for (auto& socket : _sockets)
+                socket = socket_t{};
+            _mqtt_open.fill(false);
+        }
+        void on_qidnsgip(at_fields& fields, std::chrono::milliseconds delay)
+        {
+            int context_id{};
+            std::string_view host_name;
+            fields.next(context_id);
+            fields.next(host_name);
+            push_line("OK", delay);
+            const dns_record_t* record = nullptr;
+            for (const auto& r : _dns_records)
+                if (r.host_name == host_name)
+                    record = &r;
+            if (!record || !has_signal())
+            {
+                push_line("+QIURC: \"dnsgip\"," +
+                              std::to_string(error_dns_failed),
+                          delay + _async_delay);
+                return;
+            }
+            push_line("+QIURC: \"dnsgip\",0,1," + std::to_string(record->ttl),
+                      delay + _async_delay);
+            push_line("+QIURC: \"dnsgip\",\"" + record->address + "\"",
+                      delay + _async_delay);
+        }
+        void on_qiopen(at_fields& fields, std::chrono::milliseconds delay)
+        {
+            int context_id{};
+            int connect_id{};
+            std::string_view type;
+            std::string_view address;
+            int port{};
+            fields.next(context_id);
+            fields.next(connect_id);
+            fields.next(type);
+            fields.next(address);
+            fields.next(port);
+            auto& socket = _sockets[connect_id % _sockets.size()];
+            push_line("OK", delay);
+            int result = has_signal() ? 0 : error_connect_failed;
+            if (!result)
+                socket = socket_t{true, type == "TCP", std::string(address),
+                                  port, std::string()};
+            push_line("+QIOPEN: " + std::to_string(connect_id) + "," +
+                          std::to_string(result),
+                      delay + _async_delay);
+        }
+        void on_qisend(at_fields& fields, std::chrono::milliseconds delay)
+        {
+            int connect_id{};
+            int length{};
+            std::string_view data;
+            fields.next(connect_id);
+            fields.next(length);
+            auto& socket = _sockets[connect_id % _sockets.size()];
+            if (!fields.next(data))
+            {
+                // 数据模式。先回复 >，再接收数据。
+                _data_connect_id = connect_id % _sockets.size();
+                _data_length = length;
+                _data_delay = delay;
+                _input_mode = input_mode_t::qisend_data;
+                push_raw("\r\n> ", delay);
+                return;
+            }
+            if (!socket.is_open || !has_signal())
+            {
+                push_line("ERROR", delay);
+                return;
+            }
+            _sent += _is_send_hex ? from_hex(data) : std::string(data);
+            push_line("OK", delay);
+            push_line("SEND OK", delay);
+        }
+        void on_qird(at_fields& fields, std::chrono::milliseconds delay)
+        {
+            int connect_id{};
+            int length{};
+            fields.next(connect_id);
+            fields.next(length);
+            auto& socket = _sockets[connect_id % _sockets.size()];
+            std::string data = socket.received.substr(0, length);
+            socket.received.erase(0, data.length());
+            std::string header = "+QIRD: " + std::to_string(data.length());
+            if (!socket.is_tcp && !data.empty())
+                header += ",\"" + socket.address + "\"," +
+                          std::to_string(socket.port);
+            std::string response = "\r\n" + header + "\r\n";
+            if (!data.empty())
+                response += (_is_recv_hex ? to_hex(data) : data) + "\r\n";
+            response += "\r\nOK\r\n";
+            push_raw(std::move(response), delay);
+        }
+        void on_mqtt(std::string_view name, at_fields& fields,
+                     std::chrono::milliseconds delay)
+        {
+            int tcp_connect_id{};
+            fields.next(tcp_connect_id);
+            auto& is_open = _mqtt_open[tcp_connect_id % _mqtt_open.size()];
+            std::string id = std::to_string(tcp_connect_id);
+            std::string result;
+            if (name == "AT+QMTOPEN")
+            {
+                // 没有信号时 <result> 为 3，表示 PDP 激活失败。
+                result = "+QMTOPEN: " + id + (has_signal() ? ",0" : ",3");
+                is_open = has_signal();
+            }
+            else if (name == "AT+QMTCLOSE")
+            {
+                result = "+QMTCLOSE: " + id + ",0";
+                is_open = false;
+            }
+            else if (name == "AT+QMTCONN")
+                result = "+QMTCONN: " + id + (is_open ? ",0,0" : ",2");
+            else if (name == "AT+QMTDISC")
+            {
+                result = "+QMTDISC: " + id + ",0";
+                is_open = false;
+            }
+            else // AT+QMTSUB。
+            {
+                int msg_id{};
+                std::string_view topic;
+                int qos{};
+                fields.next(msg_id);
+                fields.next(topic);
+                fields.next(qos);
+                result = "+QMTSUB: " + id + "," + std::to_string(msg_id) +
+                         (is_open ? ",0," + std::to_string(qos) : ",2");
+            }
+            push_line("OK", delay);
+            push_line(result, delay + _async_delay);
+        }
+        /**
+         * @brief 失去信号时关闭所有连接，并上报 URC。需要已加锁。
+         */
+        void close_all()
+        {
+            for (size_t i = 0; i < _sockets.size(); i++)
+            {
+                if (!_sockets[i].is_open)
+                    continue;
+                _sockets[i].is_open = false;
+                push_line("+QIURC: \"closed\"," + std::to_string(i), {});
+            }
+            for (size_t i = 0; i < _mqtt_open.size(); i++)
+            {
+                if (!_mqtt_open[i])
+                    continue;
+                _mqtt_open[i] = false;
+                push_line("+QMTSTAT: " + std::to_string(i) + ",1", {});
+            }
+        }
+
+        // 以下函数实现收发接口，由 bc26 的子线程调用。
+    public:
+        void send_command(std::string_view command) override
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _input += command;
+                process_input();
+            }
+            schedule_sigio();
+        }
+        void sigio(mbed::Callback<void()> func) override
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _sigio = func;
+            }
+            if (!func)
+                _timeout.detach();
+        }
+
+    private:
+        /**
+         * @brief 取出所有已到时刻的内容。需要已加锁。
+         */
+        std::string take_due()
+        {
+            std::string ret;
+            auto now = clock::now();
+            while (!_output.empty() && _output.front().due <= now)
+            {
+                ret += _output.front().data;
+                _output.pop_front();
+            }
+            return ret;
+        }
+        std::string receive_command_impl_blocking() override
+        {
+            std::string ret;
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                while ((ret = take_due()).empty())
+                {
+                    if (_output.empty())
+                        _cond_output.wait();
+                    else
+                        _cond_output.wait_until(_output.front().due);
+                }
+            }
+            schedule_sigio();
+            return ret;
+        }
+        std::string receive_command_impl_nonblocking() override
+        {
+            std::string ret;
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                ret = take_due();
+            }
+            schedule_sigio();
+            return ret;
+        }
+
+        // 以下函数用于编排，可在任意线程中调用。
+    public:
+        /**
+         * @brief 设置以 prefix 开头的指令的回复延迟。
+         *
+         * @param prefix 指令前缀。例如 AT+QIOPEN。
+         * @param delay 从收到指令到回复的时间。异步结果再额外延迟。
+         */
+        void set_delay(std::string_view prefix, std::chrono::milliseconds delay)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            get_rule(prefix).delay = delay;
+        }
+        /**
+         * @brief 设置域名解析的结果。address 为空时删除该域名，之后解析失败。
+         *
+         * @param host_name 域名。
+         * @param address 解析得到的 IP 地址。
+         * @param ttl DNS 记录的有效期，单位为秒。
+         */
+        void set_dns(std::string_view host_name, std::string_view address,
+                     int ttl = 600)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            for (auto it = _dns_records.begin(); it != _dns_records.end();)
+                it = it->host_name == host_name ? _dns_records.erase(it)
+                                                : std::next(it);
+            if (!address.empty())
+                _dns_records.push_back({std::string(host_name),
+                                        std::string(address), ttl});
+        }
+        /**
+         * @brief 设置异步结果（例如 +QIOPEN、+QMTCONN）相对 OK 的延迟。
+         */
+        void set_async_delay(std::chrono::milliseconds delay)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            _async_delay = delay;
+        }
+        /**
+         * @brief 让以 prefix 开头的接下来 count 条指令出现故障。
+         */
+        void inject_fault(std::string_view prefix, fault_t fault,
+                          int count = 1)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            auto& rule = get_rule(prefix);
+            rule.fault = fault;
+            rule.n_fault = count;
+        }
+        /**
+         * @brief 模拟从网络获取到时间。启用了 +CTZEU 时主动上报。
+         *
+         * @param epoch 当前的 UNIX 时间戳，单位 s。
+         */
+        void set_time(int64_t epoch)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _epoch = epoch;
+                _epoch_time = Kernel::Clock::now();
+                if (_ctzr == 3)
+                    push_line("+CTZEU: \"+32\",0,\"" + format_time(true) + "\"",
+                              {});
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 设置信号强度。设为 no_signal 表示失去信号，
+         * 会关闭所有连接并上报 URC，之后无法附着网络和打开连接。
+         *
+         * @param rxlev AT+CESQ 返回的 <rxlev>。范围 0-63，或 no_signal。
+         */
+        void set_signal(int rxlev)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _rxlev = rxlev;
+                if (!has_signal())
+                    close_all();
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 模拟服务器断开 Socket 连接，上报 +QIURC: "closed"。
+         */
+        void close_socket(int connect_id)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _sockets[connect_id % _sockets.size()].is_open = false;
+                push_line("+QIURC: \"closed\"," + std::to_string(connect_id),
+                          {});
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 模拟 MQTT 连接断开，上报 +QMTSTAT。
+         *
+         * @param err_code 错误码。1 表示连接被服务器断开或重置。
+         */
+        void close_mqtt(int tcp_connect_id, int err_code = 1)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _mqtt_open[tcp_connect_id % _mqtt_open.size()] = false;
+                push_line("+QMTSTAT: " + std::to_string(tcp_connect_id) +
+                              "," + std::to_string(err_code),
+                          {});
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 模拟 Socket 收到数据，上报 +QIURC: "recv"。
+         * 数据由 AT+QIRD 读取。
+         */
+        void push_socket_data(int connect_id, std::string_view data)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                _sockets[connect_id % _sockets.size()].received += data;
+                push_line("+QIURC: \"recv\"," + std::to_string(connect_id),
+                          {});
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 模拟 MQTT 收到消息，上报 +QMTRECV。
+         */
+        void push_mqtt_message(int tcp_connect_id, int msg_id,
+                               std::string_view topic,
+                               std::string_view payload)
+        {
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                std::string line = "+QMTRECV: ";
+                line += std::to_string(tcp_connect_id) + ",";
+                line += std::to_string(msg_id) + ",\"";
+                line += topic;
+                line += "\",\"";
+                line += payload;
+                line += "\"";
+                push_line(line, {});
+            }
+            schedule_sigio();
+        }
+        /**
+         * @brief 取出驱动通过 Socket 或 MQTT 发出的所有数据。
+         */
+        std::string take_sent()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            std::string ret;
+            ret.swap(_sent);
+            return ret;
+        }
+        /**
+         * @brief 已处理的指令数。
+         */
+        int n_commands()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _n_commands;
+        }
+        /**
+         * @brief 给定的 Socket 是否已打开。
+         */
+        bool is_socket_open(int connect_id)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _sockets[connect_id % _sockets.size()].is_open;
+        }
+    };
+} // namespace peripheral
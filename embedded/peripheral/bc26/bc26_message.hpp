@@ -49,6 +49,50 @@ namespace peripheral
          * @brief 发送 AT+CESQ 指令。获取信号质量。
          */
         send_at_cesq,
+        /**
+         * @brief 发送 AT+QENG=0 指令。获取服务小区的信号质量与覆盖等级。
+         */
+        send_at_qeng,
+        /**
+         * @brief 发送 AT+CCLK? 指令。查询网络时间。
+         */
+        send_at_cclk,
+        /**
+         * @brief 发送 AT+CTZR= 指令。设置网络时间（NITZ）的主动上报。
+         *
+         * @param int 模式。
+         * - 0 停用主动上报。
+         * - 3 启用 +CTZEU 主动上报，包含 UTC 时间。
+         */
+        send_at_ctzr,
+        /**
+         * @brief 发送 AT+CPSMS= 指令。设置省电模式（PSM）。
+         *
+         * @param bool 是否启用 PSM。
+         * @param std::string 周期性 TAU 时间。8 位二进制字符串，不包含引号。
+         * @param std::string 激活时间。8 位二进制字符串，不包含引号。
+         */
+        send_at_cpsms,
+        /**
+         * @brief 发送 AT+CEDRXS= 指令。设置 eDRX。
+         *
+         * @param int 模式。
+         * - 0 停用 eDRX。
+         * - 1 启用 eDRX。
+         * - 2 启用 eDRX，并启用 +CEDRXP 主动上报。
+         * - 3 停用 eDRX，并将参数恢复为默认值。
+         * @param std::string eDRX 周期。4 位二进制字符串，不包含引号。
+         */
+        send_at_cedrxs,
+        /**
+         * @brief 发送 AT+QSCLK= 指令。设置模块的睡眠模式。
+         *
+         * @param int 模式。
+         * - 0 禁止进入睡眠。
+         * - 1 允许进入深睡眠和浅睡眠。
+         * - 2 只允许进入浅睡眠。
+         */
+        send_at_qsclk,
 
         /**
          * @brief 综合地初始化。
@@ -57,6 +101,20 @@ namespace peripheral
          */
         init,
 
+        /**
+         * @brief 发送 AT+QIDNSCFG= 指令。设置 DNS 服务器。
+         *
+         * @param std::string 首选 DNS 服务器的 IP 地址。不包含引号。
+         * @param std::string 备用 DNS 服务器的 IP 地址。不包含引号。
+         * 为空时不设置。
+         */
+        send_at_qidnscfg,
+        /**
+         * @brief 发送 AT+QIDNSGIP= 指令。解析域名。
+         *
+         * @param std::string 域名。不包含引号。
+         */
+        send_at_qidnsgip,
         /**
          * @brief 发送 AT+QIOPEN= 指令。打开 Socket 服务。
          *
@@ -80,12 +138,37 @@ namespace peripheral
          * @param int Socket 服务索引。范围 0-4。默认为 0。
          */
         send_at_qisend,
+        /**
+         * @brief 发送 AT+QISEND= 指令。以数据模式发送任意二进制数据。
+         * 如果已设置以十六进制字符串发送，则改为发送十六进制字符串。
+         *
+         * @note 不复制数据，调用者需保证数据在收到反馈消息前有效。
+         *
+         * @param const char* 要发送的数据。
+         * @param size_t 数据的长度。范围 1-1024。
+         * @param int Socket 服务索引。范围 0-4。默认为 0。
+         */
+        send_at_qisend_data,
+        /**
+         * @brief 发送 AT+QICFG="dataformat" 指令。设置收发数据的格式。
+         *
+         * @param bool 发送的数据是否为十六进制字符串。
+         * @param bool 接收的数据是否为十六进制字符串。
+         */
+        send_at_qicfg_dataformat,
         /**
          * @brief 发送 AT+QIRD= 指令。读取收到的 TCP/IP 数据。
          *
          * @param int Socket 服务索引。范围 0-4。默认为 0。
          */
         send_at_qird,
+        /**
+         * @brief 反复发送 AT+QIRD= 指令，直到读完或缓冲区已满。
+         *
+         * @param int Socket 服务索引。范围 0-4。
+         * @param utils::ring_buffer* 写入数据的缓冲区。
+         */
+        send_at_qird_drain,
 
         /**
          * @brief 发送 AT+QMTCFG= 指令。配置 MQTT 可选参数。
@@ -138,6 +221,24 @@ namespace peripheral
          * - 2 只发送一次。
          */
         send_at_qmtsub,
+        /**
+         * @brief 发送 AT+QMTPUB= 指令。发布消息。
+         *
+         * @param int MQTT Socket 标识符。范围 0-5。
+         * @param int 数据包标识符，范围：0-65535。QoS 为 0 时只能为 0。
+         * @param int QoS 等级。范围 0-2。
+         * @param bool 服务器是否保留该消息。
+         * @param std::string 主题。最大长度是 255 字节。不包含引号。
+         * @param std::string 消息内容。不能包含 Ctrl+Z（0x1A）。
+         */
+        send_at_qmtpub,
+
+        /**
+         * @brief 等待并处理模块主动上报的消息（URC）。
+         *
+         * @note 该消息会在消息队列为空时自动发送，收到新的消息后立即返回。
+         */
+        listen_urc,
 
         _message_end,
         /**
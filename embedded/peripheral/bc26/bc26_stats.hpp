@@ -0,0 +1,231 @@
+/**
+ * @file bc26_stats.hpp
+ * @author UnnamedOrange
+ * @brief BC26 模块的收发统计与能耗估算。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "bc26_message.hpp"
+
+namespace peripheral
+{
+    /**
+     * @brief BC26 模块的收发统计与能耗估算。
+     *
+     * 按指令类型（bc26_message_t）记录执行次数、等待回复的时间、收发字节数；
+     * 按模块状态记录停留时间，并根据电流模型估算能耗。
+     *
+     * @note 这个类是线程安全的。
+     */
+    class bc26_stats
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 模块状态。
+         */
+        enum class modem_state_t
+        {
+            /**
+             * @brief 正在执行指令，包括射频收发。
+             */
+            active,
+            /**
+             * @brief 唤醒但空闲。不允许睡眠时的状态。
+             */
+            idle,
+            /**
+             * @brief 允许睡眠且空闲。近似为睡眠或 PSM。
+             */
+            sleep,
+
+            _size,
+        };
+        /**
+         * @brief 各状态下的平均电流，单位为 μA。
+         */
+        struct current_model_t
+        {
+            uint32_t active_ua;
+            uint32_t idle_ua;
+            uint32_t sleep_ua;
+        };
+        /**
+         * @brief 一种指令的统计。
+         */
+        struct command_stats_t
+        {
+            uint32_t count;
+            std::chrono::milliseconds wait_time;
+            uint32_t bytes_sent;
+            uint32_t bytes_received;
+        };
+        /**
+         * @brief 统计的快照。
+         */
+        struct snapshot_t
+        {
+            /**
+             * @brief 各指令的统计。下标为 bc26_message_t 的值。
+             */
+            std::array<command_stats_t,
+                       static_cast<size_t>(bc26_message_t::_message_size)>
+                commands;
+            /**
+             * @brief 各状态下停留的时间。下标为 modem_state_t 的值。
+             */
+            std::array<std::chrono::milliseconds,
+                       static_cast<size_t>(modem_state_t::_size)>
+                state_time;
+            /**
+             * @brief 至少有一个 Socket 或 MQTT 连接打开的时间。
+             */
+            std::chrono::milliseconds socket_open_time;
+            /**
+             * @brief 估算的能耗，单位为 μAh。
+             */
+            uint32_t energy_uah;
+        };
+
+    private:
+        rtos::Mutex _mutex;
+        current_model_t _model;
+        snapshot_t _stats{};
+        modem_state_t _state{modem_state_t::idle};
+        clock::time_point _state_since{clock::now()};
+        // 打开的连接。低 8 位为 Socket，高 8 位为 MQTT。
+        uint16_t _open_sockets{};
+        clock::time_point _socket_since{clock::now()};
+        // 已累计的能耗，单位为 μA·ms。
+        uint64_t _energy_ua_ms{};
+
+        uint32_t current_of(modem_state_t state) const
+        {
+            switch (state)
+            {
+            case modem_state_t::active:
+                return _model.active_ua;
+            case modem_state_t::idle:
+                return _model.idle_ua;
+            default:
+                return _model.sleep_ua;
+            }
+        }
+        /**
+         * @brief 把当前状态与连接持续的时间累计到统计中。需要已加锁。
+         */
+        void accumulate(clock::time_point now)
+        {
+            using std::chrono::duration_cast;
+            using std::chrono::milliseconds;
+            auto elapsed = duration_cast<milliseconds>(now - _state_since);
+            _stats.state_time[static_cast<size_t>(_state)] += elapsed;
+            _energy_ua_ms += static_cast<uint64_t>(current_of(_state)) *
+                             static_cast<uint64_t>(elapsed.count());
+            _state_since = now;
+            if (_open_sockets)
+                _stats.socket_open_time +=
+                    duration_cast<milliseconds>(now - _socket_since);
+            _socket_since = now;
+        }
+
+    public:
+        bc26_stats(const current_model_t& model) : _model(model)
+        {
+        }
+
+        /**
+         * @brief 设置电流模型。之前累计的能耗不受影响。
+         */
+        void set_current_model(const current_model_t& model)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            accumulate(clock::now());
+            _model = model;
+        }
+        /**
+         * @brief 切换模块状态。
+         */
+        void set_modem_state(modem_state_t state)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            accumulate(clock::now());
+            _state = state;
+        }
+        /**
+         * @brief 记录一次指令的执行。
+         */
+        void add_command(bc26_message_t id)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            _stats.commands[static_cast<size_t>(id)].count++;
+        }
+        /**
+         * @brief 记录发送的字节数。
+         */
+        void add_sent(bc26_message_t id, size_t bytes)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            _stats.commands[static_cast<size_t>(id)].bytes_sent += bytes;
+        }
+        /**
+         * @brief 记录等待回复的时间与收到的字节数。
+         */
+        void add_received(bc26_message_t id, std::chrono::milliseconds wait,
+                          size_t bytes)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            auto& command = _stats.commands[static_cast<size_t>(id)];
+            command.wait_time += wait;
+            command.bytes_received += bytes;
+        }
+        /**
+         * @brief 记录连接打开或关闭。
+         *
+         * @param is_mqtt 是否为 MQTT 连接。
+         * @param connect_id 连接的标识符。范围 0-7。
+         * @param is_open 是否打开。
+         */
+        void set_socket_open(bool is_mqtt, int connect_id, bool is_open)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            accumulate(clock::now());
+            uint16_t bit = 1u << ((is_mqtt ? 8 : 0) + (connect_id & 7));
+            if (is_open)
+                _open_sockets |= bit;
+            else
+                _open_sockets &= ~bit;
+        }
+        /**
+         * @brief 记录所有连接均已关闭。用于重置模块后。
+         */
+        void clear_sockets()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            accumulate(clock::now());
+            _open_sockets = 0;
+        }
+        /**
+         * @brief 获取统计的快照。
+         */
+        snapshot_t snapshot()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            accumulate(clock::now());
+            auto ret = _stats;
+            ret.energy_uah = static_cast<uint32_t>(_energy_ua_ms / 3600000);
+            return ret;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,147 @@
+/**
+ * @file bc26_timer.hpp
+ * @author UnnamedOrange
+ * @brief BC26 省电模式（PSM、eDRX）的定时器编码。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace peripheral
+{
+    /**
+     * @brief BC26 省电模式的定时器编码。
+     * AT+CPSMS 与 AT+CEDRXS 的定时器参数都是用二进制字符串表示的位组，
+     * 编码方式参见 3GPP TS 24.008。
+     */
+    class bc26_timer
+    {
+    private:
+        /**
+         * @brief 将数值转换为定长的二进制字符串。
+         *
+         * @param value 数值。
+         * @param n_bits 位数。
+         */
+        static std::string to_bits(unsigned value, int n_bits)
+        {
+            std::string ret(n_bits, '0');
+            for (int i = n_bits - 1; i >= 0; i--, value >>= 1)
+                ret[i] = static_cast<char>('0' + (value & 1));
+            return ret;
+        }
+        /**
+         * @brief 定时器的单位。
+         *
+         * @param bits 单位对应的高 3 位。
+         * @param seconds 单位对应的秒数。
+         */
+        struct unit_t
+        {
+            unsigned bits;
+            uint32_t seconds;
+        };
+        /**
+         * @brief 在给定的单位中选择最小的、能够表示给定时间的单位，向上取整。
+         * 如果都不能表示，使用最大的单位和最大值。
+         */
+        template <size_t size>
+        static std::string encode(const std::array<unit_t, size>& units,
+                                  std::chrono::seconds time)
+        {
+            constexpr unsigned max_value = 31; // 低 5 位。
+            auto seconds = static_cast<uint32_t>(time.count());
+            for (const auto& unit : units)
+            {
+                uint32_t value = (seconds + unit.seconds - 1) / unit.seconds;
+                if (value <= max_value)
+                    return to_bits(unit.bits, 3) + to_bits(value, 5);
+            }
+            return to_bits(units.back().bits, 3) + to_bits(max_value, 5);
+        }
+
+    public:
+        /**
+         * @brief 编码周期性 TAU 时间（T3412 扩展值）。
+         *
+         * @param time 期望的时间。会向上取整到可以表示的值。
+         * @return std::string 8 位二进制字符串。不包含引号。
+         */
+        static std::string encode_periodic_tau(std::chrono::seconds time)
+        {
+            // 按单位从小到大排列。
+            static constexpr std::array<unit_t, 7> units{{
+                {0b011, 2},
+                {0b100, 30},
+                {0b101, 60},
+                {0b000, 600},
+                {0b001, 3600},
+                {0b010, 36000},
+                {0b110, 1152000},
+            }};
+            return encode(units, time);
+        }
+        /**
+         * @brief 编码激活时间（T3324）。
+         *
+         * @param time 期望的时间。会向上取整到可以表示的值。
+         * @return std::string 8 位二进制字符串。不包含引号。
+         */
+        static std::string encode_active_time(std::chrono::seconds time)
+        {
+            // 按单位从小到大排列。
+            static constexpr std::array<unit_t, 3> units{{
+                {0b000, 2},
+                {0b001, 60},
+                {0b010, 360},
+            }};
+            return encode(units, time);
+        }
+        /**
+         * @brief 表示定时器被停用的编码。
+         */
+        static std::string deactivated()
+        {
+            return "11100000";
+        }
+        /**
+         * @brief 编码 NB-IoT 的 eDRX 周期。
+         *
+         * @param time 期望的周期。会向下取整到可以表示的值，至少为 20.48 s。
+         * @return std::string 4 位二进制字符串。不包含引号。
+         */
+        static std::string encode_edrx(std::chrono::milliseconds time)
+        {
+            // NB-S1 模式下可用的 eDRX 周期，按从小到大排列。
+            struct edrx_t
+            {
+                unsigned bits;
+                uint32_t milliseconds;
+            };
+            static constexpr std::array<edrx_t, 10> cycles{{
+                {0b0010, 20480},
+                {0b0011, 40960},
+                {0b0101, 81920},
+                {0b1001, 163840},
+                {0b1010, 327680},
+                {0b1011, 655360},
+                {0b1100, 1310720},
+                {0b1101, 2621440},
+                {0b1110, 5242880},
+                {0b1111, 10485760},
+            }};
+            unsigned bits = cycles.front().bits;
+            for (const auto& cycle : cycles)
+                if (cycle.milliseconds <= time.count())
+                    bits = cycle.bits;
+            return to_bits(bits, 4);
+        }
+    };
+} // namespace peripheral
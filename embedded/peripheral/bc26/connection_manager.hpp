@@ -0,0 +1,237 @@
+/**
+ * @file connection_manager.hpp
+ * @author UnnamedOrange
+ * @brief 与服务器连接的状态机。指数退避、随机抖动与逐级恢复。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace peripheral
+{
+    /**
+     * @brief 与服务器连接的状态机。
+     *
+     * 只维护状态并决定下一步的恢复动作，由调用者执行动作并反馈结果。
+     * 连续失败时，重试间隔指数增长并加入随机抖动；同一级动作失败多次后，
+     * 逐级升级为：重新打开 Socket、重启射频（CFUN）、重置模块。
+     * 重置模块后仍然失败，则回到重新打开 Socket，但重试间隔继续增长。
+     *
+     * @note 这个类不涉及串口，只维护状态。不是线程安全的。
+     */
+    class connection_manager
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 链路状态。
+         */
+        enum class state_t
+        {
+            /**
+             * @brief 未附着网络。
+             */
+            detached,
+            /**
+             * @brief 已附着网络，但没有打开 Socket。
+             */
+            attached,
+            /**
+             * @brief 已打开 Socket，但尚未确认服务器可达。
+             */
+            socket_open,
+            /**
+             * @brief 已确认服务器可达。
+             */
+            healthy,
+        };
+        /**
+         * @brief 恢复动作。
+         */
+        enum class action_t
+        {
+            /**
+             * @brief 不需要动作。
+             */
+            none,
+            /**
+             * @brief 查询是否已附着网络（AT+CGATT?）。
+             */
+            check_attach,
+            /**
+             * @brief 重新打开 Socket 或 MQTT 连接。
+             */
+            open_socket,
+            /**
+             * @brief 重启射频（AT+CFUN=0 再 AT+CFUN=1）。
+             */
+            toggle_cfun,
+            /**
+             * @brief 重置并重新初始化模块。
+             */
+            reset_module,
+        };
+
+        /**
+         * @brief 第一次重试前等待的时间。
+         */
+        static constexpr auto backoff_base = std::chrono::seconds(2);
+        /**
+         * @brief 重试间隔的上限。
+         */
+        static constexpr auto backoff_max = std::chrono::minutes(10);
+        /**
+         * @brief 同一级动作连续失败多少次后升级。
+         */
+        static constexpr int failures_per_level = 3;
+
+    private:
+        state_t _state{state_t::detached};
+        // 连续失败的次数。决定重试间隔。
+        int _n_failure{};
+        // 当前级别下连续失败的次数。决定是否升级。
+        int _n_level_failure{};
+        // 当前的恢复级别。open_socket、toggle_cfun 或 reset_module。
+        action_t _level{action_t::open_socket};
+        // 是否需要执行一次升级后的动作。
+        bool _should_escalate{};
+        // 下一次执行恢复动作的时刻。
+        std::optional<clock::time_point> _retry_time;
+        // 随机数状态，用于抖动。
+        uint32_t _random{2463534242u};
+
+        /**
+         * @brief 生成伪随机数（xorshift32）。
+         */
+        uint32_t next_random()
+        {
+            _random ^= _random << 13;
+            _random ^= _random >> 17;
+            _random ^= _random << 5;
+            return _random;
+        }
+
+    public:
+        /**
+         * @brief 设置随机抖动的种子。不同设备应使用不同的种子，
+         * 避免同一基站下的设备同时重试。
+         */
+        void seed(uint32_t value)
+        {
+            _random = value ? value : 2463534242u;
+        }
+        /**
+         * @brief 当前的链路状态。
+         */
+        state_t state() const
+        {
+            return _state;
+        }
+        /**
+         * @brief 更新链路状态。状态达到 healthy 时清除失败计数。
+         */
+        void set_state(state_t state)
+        {
+            _state = state;
+            if (state == state_t::healthy)
+            {
+                _n_failure = 0;
+                _n_level_failure = 0;
+                _level = action_t::open_socket;
+                _should_escalate = false;
+                _retry_time.reset();
+            }
+        }
+        /**
+         * @brief 当前状态下需要的下一步动作立即执行，不计为失败。
+         * 用于重启射频或重置模块之后继续恢复。
+         */
+        void retry_now()
+        {
+            _retry_time = clock::now();
+        }
+        /**
+         * @brief 报告一次失败。状态会退回 attached（如果更高），
+         * 并按退避时间安排下一次恢复动作。
+         */
+        void on_failure()
+        {
+            _state = std::min(_state, state_t::attached);
+            _n_failure++;
+            _n_level_failure++;
+            if (_n_level_failure >= failures_per_level)
+            {
+                _n_level_failure = 0;
+                switch (_level)
+                {
+                case action_t::open_socket:
+                    _level = action_t::toggle_cfun;
+                    break;
+                case action_t::toggle_cfun:
+                    _level = action_t::reset_module;
+                    break;
+                default:
+                    _level = action_t::open_socket;
+                    break;
+                }
+                _should_escalate = _level != action_t::open_socket;
+            }
+            _retry_time = clock::now() + backoff();
+        }
+        /**
+         * @brief 根据连续失败的次数计算退避时间，包含 ±25% 的随机抖动。
+         */
+        std::chrono::milliseconds backoff()
+        {
+            std::chrono::milliseconds delay = backoff_base;
+            for (int i = 1; i < _n_failure && delay < backoff_max; i++)
+                delay *= 2;
+            delay = std::min<std::chrono::milliseconds>(delay, backoff_max);
+            // 抖动范围为 [-delay / 4, delay / 4]。
+            auto range = static_cast<uint32_t>(delay.count() / 2) + 1;
+            auto offset = static_cast<int32_t>(next_random() % range) -
+                          static_cast<int32_t>(range / 2);
+            return delay + std::chrono::milliseconds(offset);
+        }
+        /**
+         * @brief 下一次执行恢复动作的时刻。没有安排时为空。
+         */
+        std::optional<clock::time_point> next_deadline() const
+        {
+            return _retry_time;
+        }
+        /**
+         * @brief 检查是否到了执行恢复动作的时刻。
+         *
+         * @return action_t 需要执行的动作。执行后应通过 set_state 或
+         * on_failure 反馈结果。
+         */
+        action_t poll()
+        {
+            if (!_retry_time || clock::now() < *_retry_time)
+                return action_t::none;
+            _retry_time.reset();
+            if (_should_escalate)
+            {
+                // 升级的动作只执行一次，之后从附着网络开始恢复。
+                // 在该级别下再失败多次才会继续升级。
+                _should_escalate = false;
+                _state = state_t::detached;
+                return _level;
+            }
+            if (_state == state_t::detached)
+                return action_t::check_attach;
+            return action_t::open_socket;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,195 @@
+/**
+ * @file dns_cache.hpp
+ * @author UnnamedOrange
+ * @brief 服务器域名的解析结果缓存。按 TTL 过期，并保存到 Flash。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include "kvstore_global_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace peripheral
+{
+    /**
+     * @brief 一个域名的解析结果缓存。
+     *
+     * 有效期内重连直接使用缓存的地址，不需要再次解析。
+     * 解析失败时可以退回到最近一次解析成功的地址，即使已经过期。
+     * 最近一次解析成功的地址保存在 KVStore 中，重启后仍然可用，
+     * 但重启后视为已过期，会先尝试重新解析。
+     * 域名本身就是 IPv4 地址时不需要解析。
+     *
+     * @note 这个类不涉及串口，只维护状态。不是线程安全的。
+     */
+    class dns_cache
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 缓存的最短有效期。TTL 过短时使用该值，避免频繁解析。
+         */
+        static constexpr auto min_ttl = std::chrono::minutes(1);
+        /**
+         * @brief 缓存的最长有效期。
+         */
+        static constexpr auto max_ttl = std::chrono::hours(24);
+
+    private:
+        std::string _host_name;
+        const char* _kv_key;
+        /**
+         * @brief 最近一次解析成功的地址。没有时为空。
+         */
+        std::string _address;
+        /**
+         * @brief 缓存过期的时刻。没有有效的缓存时为空。
+         */
+        std::optional<clock::time_point> _expire_time;
+
+    public:
+        /**
+         * @param host_name 要解析的域名或 IP 地址。
+         * @param kv_key 在 KVStore 中保存的键名。例如 /kv/dns。
+         */
+        dns_cache(std::string host_name, const char* kv_key)
+            : _host_name(std::move(host_name)), _kv_key(kv_key)
+        {
+        }
+
+    public:
+        /**
+         * @brief 判断是否为点分十进制的 IPv4 地址。
+         */
+        static bool is_ip_address(std::string_view str)
+        {
+            int n_dot = 0;
+            size_t n_digit = 0;
+            for (char ch : str)
+            {
+                if (ch == '.')
+                {
+                    if (!n_digit)
+                        return false;
+                    n_dot++;
+                    n_digit = 0;
+                }
+                else if ('0' <= ch && ch <= '9' && n_digit < 3)
+                    n_digit++;
+                else
+                    return false;
+            }
+            return n_dot == 3 && n_digit;
+        }
+
+        /**
+         * @brief 要解析的域名。
+         */
+        const std::string& host_name() const
+        {
+            return _host_name;
+        }
+        /**
+         * @brief 有效期内的地址。域名本身是 IP 地址时直接返回。
+         *
+         * @return std::optional<std::string> 地址。需要解析时为空。
+         */
+        std::optional<std::string> lookup() const
+        {
+            if (is_ip_address(_host_name))
+                return _host_name;
+            if (_address.empty() || !_expire_time ||
+                clock::now() >= *_expire_time)
+                return std::nullopt;
+            return _address;
+        }
+        /**
+         * @brief 最近一次解析成功的地址，不论是否过期。
+         *
+         * @return std::optional<std::string> 地址。从未解析成功时为空。
+         */
+        std::optional<std::string> last_good() const
+        {
+            if (is_ip_address(_host_name))
+                return _host_name;
+            if (_address.empty())
+                return std::nullopt;
+            return _address;
+        }
+        /**
+         * @brief 解析成功。地址变化时保存到 KVStore。
+         *
+         * @param address 解析得到的地址。
+         * @param ttl DNS 记录的有效期，单位为秒。
+         */
+        void on_resolved(const std::string& address, int ttl)
+        {
+            std::chrono::seconds duration = std::clamp<std::chrono::seconds>(
+                std::chrono::seconds(ttl), min_ttl, max_ttl);
+            _expire_time = clock::now() + duration;
+            if (address == _address)
+                return;
+            _address = address;
+            save();
+        }
+        /**
+         * @brief 使缓存过期。用于缓存的地址无法连接时，下次重新解析。
+         * 最近一次解析成功的地址仍然保留。
+         */
+        void invalidate()
+        {
+            _expire_time.reset();
+        }
+
+        /**
+         * @brief 从 KVStore 读取最近一次解析成功的地址。
+         * 保存的域名与当前的不同时忽略。
+         *
+         * @return bool 是否读取成功。
+         */
+        bool load()
+        {
+            char buffer[128];
+            size_t actual_size{};
+            if (kv_get(_kv_key, buffer, sizeof(buffer), &actual_size) !=
+                MBED_SUCCESS)
+                return false;
+            // 格式：<域名>\n<地址>
+            std::string_view content(buffer, actual_size);
+            auto separator = content.find('\n');
+            if (separator == std::string_view::npos ||
+                content.substr(0, separator) != _host_name ||
+                !is_ip_address(content.substr(separator + 1)))
+                return false;
+            _address = std::string(content.substr(separator + 1));
+            _expire_time.reset(); // 重启后视为已过期。
+            return true;
+        }
+        /**
+         * @brief 把最近一次解析成功的地址保存到 KVStore。
+         *
+         * @note 写 Flash 较慢且有寿命限制，只在地址变化时调用。
+         *
+         * @return bool 是否保存成功。
+         */
+        bool save() const
+        {
+            std::string content = _host_name + '\n' + _address;
+            return kv_set(_kv_key, content.data(), content.length(), 0) ==
+                   MBED_SUCCESS;
+        }
+    };
+} // namespace peripheral
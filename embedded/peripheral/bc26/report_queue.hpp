@@ -0,0 +1,180 @@
+/**
+ * @file report_queue.hpp
+ * @author UnnamedOrange
+ * @brief 待发送的上报队列。断开连接时暂存，恢复后合并发送。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <utility>
+
+namespace peripheral
+{
+    /**
+     * @brief 待发送的上报队列。有界，满时丢弃最旧的上报。
+     *
+     * 连接断开时上报先进入队列，连接恢复后把队列中的上报拼接为一次发送。
+     * 上报本身需要自带分隔符或者定长，拼接后服务器才能拆开。
+     * 同时至多一批上报在发送中，发送失败时放回队列。
+     *
+     * @note 这个类不涉及串口，只维护状态。不是线程安全的。
+     */
+    class report_queue
+    {
+    public:
+        /**
+         * @brief 暂存的策略。
+         */
+        enum class policy_t
+        {
+            /**
+             * @brief 只保留最新的一条上报。适合只关心当前位置的情形。
+             */
+            keep_latest,
+            /**
+             * @brief 保留最近的若干条上报，用于补齐断开期间的轨迹。
+             */
+            keep_all,
+        };
+
+    private:
+        policy_t _policy;
+        size_t _capacity;
+        std::deque<std::string> _queue;
+        /**
+         * @brief 正在发送的一批上报。
+         */
+        std::deque<std::string> _in_flight;
+        size_t _n_dropped{};
+        /**
+         * @brief 上次 take_n_dropped 时的丢弃总数。
+         */
+        size_t _n_dropped_taken{};
+
+        /**
+         * @brief 按照策略和容量丢弃多余的上报，保留最新的。
+         */
+        void trim()
+        {
+            size_t capacity = _policy == policy_t::keep_latest ? 1 : _capacity;
+            while (_queue.size() > capacity)
+            {
+                _queue.pop_front();
+                _n_dropped++;
+            }
+        }
+
+    public:
+        /**
+         * @param policy 暂存的策略。
+         * @param capacity 最多暂存的上报数。策略为 keep_latest 时忽略。
+         */
+        report_queue(policy_t policy, size_t capacity)
+            : _policy(policy), _capacity(capacity ? capacity : 1)
+        {
+        }
+
+    public:
+        /**
+         * @brief 加入一条上报。空的上报会被忽略。
+         */
+        void push(std::string report)
+        {
+            if (report.empty())
+                return;
+            _queue.push_back(std::move(report));
+            trim();
+        }
+        /**
+         * @brief 取出一批上报，拼接为一次发送的内容，并记为发送中。
+         *
+         * @param max_length 拼接后的最大长度。至少取出一条。
+         * @return std::string 要发送的内容。队列为空或已有一批在发送中时为空。
+         */
+        std::string take_batch(size_t max_length)
+        {
+            std::string batch;
+            if (!_in_flight.empty())
+                return batch;
+            while (!_queue.empty() &&
+                   (batch.empty() ||
+                    batch.length() + _queue.front().length() <= max_length))
+            {
+                batch += _queue.front();
+                _in_flight.push_back(std::move(_queue.front()));
+                _queue.pop_front();
+            }
+            return batch;
+        }
+        /**
+         * @brief 发送中的一批上报已有结果。
+         *
+         * @param is_success 是否发送成功。失败时放回队列头部，
+         * 之后加入的上报仍然优先保留。
+         */
+        void on_sent(bool is_success)
+        {
+            if (!is_success)
+            {
+                while (!_in_flight.empty())
+                {
+                    _queue.push_front(std::move(_in_flight.back()));
+                    _in_flight.pop_back();
+                }
+                trim();
+            }
+            _in_flight.clear();
+        }
+        /**
+         * @brief 队列中是否没有待发送的上报。不包括发送中的上报。
+         */
+        bool empty() const
+        {
+            return _queue.empty();
+        }
+        /**
+         * @brief 队列中待发送的上报数。不包括发送中的上报。
+         */
+        size_t size() const
+        {
+            return _queue.size();
+        }
+        /**
+         * @brief 队列是否已满。再加入上报就会丢弃最旧的。
+         */
+        bool is_full() const
+        {
+            return _queue.size() >=
+                   (_policy == policy_t::keep_latest ? 1 : _capacity);
+        }
+        /**
+         * @brief 是否有一批上报在发送中。
+         */
+        bool is_in_flight() const
+        {
+            return !_in_flight.empty();
+        }
+        /**
+         * @brief 因队列已满而丢弃的上报总数。
+         */
+        size_t n_dropped() const
+        {
+            return _n_dropped;
+        }
+        /**
+         * @brief 自上次调用以来因队列已满而丢弃的上报数。用于只输出一次。
+         */
+        size_t take_n_dropped()
+        {
+            size_t ret = _n_dropped - _n_dropped_taken;
+            _n_dropped_taken = _n_dropped;
+            return ret;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,181 @@
+/**
+ * @file transmit_scheduler.hpp
+ * @author UnnamedOrange
+ * @brief 按信号质量安排上报的时机。覆盖差时推迟，覆盖好转后合并发送。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace peripheral
+{
+    /**
+     * @brief 按信号质量安排上报的时机。
+     *
+     * 在小区边缘发送，每字节的能耗是覆盖良好时的数倍，也最容易重传。
+     * 覆盖差时推迟不紧急的上报，由调用者暂存；推迟期间定期重新采样，
+     * 覆盖好转或推迟超过上限时再发送。没有采样结果时不推迟。
+     *
+     * @note 这个类不涉及串口，只维护状态。不是线程安全的。
+     */
+    class transmit_scheduler
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 覆盖等级。
+         */
+        enum class coverage_t
+        {
+            /**
+             * @brief 没有采样结果或采样失败。
+             */
+            unknown,
+            /**
+             * @brief 覆盖差。推迟不紧急的上报。
+             */
+            poor,
+            /**
+             * @brief 覆盖一般。
+             */
+            fair,
+            /**
+             * @brief 覆盖良好。
+             */
+            good,
+        };
+
+        /**
+         * @brief 根据 AT+QENG=0 的结果判断覆盖等级。
+         *
+         * @param rsrp 参考信号接收功率，单位 dBm。
+         * @param ecl 覆盖增强等级。范围 0-2。
+         */
+        static coverage_t from_qeng(int rsrp, int ecl)
+        {
+            if (ecl >= 2 || rsrp <= -120)
+                return coverage_t::poor;
+            if (ecl == 1 || rsrp <= -110)
+                return coverage_t::fair;
+            return coverage_t::good;
+        }
+        /**
+         * @brief 根据 AT+CESQ 的 <rxlev> 判断覆盖等级。
+         *
+         * @param rxlev 范围 0-63，99 表示未知。
+         */
+        static coverage_t from_cesq(int rxlev)
+        {
+            if (rxlev < 0 || rxlev > 63)
+                return coverage_t::unknown;
+            if (rxlev <= 10)
+                return coverage_t::poor;
+            if (rxlev <= 20)
+                return coverage_t::fair;
+            return coverage_t::good;
+        }
+
+    private:
+        clock::duration _sample_interval;
+        clock::duration _max_defer;
+        coverage_t _coverage{coverage_t::unknown};
+        std::optional<clock::time_point> _sample_time;
+        bool _is_sampling{};
+        /**
+         * @brief 开始推迟的时刻。没有推迟时为空。
+         */
+        std::optional<clock::time_point> _defer_time;
+
+    public:
+        /**
+         * @param sample_interval 采样结果的有效期。
+         * @param max_defer 最长推迟的时间。
+         */
+        transmit_scheduler(clock::duration sample_interval,
+                           clock::duration max_defer)
+            : _sample_interval(sample_interval), _max_defer(max_defer)
+        {
+        }
+
+    public:
+        /**
+         * @brief 采样结果是否已过期，需要重新采样。正在采样时为 false。
+         */
+        bool needs_sample() const
+        {
+            return !_is_sampling &&
+                   (!_sample_time ||
+                    clock::now() - *_sample_time >= _sample_interval);
+        }
+        /**
+         * @brief 记为正在采样，直到 on_sample 被调用。
+         */
+        void on_sampling()
+        {
+            _is_sampling = true;
+        }
+        /**
+         * @brief 得到采样结果。
+         */
+        void on_sample(coverage_t coverage)
+        {
+            _is_sampling = false;
+            _coverage = coverage;
+            _sample_time = clock::now();
+        }
+        /**
+         * @brief 最近一次采样的覆盖等级。
+         */
+        coverage_t coverage() const
+        {
+            return _coverage;
+        }
+        /**
+         * @brief 现在是否应该发送。不应该发送时开始或继续推迟。
+         *
+         * @param is_urgent 是否紧急。紧急的上报不推迟。
+         */
+        bool should_send(bool is_urgent)
+        {
+            auto now = clock::now();
+            if (!is_urgent && _coverage == coverage_t::poor)
+            {
+                if (!_defer_time)
+                    _defer_time = now;
+                if (now - *_defer_time < _max_defer)
+                    return false;
+            }
+            _defer_time.reset();
+            return true;
+        }
+        /**
+         * @brief 是否正在推迟上报。
+         */
+        bool is_deferring() const
+        {
+            return _defer_time.has_value();
+        }
+        /**
+         * @brief 推迟期间下一次需要检查的时刻，即重新采样或推迟到期中较早的。
+         * 没有推迟时为空。正在采样时只考虑推迟到期，采样结果由调用者处理。
+         */
+        std::optional<clock::time_point> next_deadline() const
+        {
+            if (!_defer_time)
+                return std::nullopt;
+            auto deadline = *_defer_time + _max_defer;
+            if (_sample_time && !_is_sampling)
+                deadline = std::min(deadline, *_sample_time + _sample_interval);
+            return deadline;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,147 @@
+/**
+ * @file udp_reporter.hpp
+ * @author UnnamedOrange
+ * @brief 基于 UDP 数据报的可靠上报。序号、确认与重传。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace peripheral
+{
+    /**
+     * @brief 基于 UDP 数据报的可靠上报。停等协议，同时至多一条上报未确认。
+     *
+     * 上报帧格式：<序号>|<内容>。
+     * 确认帧格式：ack <序号>[;<指令>]。服务器可以在确认中捎带指令，
+     * 也可以直接发送不带 ack 的指令。
+     *
+     * @note 这个类不涉及串口，只维护状态。不是线程安全的。
+     */
+    class udp_reporter
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 首次重传前等待确认的时间。之后每次重传加倍。
+         */
+        static constexpr auto ack_timeout = std::chrono::seconds(4);
+        /**
+         * @brief 最大重传次数。超过后放弃该上报。
+         */
+        static constexpr int max_retransmit = 3;
+
+    private:
+        /**
+         * @brief 未确认的上报。
+         */
+        struct pending_t
+        {
+            uint16_t seq;
+            std::string frame;
+            clock::time_point deadline;
+            int n_retransmit;
+        };
+        std::optional<pending_t> _pending;
+        uint16_t _next_seq{1};
+
+    public:
+        /**
+         * @brief 生成新的上报帧，并记为未确认。会替换之前未确认的上报。
+         *
+         * @param content 上报的内容。
+         * @return std::string 要发送的数据报。
+         */
+        std::string make_frame(const std::string& content)
+        {
+            uint16_t seq = _next_seq++;
+            if (!_next_seq) // 0 保留，不使用。
+                _next_seq = 1;
+            std::string frame = std::to_string(seq) + "|" + content;
+            _pending = pending_t{seq, frame, clock::now() + ack_timeout, 0};
+            return frame;
+        }
+        /**
+         * @brief 处理收到的一个数据报。
+         *
+         * @param datagram 收到的数据报。
+         * @return std::string 其中包含的指令。没有指令时为空。
+         */
+        std::string on_datagram(std::string_view datagram)
+        {
+            constexpr std::string_view ack_prefix = "ack ";
+            if (datagram.substr(0, ack_prefix.length()) != ack_prefix)
+                return std::string(datagram); // 不是确认，整体视为指令。
+
+            auto separator = datagram.find(';');
+            std::string seq_str{
+                datagram.substr(ack_prefix.length(),
+                                separator == std::string_view::npos
+                                    ? std::string_view::npos
+                                    : separator - ack_prefix.length())};
+            unsigned seq{};
+            if (1 == sscanf(seq_str.c_str(), "%u", &seq) && _pending &&
+                _pending->seq == seq)
+                _pending.reset(); // 已确认。
+
+            if (separator == std::string_view::npos)
+                return std::string();
+            return std::string(datagram.substr(separator + 1));
+        }
+        /**
+         * @brief 检查是否需要重传。
+         *
+         * @return std::optional<std::string> 需要重传的数据报。
+         * 不需要重传或已放弃时为空。
+         */
+        std::optional<std::string> poll_retransmit()
+        {
+            if (!_pending || clock::now() < _pending->deadline)
+                return std::nullopt;
+            if (_pending->n_retransmit >= max_retransmit)
+            {
+                _pending.reset(); // 放弃。
+                return std::nullopt;
+            }
+            _pending->n_retransmit++;
+            _pending->deadline =
+                clock::now() + ack_timeout * (1 << _pending->n_retransmit);
+            return _pending->frame;
+        }
+        /**
+         * @brief 是否有未确认的上报。
+         */
+        bool has_pending() const
+        {
+            return _pending.has_value();
+        }
+        /**
+         * @brief 下一次需要检查重传的时刻。没有未确认的上报时为空。
+         */
+        std::optional<clock::time_point> next_deadline() const
+        {
+            if (!_pending)
+                return std::nullopt;
+            return _pending->deadline;
+        }
+        /**
+         * @brief 放弃未确认的上报。
+         */
+        void reset()
+        {
+            _pending.reset();
+        }
+    };
+} // namespace peripheral
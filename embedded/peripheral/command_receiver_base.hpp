@@ -60,5 +60,15 @@ namespace peripheral
             rtos::ThisThread::sleep_for(wait_time);
             return receive_command_impl_nonblocking();
         }
+        /**
+         * @brief 设置收到数据时的回调函数。可能在中断上下文中调用。
+         *
+         * @note 默认不支持，忽略回调函数。需要的子类覆盖该函数。
+         *
+         * @param func 回调函数。为空时取消回调。
+         */
+        virtual void sigio(mbed::Callback<void()> func)
+        {
+        }
     };
 } // namespace peripheral
@@ -86,5 +86,14 @@ namespace peripheral
             _serial.set_blocking(false);
             return _read();
         }
+
+    public:
+        /**
+         * @brief 设置串口收到数据时的回调函数。在中断上下文中调用。
+         */
+        void sigio(mbed::Callback<void()> func) override
+        {
+            _serial.sigio(func);
+        }
     };
 } // namespace peripheral
@@ -114,6 +114,60 @@ namespace peripheral
          * @param int 信号强度。
          */
         bc26_send_at_cesq,
+        /**
+         * @brief BC26 模块 send_at_qeng 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         * @param int 参考信号接收功率（RSRP），单位 dBm。
+         * @param int 信噪比（SINR），单位 dB。
+         * @param int 覆盖增强等级（ECL）。范围 0-2，越大覆盖越差。
+         */
+        bc26_send_at_qeng,
+        /**
+         * @brief BC26 模块 send_at_cclk 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK 且时间有效。
+         * @param int64_t UTC 时间的 UNIX 时间戳，单位 s。
+         */
+        bc26_send_at_cclk,
+        /**
+         * @brief BC26 模块 send_at_ctzr 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_ctzr,
+        /**
+         * @brief BC26 模块 send_at_cpsms 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_cpsms,
+        /**
+         * @brief BC26 模块 send_at_cedrxs 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_cedrxs,
+        /**
+         * @brief BC26 模块 send_at_qsclk 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_qsclk,
+        /**
+         * @brief BC26 模块 send_at_qidnscfg 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_qidnscfg,
+        /**
+         * @brief BC26 模块 send_at_qidnsgip 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK 且解析成功。
+         * @param string 解析得到的第一个 IP 地址。
+         * @param int DNS 记录的有效期，单位为秒。
+         */
+        bc26_send_at_qidnsgip,
         /**
          * @brief BC26 模块 send_at_qiopen 的反馈消息。
          *
@@ -126,25 +180,47 @@ namespace peripheral
          * @brief BC26 模块 send_at_qiclose 的反馈消息。
          *
          * @param bool 是否成功收到 CLOSE OK。
+         * @param int Socket 服务索引。范围 0-4。
          */
         bc26_send_at_qiclose,
         /**
-         * @brief BC26 模块 send_at_qisend 的反馈消息。
+         * @brief BC26 模块 send_at_qisend 与 send_at_qisend_data 的反馈消息。
          *
          * @note 没有收到 OK 可以认为连接已断开。
          *
-         * @param bool 是否成功收到 SEND OK。
+         * @note 收到该消息后，send_at_qisend_data 的数据可以被释放。
+         *
+         * @param bool 是否成功收到 SEND OK。Socket 未打开时直接为 false。
+         * @param int Socket 服务索引。范围 0-4。
          */
         bc26_send_at_qisend,
+        /**
+         * @brief BC26 模块 send_at_qicfg_dataformat 的反馈消息。
+         *
+         * @param bool 是否成功收到 OK。
+         */
+        bc26_send_at_qicfg_dataformat,
         /**
          * @brief BC26 模块 send_at_qird 的反馈消息。
          *
          * @note 没有收到 OK 可以认为连接已断开。
          *
-         * @param bool 是否成功收到 OK。
+         * @param bool 是否成功收到 OK。Socket 未打开时直接为 false。
          * @param std::string 读出的缓冲区信息。
+         * @param int Socket 服务索引。范围 0-4。
          */
         bc26_send_at_qird,
+        /**
+         * @brief BC26 模块 send_at_qird_drain 的反馈消息。
+         *
+         * @note 没有收到 OK 可以认为连接已断开。
+         *
+         * @param bool 是否每次都成功收到 OK。Socket 未打开时直接为 false。
+         * @param size_t 写入缓冲区的总字节数。
+         * @param bool 是否已读完。为 false 时缓冲区已满，模块中还有数据。
+         * @param int Socket 服务索引。范围 0-4。
+         */
+        bc26_send_at_qird_drain,
         /**
          * @brief BC26 模块 send_at_qmtcfg 的反馈消息。
          *
@@ -221,6 +297,62 @@ namespace peripheral
          * - 若命令执行结果为 2，则不显示。
          */
         bc26_send_at_qmtsub,
+        /**
+         * @brief BC26 模块 send_at_qmtpub 的反馈信息。
+         *
+         * @param bool 是否成功收到 OK 且成功解析结果。
+         * @param int MQTT Socket 标识符。范围 0-5。
+         * @param int 数据包标识符，范围：0-65535。
+         * @param int 命令执行结果。
+         * - 0 数据包发送成功且接收到服务器的 ACK。QoS 为 0 时不需要 ACK。
+         * - 1 数据包重传。
+         * - 2 数据包发送失败。
+         */
+        bc26_send_at_qmtpub,
+        /**
+         * @brief BC26 模块收到服务器推送的 MQTT 消息（+QMTRECV）。
+         *
+         * @param int MQTT Socket 标识符。范围 0-5。
+         * @param int 数据包标识符，范围：0-65535。
+         * @param std::string 主题。
+         * @param std::string 消息内容。
+         */
+        bc26_mqtt_recv,
+        /**
+         * @brief BC26 模块上报 MQTT 链路状态的变化（+QMTSTAT）。
+         * 收到该消息说明 MQTT 连接已断开。
+         *
+         * @param int MQTT Socket 标识符。范围 0-5。
+         * @param int 错误码。
+         * - 1 连接被服务器关闭或被重置。
+         * - 2 发送 PINGREQ 包超时或失败。
+         * - 3 发送 CONNECT 包超时或失败。
+         * - 4 接收 CONNACK 包超时或失败。
+         * - 5 客户端向服务器发送 DISCONNECT 包，但服务器主动断开。
+         * - 6 因发送数据包总是失败，客户端主动断开。
+         * - 7 链路不工作或服务器不可用。
+         */
+        bc26_mqtt_stat,
+        /**
+         * @brief BC26 模块上报 Socket 服务被关闭（+QIURC: "closed"）。
+         *
+         * @param int Socket 服务索引。范围 0-4。
+         */
+        bc26_qiurc_closed,
+        /**
+         * @brief BC26 模块上报 Socket 服务收到了数据（+QIURC: "recv"）。
+         * 收到该消息后应使用 send_at_qird 读取数据。
+         *
+         * @param int Socket 服务索引。范围 0-4。
+         */
+        bc26_qiurc_recv,
+        /**
+         * @brief BC26 模块上报网络时间（+CTZEU）。
+         * 需要先使用 send_at_ctzr 启用。
+         *
+         * @param int64_t UTC 时间的 UNIX 时间戳，单位 s。
+         */
+        bc26_nitz,
         /**
          * @brief BC26 模块消息的终止点。不包含初始化消息。
          */
@@ -236,6 +368,12 @@ namespace peripheral
          * @param nmea_parser::position_t 位置信息。
          */
         gps_notify,
+        /**
+         * @brief GPS 模块切换输出协议的结果。
+         *
+         * @param bool 是否所有配置都收到了 ACK。
+         */
+        gps_set_ubx_only,
         /**
          * @brief GPS 模块消息的终止点。不包含初始化消息。
          */
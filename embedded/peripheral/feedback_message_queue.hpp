@@ -79,6 +79,18 @@ namespace peripheral
         {
             return raw_to_msg(message_queue::get_message());
         }
+        /**
+         * @brief 阻塞地获取消息队列中的消息。如果队列为空则等待，
+         * 至多等待到给定的时刻。
+         *
+         * @param deadline 最晚返回的时刻。
+         * @return message_t 收到的消息。
+         * 如果超时，返回 {feedback_message_enum_t::null, nullptr}。
+         */
+        message_t get_message_until(Kernel::Clock::time_point deadline)
+        {
+            return raw_to_msg(message_queue::get_message_until(deadline));
+        }
         /**
          * @brief 阻塞地获取消息队列中的消息。如果队列中没有范围内的消息则等待。
          *
@@ -0,0 +1,299 @@
+/**
+ * @file fix_filter.hpp
+ * @author UnnamedOrange
+ * @brief 过滤 GPS 定位：剔除不可能的跳变，并用卡尔曼滤波平滑。
+ * 不依赖 Mbed。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "gps_config.hpp"
+#include "nmea_epoch.hpp"
+
+namespace peripheral
+{
+    /**
+     * @brief 定位的过滤器。
+     *
+     * 坐标先换算为以参考点为原点的局部坐标（北、东，单位 cm），
+     * 两个方向各用一个匀速模型的卡尔曼滤波器，状态为位置与速度。
+     * 测量噪声由 HDOP 乘以测距误差得到，HDOP 越大的定位权重越小。
+     * 与上一次结果的距离超过最大速度能到达的范围时，认为是多径等造成的
+     * 跳变而剔除；连续多次跳变则认为确实发生了移动，从新位置重新开始。
+     *
+     * 除了换算经度时计算一次参考点的余弦，全部使用整数运算。
+     *
+     * @note 这个类只维护状态。不是线程安全的。
+     */
+    class fix_filter
+    {
+    public:
+        /**
+         * @brief 一次更新的结果。
+         */
+        enum class result_t
+        {
+            /**
+             * @brief 定位被剔除。
+             */
+            rejected,
+            /**
+             * @brief 定位被接受，但与上一次报告的位置相比没有明显移动。
+             */
+            unchanged,
+            /**
+             * @brief 定位被接受，且需要报告。移动足够远，或距上一次报告
+             * 足够久。
+             */
+            moved,
+        };
+
+    private:
+        /**
+         * @brief 卡尔曼增益等比例的小数位数。
+         */
+        static constexpr int q_bits = 16;
+        /**
+         * @brief 1e-7 度纬度对应的长度，单位为 1e-4 cm。
+         */
+        static constexpr int64_t cm_per_unit_e4 = 11132;
+        /**
+         * @brief 局部坐标的范围，单位 cm。超出后重新选取参考点。
+         */
+        static constexpr int64_t max_local_range = 100 * 1000 * 100;
+        /**
+         * @brief HDOP 的下限与缺省值，单位 0.01。
+         */
+        static constexpr int64_t min_hdop = 50;
+        static constexpr int64_t default_hdop = 200;
+
+        /**
+         * @brief 乘以 Q16 的比例并四舍五入。
+         */
+        static int64_t scale(int64_t k, int64_t value)
+        {
+            return (k * value + (int64_t{1} << (q_bits - 1))) >> q_bits;
+        }
+
+        /**
+         * @brief 一个方向上的滤波器。
+         * 位置单位 cm，速度单位 cm/s，p00、p01、p11 为协方差矩阵的元素。
+         */
+        struct axis_t
+        {
+            int64_t x;
+            int64_t v;
+            int64_t p00;
+            int64_t p01;
+            int64_t p11;
+
+            void reset(int64_t z, int64_t r)
+            {
+                constexpr int64_t v_sigma = 10 * 100; // 初始速度未知。
+                x = z;
+                v = 0;
+                p00 = r;
+                p01 = 0;
+                p11 = v_sigma * v_sigma;
+            }
+            /**
+             * @brief 预测 dt 秒后的状态。q 为加速度的方差，单位 cm²/s⁴。
+             */
+            void predict(int64_t dt, int64_t q)
+            {
+                x += v * dt;
+                p00 += 2 * dt * p01 + dt * dt * p11 +
+                       q * dt * dt * dt * dt / 4;
+                p01 += dt * p11 + q * dt * dt * dt / 2;
+                p11 += q * dt * dt;
+            }
+            /**
+             * @brief 用测量值 z 更新状态。r 为测量噪声的方差，单位 cm²。
+             */
+            void update(int64_t z, int64_t r)
+            {
+                int64_t s = p00 + r;
+                int64_t k0 = (p00 << q_bits) / s;
+                int64_t k1 = (p01 << q_bits) / s;
+                int64_t y = z - x;
+                x += scale(k0, y);
+                v += scale(k1, y);
+                int64_t n00 = p00 - scale(k0, p00);
+                int64_t n01 = p01 - scale(k0, p01);
+                int64_t n11 = p11 - scale(k1, p01);
+                p00 = n00;
+                p01 = n01;
+                p11 = n11;
+            }
+        };
+
+        bool _is_valid{};
+        int32_t _ref_latitude{};
+        int32_t _ref_longitude{};
+        /**
+         * @brief 参考点纬度的余弦，Q15。
+         */
+        int64_t _ref_cos{};
+        axis_t _north{};
+        axis_t _east{};
+        uint32_t _utc{};
+        int _n_rejects{};
+        int64_t _reported_north{};
+        int64_t _reported_east{};
+        uint32_t _reported_utc{};
+
+    public:
+        /**
+         * @brief 清除状态。下一次定位直接被接受并报告。
+         * 用于 GPS 恢复后，设备可能已经移动。
+         */
+        void reset()
+        {
+            _is_valid = false;
+            _n_rejects = 0;
+        }
+        /**
+         * @brief 输入一次定位。被接受时把坐标替换为滤波后的坐标。
+         *
+         * @param pos 有效的定位。
+         * @return result_t 更新的结果。
+         */
+        result_t update(nmea_position_t& pos)
+        {
+            if (!pos.is_valid)
+                return result_t::rejected;
+            int64_t r = measurement_variance(pos.hdop);
+            // 时间倒退、间隔过长或离参考点太远时重新开始。
+            if (!_is_valid || pos.utc <= _utc ||
+                pos.utc - _utc > std::chrono::seconds(gps_filter_max_gap)
+                                     .count())
+                return restart(pos, r);
+            int64_t north;
+            int64_t east;
+            to_local(pos, north, east);
+            if (std::abs(north) > max_local_range ||
+                std::abs(east) > max_local_range)
+                return restart(pos, r);
+
+            // 以上一次的结果为起点，判断能否在这段时间内到达。
+            int64_t dt = pos.utc - _utc;
+            int64_t dn = north - _north.x;
+            int64_t de = east - _east.x;
+            int64_t reach = gps_filter_max_speed * 100 * dt +
+                            3 * measurement_sigma(pos.hdop);
+            if (dn * dn + de * de > reach * reach)
+            {
+                if (++_n_rejects < gps_filter_max_rejects)
+                    return result_t::rejected;
+                return restart(pos, r);
+            }
+            _n_rejects = 0;
+
+            int64_t q = gps_filter_acceleration * 100;
+            q *= q;
+            _north.predict(dt, q);
+            _east.predict(dt, q);
+            _north.update(north, r);
+            _east.update(east, r);
+            _utc = pos.utc;
+            to_global(_north.x, _east.x, pos);
+            return check_report(pos.utc);
+        }
+
+    private:
+        static int64_t measurement_sigma(int16_t hdop)
+        {
+            int64_t h =
+                hdop < 0 ? default_hdop : std::max<int64_t>(hdop, min_hdop);
+            return h * gps_filter_uere;
+        }
+        static int64_t measurement_variance(int16_t hdop)
+        {
+            int64_t sigma = measurement_sigma(hdop);
+            return sigma * sigma;
+        }
+        /**
+         * @brief 以当前定位为参考点与初始状态，重新开始。
+         */
+        result_t restart(const nmea_position_t& pos, int64_t r)
+        {
+            _is_valid = true;
+            _n_rejects = 0;
+            _ref_latitude = pos.latitude;
+            _ref_longitude = pos.longitude;
+            _ref_cos = static_cast<int64_t>(
+                std::cos(pos.latitude * 1e-7 * 3.14159265358979 / 180) *
+                (1 << 15));
+            _ref_cos = std::max<int64_t>(_ref_cos, 1);
+            _north.reset(0, r);
+            _east.reset(0, r);
+            _utc = pos.utc;
+            // 重新开始后总是报告一次。
+            _reported_north = 0;
+            _reported_east = 0;
+            _reported_utc = pos.utc;
+            return result_t::moved;
+        }
+        /**
+         * @brief 判断是否需要报告。需要时记录本次的位置与时间。
+         */
+        result_t check_report(uint32_t utc)
+        {
+            int64_t dn = _north.x - _reported_north;
+            int64_t de = _east.x - _reported_east;
+            int64_t min_distance = gps_filter_min_distance * 100;
+            if (dn * dn + de * de < min_distance * min_distance &&
+                utc - _reported_utc <
+                    std::chrono::seconds(gps_filter_max_interval).count())
+                return result_t::unchanged;
+            _reported_north = _north.x;
+            _reported_east = _east.x;
+            _reported_utc = utc;
+            return result_t::moved;
+        }
+        /**
+         * @brief 经度差。跨过 180° 经线时取较短的一侧。
+         */
+        static int64_t longitude_difference(int32_t a, int32_t b)
+        {
+            constexpr int64_t full_circle = 3600000000;
+            int64_t d = static_cast<int64_t>(a) - b;
+            if (d > full_circle / 2)
+                d -= full_circle;
+            else if (d < -full_circle / 2)
+                d += full_circle;
+            return d;
+        }
+        void to_local(const nmea_position_t& pos, int64_t& north,
+                      int64_t& east) const
+        {
+            int64_t d_lat = static_cast<int64_t>(pos.latitude) - _ref_latitude;
+            int64_t d_lon = longitude_difference(pos.longitude,
+                                                 _ref_longitude);
+            north = d_lat * cm_per_unit_e4 / 10000;
+            east = (d_lon * cm_per_unit_e4 / 10000 * _ref_cos) >> 15;
+        }
+        void to_global(int64_t north, int64_t east, nmea_position_t& pos) const
+        {
+            constexpr int64_t half_circle = 1800000000;
+            pos.latitude = static_cast<int32_t>(
+                _ref_latitude + north * 10000 / cm_per_unit_e4);
+            int64_t lon = _ref_longitude +
+                          (east << 15) / _ref_cos * 10000 / cm_per_unit_e4;
+            if (lon > half_circle)
+                lon -= 2 * half_circle;
+            else if (lon < -half_circle)
+                lon += 2 * half_circle;
+            pos.longitude = static_cast<int32_t>(lon);
+        }
+    };
+} // namespace peripheral
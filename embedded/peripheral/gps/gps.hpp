@@ -11,9 +11,14 @@
 
 #include "mbed.h"
 
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <utility>
 
 #include "../command_receiver_serial.hpp"
 #include "../command_sender_serial.hpp"
@@ -21,8 +26,13 @@
 #include "../feedback_message_queue.hpp"
 #include "../global_peripheral.hpp"
 #include "../peripheral_std_framework.hpp"
+#include "fix_filter.hpp"
+#include "gps_aiding.hpp"
+#include "gps_config.hpp"
 #include "gps_message.hpp"
 #include "nmea_parser.hpp"
+#include "ubx_codec.hpp"
+#include <utils/utc_clock.hpp>
 
 namespace peripheral
 {
@@ -32,25 +42,110 @@ namespace peripheral
         using _fmq_t = feedback_message_queue;
         using _fmq_e_t = feedback_message_enum_t;
 
+    public:
+        /**
+         * @brief 等待 UBX 配置应答的超时时间。模块在 1 s 内应答。
+         */
+        static constexpr auto ack_timeout = std::chrono::seconds(1);
+        /**
+         * @brief 发送 UBX 配置的次数。刚上电时模块可能丢弃第一条消息。
+         */
+        static constexpr int ubx_retry_count = 2;
+        /**
+         * @brief 等待模块发出星历与历书的超时时间。
+         * 9600 波特率下全部 32 颗卫星的星历与历书约需 5 s。
+         */
+        static constexpr auto aiding_timeout = std::chrono::seconds(6);
+
     protected:
-        mbed::BufferedSerial serial_gps{PIN_GPS_TX, PIN_GPS_RX};
+        /**
+         * @brief 模块的电源。低电平时供电。
+         */
+        mbed::DigitalOut gps_en{PIN_GPS_EN, 0};
+        mbed::BufferedSerial serial_gps{PIN_GPS_TX, PIN_GPS_RX,
+                                        gps_default_baud_rate};
         command_sender_serial sender{serial_gps};
         command_receiver_serial receiver{serial_gps};
         _fmq_t& _external_fmq;
 
     private:
-        nmea_parser parser{receiver};
+        /**
+         * @brief 位置信息更新时通知外部队列的方式。
+         */
+        enum class notify_mode_t
+        {
+            /**
+             * @brief 不通知。
+             */
+            none,
+            /**
+             * @brief 通知一次后取消订阅。
+             */
+            once,
+            /**
+             * @brief 每次定位都通知，直到取消订阅。
+             */
+            continuous,
+        };
+        rtos::Mutex _notify_mutex;
+        notify_mode_t _notify_mode{notify_mode_t::none};
+
+    private:
+        /**
+         * @brief 等待中的 UBX 配置应答。由 _ack_mutex 保护。
+         */
+        rtos::Mutex _ack_mutex;
+        rtos::Semaphore _ack_sem{0, 1};
+        bool _is_ack_pending{};
+        uint8_t _ack_cls{};
+        uint8_t _ack_id{};
+        bool _is_ack{};
+
+    private:
+        /**
+         * @brief 辅助数据。由外部持有，GPS 重新创建后仍然保留。没有时为空。
+         */
+        gps_aiding* _aiding;
+        /**
+         * @brief 每收到一条星历或历书释放一次。
+         */
+        rtos::Semaphore _aiding_sem{0, 2 * gps_aiding::n_satellites};
+        /**
+         * @brief 定位的过滤器。只在读串口的线程中使用，或在其暂停时使用。
+         */
+        fix_filter _filter;
 
     private:
-        bool should_exit{};
+        // 回调函数会访问以上成员，因此 parser 需在其后构造、在其前析构。
+        nmea_parser parser{receiver};
 
     public:
-        gps(_fmq_t& fmq) : _external_fmq(fmq)
+        gps(_fmq_t& fmq) : gps(fmq, nullptr)
         {
         }
+        /**
+         * @param aiding 辅助数据。上电时注入，关闭前由 poll_aiding 更新。
+         */
+        gps(_fmq_t& fmq, gps_aiding& aiding) : gps(fmq, &aiding)
+        {
+        }
+
+    private:
+        gps(_fmq_t& fmq, gps_aiding* aiding)
+            : _external_fmq(fmq), _aiding(aiding)
+        {
+            parser.set_epoch_callback(
+                [this](const nmea_parser::position_t& pos) { on_epoch(pos); });
+            parser.set_ubx_callback(
+                [this](const ubx_frame& frame) { on_ubx(frame); });
+        }
+
+    public:
         ~gps()
         {
-            should_exit = true;
+            // 防止析构过程中收到回调。
+            parser.set_epoch_callback(nullptr);
+            parser.set_ubx_callback(nullptr);
             descendant_exit();
         }
 
@@ -68,7 +163,22 @@ namespace peripheral
             }
             case gps_message_enum_t::request_notify:
             {
-                on_request_notify();
+                on_subscribe_notify(notify_mode_t::once);
+                break;
+            }
+            case gps_message_enum_t::subscribe_notify:
+            {
+                on_subscribe_notify(notify_mode_t::continuous);
+                break;
+            }
+            case gps_message_enum_t::unsubscribe_notify:
+            {
+                on_subscribe_notify(notify_mode_t::none);
+                break;
+            }
+            case gps_message_enum_t::set_ubx_only:
+            {
+                on_set_ubx_only(*std::static_pointer_cast<bool>(data));
                 break;
             }
             default:
@@ -79,13 +189,48 @@ namespace peripheral
             descendant_callback_end();
         }
         /**
-         * @brief 初始化。
+         * @brief 初始化。按 gps_config.hpp 配置模块，并检查每条配置的应答。
+         * 配置失败时模块仍按出厂设置输出 NMEA，可以继续使用。
          */
         void on_init(_fmq_t& fmq)
         {
-            // TODO: 补充 GPS 初始化的流程。
+            using namespace std::literals;
             bool is_success = true;
 
+            // 断电或备份模式后，模块恢复为上电时的波特率。
+            if (gps_baud_rate != gps_default_baud_rate)
+                serial_gps.set_baud(gps_default_baud_rate);
+            // 模块可能处于备份模式，收到任意串口数据后唤醒。
+            // 唤醒期间的数据被丢弃，之后的配置会重发。
+            sender.send_command("\xFF\xFF\xFF\xFF");
+            rtos::ThisThread::sleep_for(100ms);
+
+            // 切换波特率。模块在切换前后都可能发出应答，因此不等待应答，
+            // 由之后的配置检查新的波特率是否可用。
+            if (gps_baud_rate != gps_default_baud_rate)
+            {
+                send_port(false);
+                rtos::ThisThread::sleep_for(100ms);
+                serial_gps.set_baud(gps_baud_rate);
+            }
+            inject_aiding();
+
+            is_success = is_success &&
+                         set_measurement_period(gps_measurement_period);
+            const std::pair<uint8_t, uint8_t> nmea_rates[] = {
+                {ubx_codec::id_nmea_rmc, gps_rate_rmc},
+                {ubx_codec::id_nmea_gga, gps_rate_gga},
+                {ubx_codec::id_nmea_gsa, gps_rate_gsa},
+                {ubx_codec::id_nmea_gsv, gps_rate_gsv},
+                {ubx_codec::id_nmea_vtg, gps_rate_vtg},
+                {ubx_codec::id_nmea_gll, gps_rate_gll},
+            };
+            for (const auto& [id, rate] : nmea_rates)
+                is_success = is_success &&
+                             set_message_rate(ubx_codec::class_nmea, id, rate);
+            is_success = is_success && set_ubx_output(gps_ubx_only);
+            is_success = is_success && set_power_save(gps_power_save);
+
             // 参见 feedback_message_enum_t::gps_init。
             fmq.post_message(_fmq_e_t::gps_init,
                              std::make_shared<bool>(is_success));
@@ -95,41 +240,268 @@ namespace peripheral
             on_init(_external_fmq);
         }
         /**
-         * @brief 请求在位置信息更新时通知外部队列。
+         * @brief 修改通知的订阅状态。
+         */
+        void on_subscribe_notify(notify_mode_t mode)
+        {
+            rtos::ScopedMutexLock lock{_notify_mutex};
+            _notify_mode = mode;
+        }
+
+        /**
+         * @brief 编码并发送一条 UBX 消息。
          *
-         * @note 该消息会阻塞队列。
+         * @return bool 是否发送。数据过长时为 false。
+         */
+        bool send_ubx(uint8_t cls, uint8_t id, const uint8_t* payload,
+                      size_t length)
+        {
+            std::array<uint8_t, ubx_codec::overhead + gps_aiding::eph_length>
+                buffer;
+            size_t size = ubx_codec::encode(cls, id, payload, length,
+                                            buffer.data(), buffer.size());
+            if (!size)
+                return false;
+            sender.send_command(std::string_view(
+                reinterpret_cast<const char*>(buffer.data()), size));
+            return true;
+        }
+        /**
+         * @brief 发送一条 UBX 配置消息，并等待模块应答。超时则重发。
          *
-         * @todo 尽可能避免该消息阻塞队列。
+         * @return bool 是否收到 ACK-ACK。收到 NAK 或超时为 false。
          */
-        void on_request_notify(_fmq_t& fmq)
+        bool send_ubx_wait_ack(uint8_t cls, uint8_t id, const uint8_t* payload,
+                               size_t length)
         {
-            auto previous = parser.get_last_valid_position();
-            while (true)
+            for (int i = 0; i < ubx_retry_count; i++)
             {
-                using namespace std::literals;
-
-                // 检查是否应该退出，避免阻塞析构函数。
-                if (should_exit)
-                    break;
-
-                // 等待内部刷新。
-                rtos::ThisThread::sleep_for(1s);
-                auto current = parser.get_last_valid_position();
-                // 判断这两个对象不同用一个较弱的条件即可。
-                if (current.is_valid && (current.second != previous.second ||
-                                         current.minute != previous.minute))
                 {
-                    // 参见 feedback_message_enum_t::gps_notify。
-                    fmq.post_message(
-                        _fmq_e_t::gps_notify,
-                        std::make_shared<nmea_parser::position_t>(current));
-                    break;
+                    rtos::ScopedMutexLock lock{_ack_mutex};
+                    _is_ack_pending = true;
+                    _ack_cls = cls;
+                    _ack_id = id;
+                    _ack_sem.try_acquire(); // 丢弃过期的应答。
                 }
+                if (!send_ubx(cls, id, payload, length))
+                    return false;
+                if (_ack_sem.try_acquire_for(ack_timeout))
+                {
+                    rtos::ScopedMutexLock lock{_ack_mutex};
+                    return _is_ack;
+                }
+            }
+            rtos::ScopedMutexLock lock{_ack_mutex};
+            _is_ack_pending = false;
+            return false;
+        }
+        /**
+         * @brief 注入辅助数据：大致的位置与时间，以及保存的星历与历书。
+         * 模块不应答 AID 类消息。
+         */
+        void inject_aiding()
+        {
+            if (!_aiding)
+                return;
+            std::array<uint8_t, gps_aiding::ini_length> payload;
+            std::optional<int64_t> epoch_ms;
+            if (utils::utc.is_valid())
+                epoch_ms = utils::utc.now_ms();
+            if (_aiding->make_ini(
+                    payload, epoch_ms, gps_aiding_position_accuracy,
+                    std::chrono::milliseconds(gps_aiding_time_accuracy)
+                        .count()))
+                send_ubx(ubx_codec::class_aid, ubx_codec::id_aid_ini,
+                         payload.data(), payload.size());
+            _aiding->for_each_record(
+                [this](uint8_t id, const uint8_t* data, size_t length) {
+                    send_ubx(ubx_codec::class_aid, id, data, length);
+                });
+        }
+        /**
+         * @brief 设置一类消息的输出频率。使用 CFG-MSG，作用于当前端口。
+         *
+         * @param cls 消息类别。
+         * @param id 消息编号。
+         * @param rate 每几个定位周期输出一次。为 0 时不输出。
+         */
+        bool set_message_rate(uint8_t cls, uint8_t id, uint8_t rate)
+        {
+            const uint8_t payload[] = {cls, id, rate};
+            return send_ubx_wait_ack(ubx_codec::class_cfg,
+                                     ubx_codec::id_cfg_msg, payload,
+                                     sizeof(payload));
+        }
+        /**
+         * @brief 设置定位的周期。使用 CFG-RATE，每个周期都解算一次。
+         */
+        bool set_measurement_period(std::chrono::milliseconds period)
+        {
+            uint8_t payload[6]{};
+            ubx_codec::write_u<2>(payload, period.count());
+            ubx_codec::write_u<2>(payload + 2, 1); // 每个周期解算一次。
+            ubx_codec::write_u<2>(payload + 4, 1); // 与 GPS 时间对齐。
+            return send_ubx_wait_ack(ubx_codec::class_cfg,
+                                     ubx_codec::id_cfg_rate, payload,
+                                     sizeof(payload));
+        }
+        /**
+         * @brief 生成 UART1 的 CFG-PRT 配置。波特率为 gps_baud_rate。
+         *
+         * @param is_ubx_only 为真时只输出 UBX，否则同时输出 UBX 与 NMEA。
+         */
+        static std::array<uint8_t, 20> make_port_payload(bool is_ubx_only)
+        {
+            std::array<uint8_t, 20> payload{};
+            payload[0] = 1; // UART1。
+            // 8 位数据位，无校验，1 位停止位。
+            ubx_codec::write_u<4>(payload.data() + 4, 0x000008D0);
+            ubx_codec::write_u<4>(payload.data() + 8, gps_baud_rate);
+            // 输入总是接受 UBX 与 NMEA。0x01 为 UBX，0x02 为 NMEA。
+            ubx_codec::write_u<2>(payload.data() + 12, 0x0003);
+            ubx_codec::write_u<2>(payload.data() + 14,
+                                  is_ubx_only ? 0x0001 : 0x0003);
+            return payload;
+        }
+        /**
+         * @brief 发送 UART1 的端口配置，不等待应答。用于切换波特率。
+         */
+        bool send_port(bool is_ubx_only)
+        {
+            auto payload = make_port_payload(is_ubx_only);
+            return send_ubx(ubx_codec::class_cfg, ubx_codec::id_cfg_prt,
+                            payload.data(), payload.size());
+        }
+        /**
+         * @brief 设置 UART1 输出的协议。使用 CFG-PRT，波特率不变。
+         */
+        bool set_output_protocol(bool is_ubx_only)
+        {
+            auto payload = make_port_payload(is_ubx_only);
+            return send_ubx_wait_ack(ubx_codec::class_cfg,
+                                     ubx_codec::id_cfg_prt, payload.data(),
+                                     payload.size());
+        }
+        /**
+         * @brief 设置省电模式。使用 CFG-PM2 与 CFG-RXM。
+         * 省电模式下按定位周期循环跟踪，定位之间关闭射频。
+         *
+         * @param is_power_save 为真时使用省电模式，否则使用连续模式。
+         */
+        bool set_power_save(bool is_power_save)
+        {
+            if (is_power_save)
+            {
+                uint8_t payload[44]{};
+                payload[0] = 1; // 版本。
+                // 在 RTC 与星历需要更新时短暂唤醒，保持热启动的条件。
+                ubx_codec::write_u<4>(payload + 4, 0x00001800);
+                ubx_codec::write_u<4>(payload + 8,
+                                      gps_measurement_period.count());
+                ubx_codec::write_u<4>(
+                    payload + 12,
+                    std::chrono::milliseconds(gps_search_period).count());
+                if (!send_ubx_wait_ack(ubx_codec::class_cfg,
+                                       ubx_codec::id_cfg_pm2, payload,
+                                       sizeof(payload)))
+                    return false;
+            }
+            // 第一个字节保留，固定为 8。模式 1 为省电模式，0 为连续模式。
+            const uint8_t payload[] = {0x08,
+                                       static_cast<uint8_t>(is_power_save)};
+            return send_ubx_wait_ack(ubx_codec::class_cfg,
+                                     ubx_codec::id_cfg_rxm, payload,
+                                     sizeof(payload));
+        }
+        /**
+         * @brief 打开或关闭 UBX 导航消息，并相应地关闭或恢复 NMEA 输出。
+         * 先打开 UBX 导航消息再关闭 NMEA，切换过程中不丢失定位。
+         */
+        bool set_ubx_output(bool is_ubx_only)
+        {
+            constexpr uint8_t nav_ids[] = {
+                ubx_codec::id_nav_posllh,
+                ubx_codec::id_nav_status,
+                ubx_codec::id_nav_sol,
+                ubx_codec::id_nav_timeutc,
+            };
+            bool is_success = true;
+            for (auto id : nav_ids)
+                is_success = set_message_rate(ubx_codec::class_nav, id,
+                                              is_ubx_only ? 1 : 0) &&
+                             is_success;
+            return is_success && set_output_protocol(is_ubx_only);
+        }
+        /**
+         * @brief 切换为只输出 UBX 导航消息，或恢复 NMEA 输出。
+         * UBX 导航消息比对应的 NMEA 语句短得多，解析也更简单。
+         */
+        void on_set_ubx_only(bool is_ubx_only, _fmq_t& fmq)
+        {
+            bool is_success = set_ubx_output(is_ubx_only);
+
+            // 参见 feedback_message_enum_t::gps_set_ubx_only。
+            fmq.post_message(_fmq_e_t::gps_set_ubx_only,
+                             std::make_shared<bool>(is_success));
+        }
+        void on_set_ubx_only(bool is_ubx_only)
+        {
+            on_set_ubx_only(is_ubx_only, _external_fmq);
+        }
+
+        // 以下函数在读串口的线程中运行。
+    private:
+        /**
+         * @brief 收到一条 UBX 消息。是等待中的应答时唤醒等待的线程。
+         */
+        void on_ubx(const ubx_frame& frame)
+        {
+            if (_aiding && _aiding->on_frame(frame))
+            {
+                _aiding_sem.release();
+                return;
             }
+            ubx_ack_t ack{};
+            if (!ubx_ack_t::decode(frame, ack))
+                return;
+            rtos::ScopedMutexLock lock{_ack_mutex};
+            if (!_is_ack_pending || ack.cls != _ack_cls || ack.id != _ack_id)
+                return;
+            _is_ack_pending = false;
+            _is_ack = ack.is_ack;
+            _ack_sem.release();
         }
-        void on_request_notify()
+        /**
+         * @brief 一个定位周期结束。有效定位且已订阅时通知外部队列。
+         * 从最后一条语句到通知只有串口的延迟，不需要轮询。
+         * 定位先经过过滤器，被剔除的定位不通知，通知的是滤波后的坐标。
+         */
+        void on_epoch(const nmea_parser::position_t& raw_pos)
         {
-            on_request_notify(_external_fmq);
+            if (!raw_pos.is_valid)
+                return;
+            auto pos = raw_pos;
+            auto result = _filter.update(pos);
+            if (result == fix_filter::result_t::rejected)
+                return;
+            if (_aiding)
+                _aiding->on_position(pos);
+            {
+                rtos::ScopedMutexLock lock{_notify_mutex};
+                if (_notify_mode == notify_mode_t::none)
+                    return;
+                // 持续订阅时只通知明显的移动，单次请求则立即通知。
+                if (_notify_mode == notify_mode_t::continuous &&
+                    result != fix_filter::result_t::moved)
+                    return;
+                if (_notify_mode == notify_mode_t::once)
+                    _notify_mode = notify_mode_t::none;
+            }
+            // 参见 feedback_message_enum_t::gps_notify。
+            // 主模块来不及处理时只保留最新的位置。
+            _external_fmq.post_message_unique(
+                _fmq_e_t::gps_notify,
+                std::make_shared<nmea_parser::position_t>(pos));
         }
 
         // 以下函数是主模块的接口，均在主线程中运行。
@@ -142,13 +514,122 @@ namespace peripheral
             post_message(static_cast<int>(gps_message_enum_t::init), nullptr);
         }
         /**
-         * @brief 请求在位置信息更新时通知外部队列。
+         * @brief 暂停 GPS。读串口的线程暂停，串口不再阻止 MCU 深度睡眠。
+         * 所有对象保持不变，由 resume 恢复。
+         *
+         * @param is_backup 为真时令模块进入备份模式并保持供电。
+         * 模块只保留实时时钟与星历，电流降到几十微安，恢复后热启动。
+         * 否则切断电源。
+         *
+         * @note 在调用线程中运行，返回时指令已发出。模块不应答备份指令。
+         */
+        void suspend(bool is_backup)
+        {
+            // 等待正在处理的消息，防止与配置交错发送。
+            descendant_callback_begin();
+            if (is_backup)
+            {
+                uint8_t payload[8]{};
+                // 持续时间为 0，即一直保持备份模式，直到被唤醒。
+                ubx_codec::write_u<4>(payload + 4, 0x00000002);
+                send_ubx(ubx_codec::class_rxm, ubx_codec::id_rxm_pmreq,
+                         payload, sizeof(payload));
+                serial_gps.sync();
+            }
+            else
+                power_off();
+            parser.pause();
+            // 输入与输出都关闭后，串口释放深度睡眠锁。
+            serial_gps.enable_input(false);
+            serial_gps.enable_output(false);
+            descendant_callback_end();
+        }
+        /**
+         * @brief 切断模块的电源。用于备份模式持续过久、星历已经过期时。
+         */
+        void power_off()
+        {
+            gps_en = 1;
+        }
+        /**
+         * @brief 恢复 GPS。打开电源与串口，恢复读串口的线程，再重新初始化。
+         * 结果由 feedback_message_enum_t::gps_init 反馈。
+         */
+        void resume()
+        {
+            serial_gps.enable_output(true);
+            serial_gps.enable_input(true);
+            gps_en = 0;
+            // 设备可能已经移动，第一次定位直接报告。
+            _filter.reset();
+            parser.resume();
+            init();
+        }
+        /**
+         * @brief 从模块读出星历，历书较旧时也读出，保存到辅助数据中。
+         * 应在关闭 GPS 前调用，下次上电时注入。
+         *
+         * @note 在调用线程中运行，至多阻塞 aiding_timeout。
+         */
+        void poll_aiding()
+        {
+            if (!_aiding)
+                return;
+            // 等待正在处理的消息，防止与配置交错发送。
+            descendant_callback_begin();
+            while (_aiding_sem.try_acquire())
+                ; // 丢弃之前的计数。
+            size_t n_expected = gps_aiding::n_satellites;
+            send_ubx(ubx_codec::class_aid, ubx_codec::id_aid_eph, nullptr, 0);
+            if (_aiding->needs_almanac())
+            {
+                send_ubx(ubx_codec::class_aid, ubx_codec::id_aid_alm, nullptr,
+                         0);
+                n_expected += gps_aiding::n_satellites;
+            }
+            // 模块对每颗卫星各发出一条消息。
+            auto deadline = Kernel::Clock::now() + aiding_timeout;
+            for (size_t i = 0; i < n_expected; i++)
+                if (!_aiding_sem.try_acquire_until(deadline))
+                    break;
+            descendant_callback_end();
+        }
+        /**
+         * @brief 请求在下一次有效定位时通知外部队列。通知一次后自动取消。
          */
         void request_notify()
         {
             post_message_unique(
                 static_cast<int>(gps_message_enum_t::request_notify), nullptr);
         }
+        /**
+         * @brief 订阅位置信息。之后每次有效定位都通知外部队列。
+         */
+        void subscribe_notify()
+        {
+            post_message(static_cast<int>(gps_message_enum_t::subscribe_notify),
+                         nullptr);
+        }
+        /**
+         * @brief 取消订阅位置信息。已在外部队列中的通知不受影响。
+         */
+        void unsubscribe_notify()
+        {
+            post_message(
+                static_cast<int>(gps_message_enum_t::unsubscribe_notify),
+                nullptr);
+        }
+        /**
+         * @brief 切换为只输出 UBX 导航消息，或恢复 NMEA 输出。
+         * 结果由 feedback_message_enum_t::gps_set_ubx_only 反馈。
+         *
+         * @param is_ubx_only 为真时关闭 NMEA 输出，只输出 UBX 导航消息。
+         */
+        void set_ubx_only(bool is_ubx_only)
+        {
+            post_message(static_cast<int>(gps_message_enum_t::set_ubx_only),
+                         std::make_shared<bool>(is_ubx_only));
+        }
 
         /**
          * @brief 获取当前的位置信息。
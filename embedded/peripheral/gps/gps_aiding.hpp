@@ -0,0 +1,281 @@
+/**
+ * @file gps_aiding.hpp
+ * @author UnnamedOrange
+ * @brief GPS 的辅助数据。冷启动时注入，缩短首次定位的时间。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include "kvstore_global_api.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <utils/civil_time.hpp>
+
+#include "nmea_epoch.hpp"
+#include "ubx_codec.hpp"
+
+namespace peripheral
+{
+    /**
+     * @brief GPS 的辅助数据。
+     *
+     * 包括最近一次有效定位的位置，以及从模块读出的星历与历书。
+     * 模块上电后注入 AID-INI 给出大致的位置与时间，再按原样发回星历与历书，
+     * 模块不需要先从卫星下载这些数据。
+     * 位置保存在 KVStore 中，重启后仍然可用。星历与历书较大且变化频繁，
+     * 只保存在内存中，在 GPS 断电期间有效。
+     *
+     * @note 这个类不涉及串口，只维护状态。是线程安全的。
+     */
+    class gps_aiding
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        static constexpr size_t n_satellites = 32;
+        /**
+         * @brief AID-EPH 与 AID-ALM 的长度。没有数据时只有卫星编号等 8 字节。
+         */
+        static constexpr size_t eph_length = 104;
+        static constexpr size_t alm_length = 40;
+        static constexpr size_t ini_length = 48;
+        /**
+         * @brief 星历的有效期。超过后不再注入。
+         */
+        static constexpr auto eph_lifetime = std::chrono::hours(4);
+        /**
+         * @brief 历书的刷新间隔。历书在几周内都可用，不需要经常读出。
+         */
+        static constexpr auto alm_refresh_interval = std::chrono::hours(24);
+
+    private:
+        /**
+         * @brief 一颗卫星的星历或历书，是对应 UBX 消息的数据部分。
+         * 长度为 0 时表示没有数据。
+         */
+        template <size_t max_length>
+        struct record_t
+        {
+            std::array<uint8_t, max_length> data;
+            size_t length;
+        };
+
+        mutable rtos::Mutex _mutex;
+        const char* _kv_key;
+        /**
+         * @brief 最近一次有效定位。没有时 is_valid 为假。
+         */
+        nmea_position_t _last_position{};
+        /**
+         * @brief 最近一次有效定位是否还没有保存到 KVStore。
+         */
+        bool _is_dirty{};
+        std::array<record_t<eph_length>, n_satellites> _eph{};
+        std::array<record_t<alm_length>, n_satellites> _alm{};
+        std::optional<clock::time_point> _eph_time;
+        std::optional<clock::time_point> _alm_time;
+
+    public:
+        /**
+         * @param kv_key 在 KVStore 中保存的键名。例如 /kv/gps。
+         */
+        gps_aiding(const char* kv_key) : _kv_key(kv_key)
+        {
+        }
+
+    public:
+        /**
+         * @brief 记录一次定位。无效的定位被忽略。
+         */
+        void on_position(const nmea_position_t& pos)
+        {
+            if (!pos.is_valid)
+                return;
+            rtos::ScopedMutexLock lock{_mutex};
+            _last_position = pos;
+            _is_dirty = true;
+        }
+        /**
+         * @brief 记录模块发出的 AID-EPH 或 AID-ALM。
+         *
+         * @return bool 是否是 AID-EPH 或 AID-ALM。
+         */
+        bool on_frame(const ubx_frame& frame)
+        {
+            if (frame.cls != ubx_codec::class_aid)
+                return false;
+            if (frame.id == ubx_codec::id_aid_eph)
+                return store(frame, _eph, _eph_time);
+            if (frame.id == ubx_codec::id_aid_alm)
+                return store(frame, _alm, _alm_time);
+            return false;
+        }
+        /**
+         * @brief 历书是否需要重新读出。
+         */
+        bool needs_almanac() const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return !_alm_time ||
+                   clock::now() - *_alm_time >= alm_refresh_interval;
+        }
+
+        /**
+         * @brief 生成 AID-INI 的数据部分。
+         * 位置使用经纬度，时间使用 UTC 日期与时刻。
+         *
+         * @param payload 输出的数据。
+         * @param epoch_ms 当前的 UNIX 时间戳，单位为毫秒。未知时为空。
+         * @param position_accuracy 位置的误差，单位为 cm。
+         * @param time_accuracy 时间的误差，单位为 ms。
+         * @return bool 是否有可注入的位置或时间。
+         */
+        bool make_ini(std::array<uint8_t, ini_length>& payload,
+                      std::optional<int64_t> epoch_ms,
+                      uint32_t position_accuracy, uint32_t time_accuracy) const
+        {
+            constexpr uint32_t flag_position = 0x0001;
+            constexpr uint32_t flag_time = 0x0002;
+            constexpr uint32_t flag_lla = 0x0020;
+            constexpr uint32_t flag_alt_invalid = 0x0040;
+            constexpr uint32_t flag_utc = 0x0400;
+
+            payload = {};
+            uint32_t flags = 0;
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                const auto& pos = _last_position;
+                if (pos.is_valid)
+                {
+                    ubx_codec::write_u<4>(payload.data(), pos.latitude);
+                    ubx_codec::write_u<4>(payload.data() + 4, pos.longitude);
+                    flags |= flag_position | flag_lla;
+                    // 海拔的单位为 cm。
+                    if (pos.altitude != INT32_MIN)
+                        ubx_codec::write_u<4>(payload.data() + 8,
+                                              pos.altitude * 10);
+                    else
+                        flags |= flag_alt_invalid;
+                    ubx_codec::write_u<4>(payload.data() + 12,
+                                          position_accuracy);
+                }
+            }
+            if (epoch_ms && *epoch_ms >= 0)
+            {
+                auto t = utils::civil_time::from_epoch(*epoch_ms / 1000);
+                // 日期为 (年 - 2000) * 100 + 月，时刻为日时分秒各占两位。
+                ubx_codec::write_u<2>(payload.data() + 18,
+                                      (t.year - 2000) * 100 + t.month);
+                ubx_codec::write_u<4>(payload.data() + 20,
+                                      t.day * 1000000 + t.hour * 10000 +
+                                          t.minute * 100 + t.second);
+                ubx_codec::write_u<4>(payload.data() + 24,
+                                      *epoch_ms % 1000 * 1000000);
+                ubx_codec::write_u<4>(payload.data() + 28, time_accuracy);
+                flags |= flag_time | flag_utc;
+            }
+            ubx_codec::write_u<4>(payload.data() + 44, flags);
+            return flags;
+        }
+        /**
+         * @brief 依次访问有效的星历与历书。过期的星历被跳过。
+         *
+         * @param callback 形如 void(uint8_t id, const uint8_t* payload,
+         * size_t length)，id 为 AID-EPH 或 AID-ALM 的编号。
+         * 在持有锁时调用，不应再访问该对象。
+         */
+        template <typename callback_t>
+        void for_each_record(callback_t&& callback) const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            if (_eph_time && clock::now() - *_eph_time < eph_lifetime)
+                for (const auto& record : _eph)
+                    if (record.length)
+                        callback(ubx_codec::id_aid_eph, record.data.data(),
+                                 record.length);
+            for (const auto& record : _alm)
+                if (record.length)
+                    callback(ubx_codec::id_aid_alm, record.data.data(),
+                             record.length);
+        }
+
+        /**
+         * @brief 从 KVStore 读取最近一次有效定位。
+         *
+         * @return bool 是否读取成功。
+         */
+        bool load()
+        {
+            nmea_position_t pos;
+            size_t actual_size{};
+            if (kv_get(_kv_key, &pos, sizeof(pos), &actual_size) !=
+                    MBED_SUCCESS ||
+                actual_size != sizeof(pos) || !pos.is_valid)
+                return false;
+            rtos::ScopedMutexLock lock{_mutex};
+            _last_position = pos;
+            _is_dirty = false;
+            return true;
+        }
+        /**
+         * @brief 把最近一次有效定位保存到 KVStore。
+         *
+         * @note 写 Flash 较慢且有寿命限制，只在有新的定位时写入。
+         * 应在关闭 GPS 时调用，而不是每次定位时调用。
+         *
+         * @return bool 是否保存成功。没有新的定位时也为真。
+         */
+        bool save()
+        {
+            nmea_position_t pos;
+            {
+                rtos::ScopedMutexLock lock{_mutex};
+                if (!_is_dirty)
+                    return true;
+                pos = _last_position;
+                _is_dirty = false;
+            }
+            return kv_set(_kv_key, &pos, sizeof(pos), 0) == MBED_SUCCESS;
+        }
+
+    private:
+        /**
+         * @brief 按卫星编号保存一条星历或历书。
+         * 只有 8 字节的消息表示模块没有该卫星的数据，清除已有的记录。
+         */
+        template <size_t max_length>
+        bool store(const ubx_frame& frame,
+                   std::array<record_t<max_length>, n_satellites>& records,
+                   std::optional<clock::time_point>& time)
+        {
+            if (frame.length < 8)
+                return false;
+            uint32_t svid = ubx_codec::read_u<4>(frame.payload);
+            if (svid < 1 || svid > n_satellites)
+                return false;
+            rtos::ScopedMutexLock lock{_mutex};
+            auto& record = records[svid - 1];
+            if (frame.length == max_length)
+            {
+                std::copy(frame.payload, frame.payload + max_length,
+                          record.data.begin());
+                record.length = max_length;
+            }
+            else
+                record.length = 0;
+            time = clock::now();
+            return true;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,89 @@
+/**
+ * @file gps_config.hpp
+ * @author UnnamedOrange
+ * @brief GPS 模块的配置信息。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+/**
+ * @brief GPS 模块上电时串口的波特率。
+ */
+inline constexpr int gps_default_baud_rate = 9600;
+/**
+ * @brief 配置后串口的波特率。与上电时不同时，初始化时切换。
+ */
+inline constexpr int gps_baud_rate = 9600;
+
+/**
+ * @brief 定位的周期。NEO-6M 至少为 200 ms。
+ */
+inline constexpr auto gps_measurement_period = std::chrono::milliseconds(1000);
+
+/**
+ * @brief 是否关闭 NMEA 输出，只输出 UBX 导航消息。
+ */
+inline constexpr bool gps_ubx_only = false;
+
+/**
+ * @brief 是否使用省电模式。模块按 CFG-PM2 的周期跟踪卫星，
+ * 定位之间关闭射频，平均电流约为连续模式的一半，但定位精度略差。
+ */
+inline constexpr bool gps_power_save = false;
+/**
+ * @brief 省电模式下，无法定位时搜索卫星的间隔。
+ */
+inline constexpr auto gps_search_period = std::chrono::seconds(10);
+
+/**
+ * @brief 注入的位置的误差，单位为 cm。
+ * 上次定位后设备可能已经移动，取得较大。误差在数百千米以内都能加快定位。
+ */
+inline constexpr uint32_t gps_aiding_position_accuracy = 10 * 1000 * 100;
+/**
+ * @brief 注入的时间的误差。网络时间一般在 1 s 以内。
+ */
+inline constexpr auto gps_aiding_time_accuracy = std::chrono::seconds(2);
+
+/**
+ * @brief 定位过滤器的参数。见 fix_filter。
+ * - 最大速度，单位 m/s。超过该速度才能到达的定位被剔除。
+ * - 连续剔除的次数达到该值时，认为确实发生了移动，从新位置重新开始。
+ * - 加速度的标准差，单位 m/s²。越大越信任新的定位。
+ * - 测距误差，单位 m。乘以 HDOP 得到定位的标准差。
+ * - 移动超过该距离时报告，单位 m。
+ * - 没有移动时，至少每隔该时间报告一次。
+ * - 定位中断超过该时间后重新开始。
+ */
+inline constexpr int gps_filter_max_speed = 70;
+inline constexpr int gps_filter_max_rejects = 3;
+inline constexpr int gps_filter_acceleration = 2;
+inline constexpr int gps_filter_uere = 5;
+inline constexpr int gps_filter_min_distance = 20;
+inline constexpr auto gps_filter_max_interval = std::chrono::seconds(60);
+inline constexpr auto gps_filter_max_gap = std::chrono::seconds(30);
+
+/**
+ * @brief 各 NMEA 语句每几个定位周期输出一次。为 0 时不输出。
+ * - RMC 给出坐标与时间，必须输出。
+ * - GGA、GSA 给出定位质量。
+ * - GSV 每个周期有 3 条左右，占一半以上的流量，只用于调试，降低频率。
+ * - VTG 的速度、航向与 RMC 重复，GLL 的坐标与 RMC 重复，不输出。
+ */
+inline constexpr uint8_t gps_rate_rmc = 1;
+inline constexpr uint8_t gps_rate_gga = 1;
+inline constexpr uint8_t gps_rate_gsa = 1;
+inline constexpr uint8_t gps_rate_gsv = 10;
+inline constexpr uint8_t gps_rate_vtg = 0;
+inline constexpr uint8_t gps_rate_gll = 0;
+
+#pragma GCC diagnostic pop
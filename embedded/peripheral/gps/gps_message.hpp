@@ -20,9 +20,21 @@ namespace peripheral
          */
         init,
         /**
-         * @brief 请求在位置信息更新时通知外部队列。
+         * @brief 请求在下一次有效定位时通知外部队列。
          */
         request_notify,
+        /**
+         * @brief 订阅位置信息，每次有效定位都通知外部队列。
+         */
+        subscribe_notify,
+        /**
+         * @brief 取消订阅位置信息。
+         */
+        unsubscribe_notify,
+        /**
+         * @brief 切换为只输出 UBX 导航消息，或恢复 NMEA 输出。
+         */
+        set_ubx_only,
 
         _message_end,
         /**
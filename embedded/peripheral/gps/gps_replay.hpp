@@ -0,0 +1,140 @@
+/**
+ * @file gps_replay.hpp
+ * @author UnnamedOrange
+ * @brief 回放录制的 GPS 串口数据。代替串口接入 nmea_parser，
+ * 用于回归测试与解析耗时的测量。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../command_receiver_base.hpp"
+
+namespace peripheral
+{
+    /**
+     * @brief 回放录制的 GPS 串口数据。
+     *
+     * 录制的数据是一组带时刻的数据块，时刻相对于录制开始。
+     * 按原始时刻回放时，数据块到时后才能读到，与真实串口一致。
+     * 尽快回放时，每次读取返回一组连续的数据块（一个定位周期的输出），
+     * 下一次读取返回空，让解析器看到组与组之间串口空闲。
+     *
+     * @note 这个类是线程安全的。
+     */
+    class gps_replay : public command_receiver_base
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 录制的一块数据。
+         */
+        struct chunk_t
+        {
+            // 相对于录制开始的时刻。
+            std::chrono::milliseconds time;
+            std::string_view data;
+        };
+        /**
+         * @brief 尽快回放时，间隔不超过该值的数据块属于同一组。
+         */
+        static constexpr auto max_burst_gap = std::chrono::milliseconds(100);
+
+    private:
+        rtos::Mutex _mutex;
+        const chunk_t* _chunks;
+        size_t _n_chunks;
+        bool _is_realtime;
+        size_t _next{};
+        /**
+         * @brief 尽快回放时，上一次读取是否返回了数据。
+         */
+        bool _was_burst{};
+        /**
+         * @brief 第一次读取的时刻。按原始时刻回放时作为起点。
+         */
+        std::optional<clock::time_point> _start;
+
+    public:
+        /**
+         * @param chunks 录制的数据，按时刻排列。回放期间应保持有效。
+         * @param n_chunks 数据块的个数。
+         * @param is_realtime 是否按原始时刻回放。为假时尽快回放。
+         */
+        gps_replay(const chunk_t* chunks, size_t n_chunks, bool is_realtime)
+            : _chunks(chunks), _n_chunks(n_chunks), _is_realtime(is_realtime)
+        {
+        }
+        template <size_t n_chunks>
+        gps_replay(const chunk_t (&chunks)[n_chunks], bool is_realtime)
+            : gps_replay(chunks, n_chunks, is_realtime)
+        {
+        }
+        gps_replay(const gps_replay&) = delete;
+        gps_replay& operator=(const gps_replay&) = delete;
+
+    public:
+        /**
+         * @brief 是否已读出所有数据。
+         */
+        bool is_finished()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _next >= _n_chunks;
+        }
+
+    protected:
+        std::string receive_command_impl_blocking() override
+        {
+            using namespace std::literals;
+            while (true)
+            {
+                std::string ret = receive_command_impl_nonblocking();
+                if (!ret.empty() || is_finished())
+                    return ret;
+                rtos::ThisThread::sleep_for(10ms);
+            }
+        }
+        std::string receive_command_impl_nonblocking() override
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            std::string ret;
+            if (_is_realtime)
+            {
+                if (!_start)
+                    _start = clock::now();
+                auto elapsed = clock::now() - *_start;
+                while (_next < _n_chunks && _chunks[_next].time <= elapsed)
+                    ret += _chunks[_next++].data;
+                return ret;
+            }
+
+            // 一组数据之后返回一次空，与串口空闲时一致。
+            if (_was_burst || _next >= _n_chunks)
+            {
+                _was_burst = false;
+                return ret;
+            }
+            auto time = _chunks[_next].time;
+            while (_next < _n_chunks &&
+                   _chunks[_next].time - time <= max_burst_gap)
+            {
+                time = _chunks[_next].time;
+                ret += _chunks[_next++].data;
+            }
+            _was_burst = true;
+            return ret;
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,488 @@
+/**
+ * @file nmea_epoch.hpp
+ * @author UnnamedOrange
+ * @brief 把同一定位周期的多条 NMEA 语句或 UBX 消息合并为一条位置信息。
+ * 不依赖 Mbed。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "nmea_tokenizer.hpp"
+#include "ubx_codec.hpp"
+#include <utils/civil_time.hpp>
+
+namespace peripheral
+{
+    /**
+     * @brief 位置信息类型。
+     *
+     * 除了 RMC 给出的时间与坐标，还包含 GGA、GSA、GSV、VTG 给出的
+     * 定位质量，用于判断定位是否足够好。本周期没有收到对应的语句时，
+     * 这些值为 -1。
+     *
+     * 所有字段在解析时一次性转换为定点数，可以直接复制与比较，
+     * 计算距离与差值时不需要再解析字符串。
+     */
+    struct nmea_position_t
+    {
+        /**
+         * @brief 纬度，单位 1e-7 度。北纬为正，南纬为负。
+         */
+        int32_t latitude;
+        /**
+         * @brief 经度，单位 1e-7 度。东经为正，西经为负。
+         */
+        int32_t longitude;
+        /**
+         * @brief 定位时刻的 UTC 时间，UNIX 时间戳，单位 s。
+         */
+        uint32_t utc;
+        /**
+         * @brief 海拔高度，单位 0.1 m。来自 GGA。没有时为 INT32_MIN。
+         */
+        int32_t altitude;
+        /**
+         * @brief 对地速度，单位 0.1 km/h。来自 VTG，没有时来自 RMC。
+         */
+        int16_t speed;
+        /**
+         * @brief 对地航向（真北），单位 0.1°。静止时接收机可能不输出。
+         */
+        int16_t course;
+        /**
+         * @brief 水平精度因子，单位 0.01。来自 GSA，没有时来自 GGA。
+         */
+        int16_t hdop;
+        /**
+         * @brief 位置精度因子，单位 0.01。来自 GSA。
+         */
+        int16_t pdop;
+        /**
+         * @brief 垂直精度因子，单位 0.01。来自 GSA。
+         */
+        int16_t vdop;
+        /**
+         * @brief 定位质量。来自 GGA。
+         * - 0 未定位。
+         * - 1 GPS 定位。
+         * - 2 差分 GPS 定位。
+         * - 6 航位推算。
+         */
+        int8_t fix_quality;
+        /**
+         * @brief 定位模式。来自 GSA。1 未定位，2 二维定位，3 三维定位。
+         */
+        int8_t fix_type;
+        /**
+         * @brief 参与定位的卫星数。来自 GGA。
+         */
+        int8_t n_satellites_used;
+        /**
+         * @brief 可见的卫星数。来自 GSV。
+         */
+        int8_t n_satellites_in_view;
+        /**
+         * @brief 可见卫星中最大的载噪比，单位 dB-Hz。来自 GSV。
+         */
+        int8_t max_snr;
+        /**
+         * @brief 位置信息是否有效。为真时坐标与时间才可用。
+         */
+        bool is_valid;
+    };
+    static_assert(std::is_trivially_copyable_v<nmea_position_t>);
+    static_assert(sizeof(nmea_position_t) <= 32);
+
+    /**
+     * @brief 把同一定位周期的多条 NMEA 语句合并为一条位置信息。
+     *
+     * 接收机每个周期连续输出一组语句，其中 RMC 与 GGA 带有时间，
+     * GSA、GSV、VTG 不带时间，属于当前周期。收到时间不同的 RMC 或 GGA，
+     * 或者一组语句之后串口空闲时，认为上一个周期结束。
+     *
+     * 关闭 NMEA 输出后，接收机每个周期输出一组 UBX 导航消息，
+     * 均带有 GPS 周内时间 iTOW，iTOW 不同时认为上一个周期结束。
+     *
+     * @note 不分配内存。不是线程安全的。
+     */
+    class nmea_epoch
+    {
+    private:
+        nmea_position_t _current{};
+        nmea_position_t _completed{};
+        /**
+         * @brief 当前周期的时间，hhmmss.ss 乘以 100。还没有时为 -1。
+         */
+        int32_t _time{-1};
+        /**
+         * @brief 当前周期是否收到过语句。
+         */
+        bool _is_pending{};
+        /**
+         * @brief 当前周期的速度是否来自 VTG。VTG 的单位是 km/h，更精确。
+         */
+        bool _has_vtg_speed{};
+        /**
+         * @brief 当前周期的 HDOP 是否来自 GSA。
+         */
+        bool _has_gsa_dop{};
+        /**
+         * @brief 当前周期的 iTOW，单位 ms。
+         */
+        uint32_t _itow{};
+        /**
+         * @brief 当前周期是否收到过 UBX 导航消息。
+         */
+        bool _is_ubx{};
+        /**
+         * @brief 当前周期的 UBX 消息是否给出了坐标、时间与有效定位。
+         */
+        bool _has_ubx_position{};
+        bool _has_ubx_time{};
+        bool _is_ubx_fix_ok{};
+
+    public:
+        nmea_epoch()
+        {
+            reset();
+        }
+
+    private:
+        void reset()
+        {
+            _current = nmea_position_t{};
+            _current.speed = -1;
+            _current.course = -1;
+            _current.fix_quality = -1;
+            _current.fix_type = -1;
+            _current.n_satellites_used = -1;
+            _current.n_satellites_in_view = -1;
+            _current.max_snr = -1;
+            _current.hdop = -1;
+            _current.pdop = -1;
+            _current.vdop = -1;
+            _current.altitude = INT32_MIN;
+            _time = -1;
+            _is_pending = false;
+            _has_vtg_speed = false;
+            _has_gsa_dop = false;
+            _is_ubx = false;
+            _has_ubx_position = false;
+            _has_ubx_time = false;
+            _is_ubx_fix_ok = false;
+        }
+        /**
+         * @brief 收到带时间的语句。时间与当前周期不同时先结束当前周期。
+         *
+         * @return bool 是否结束了上一个周期。
+         */
+        bool begin(std::string_view time_field)
+        {
+            int32_t time{};
+            if (!nmea_field::parse_fixed(time_field, 2, time))
+                return false;
+            bool is_completed = false;
+            if (_time >= 0 && time != _time)
+                is_completed = flush();
+            _time = time;
+            return is_completed;
+        }
+        /**
+         * @brief 收到 UBX 导航消息。iTOW 与当前周期不同时先结束当前周期。
+         *
+         * @return bool 是否结束了上一个周期。
+         */
+        bool begin_ubx(uint32_t itow)
+        {
+            bool is_completed = false;
+            if (_is_ubx && itow != _itow)
+                is_completed = flush();
+            _is_ubx = true;
+            _itow = itow;
+            return is_completed;
+        }
+        /**
+         * @brief 解析可以为空的字段。为空、格式不对或超出范围时为 -1。
+         */
+        template <typename value_t>
+        static void parse_optional(std::string_view field, int n_decimals,
+                                   value_t& value)
+        {
+            int32_t fixed{};
+            if (nmea_field::parse_fixed(field, n_decimals, fixed) &&
+                fixed >= 0 && fixed <= std::numeric_limits<value_t>::max())
+                value = static_cast<value_t>(fixed);
+            else
+                value = -1;
+        }
+
+        /**
+         * @brief 推荐的定位信息。
+         * $GPRMC,<hhmmss.ss>,<A|V>,<纬度>,<N|S>,<经度>,<E|W>,<速度（节）>,
+         * <航向>,<ddmmyy>,...
+         */
+        void parse_rmc(const nmea_sentence<>& frame)
+        {
+            auto& pos = _current;
+            // "A" 表示有效定位，"V" 表示无效定位。
+            // 坐标、时间的格式不对时也视为无效定位。
+            utils::civil_time::date_time_t t{};
+            auto time = frame[1];
+            auto date = frame[9];
+            pos.is_valid =
+                frame[2] == "A" &&
+                nmea_field::parse_coordinate(frame[3], frame[4],
+                                             pos.latitude) &&
+                nmea_field::parse_coordinate(frame[5], frame[6],
+                                             pos.longitude) &&
+                nmea_field::parse_digits(time, 0, 2, t.hour) &&
+                nmea_field::parse_digits(time, 2, 2, t.minute) &&
+                nmea_field::parse_digits(time, 4, 2, t.second) &&
+                nmea_field::parse_digits(date, 0, 2, t.day) &&
+                nmea_field::parse_digits(date, 2, 2, t.month) &&
+                nmea_field::parse_digits(date, 4, 2, t.year);
+            if (pos.is_valid)
+            {
+                t.year += 2000;
+                pos.utc =
+                    static_cast<uint32_t>(utils::civil_time::to_epoch(t));
+            }
+            if (!_has_vtg_speed)
+            {
+                // 1 节为 1.852 km/h。
+                int32_t knots{};
+                if (nmea_field::parse_fixed(frame[7], 3, knots) && knots >= 0)
+                    pos.speed = static_cast<int16_t>(std::min<int64_t>(
+                        int64_t{knots} * 1852 / 100000, INT16_MAX));
+            }
+            parse_optional(frame[8], 1, pos.course);
+        }
+        /**
+         * @brief 定位数据。
+         * $GPGGA,<hhmmss.ss>,<纬度>,<N|S>,<经度>,<E|W>,<定位质量>,<卫星数>,
+         * <HDOP>,<海拔>,M,...
+         */
+        void parse_gga(const nmea_sentence<>& frame)
+        {
+            auto& pos = _current;
+            parse_optional(frame[6], 0, pos.fix_quality);
+            parse_optional(frame[7], 0, pos.n_satellites_used);
+            if (!_has_gsa_dop)
+                parse_optional(frame[8], 2, pos.hdop);
+            if (!nmea_field::parse_fixed(frame[9], 1, pos.altitude))
+                pos.altitude = INT32_MIN;
+        }
+        /**
+         * @brief 精度因子与参与定位的卫星。
+         * $GPGSA,<A|M>,<定位模式>,<卫星编号> x 12,<PDOP>,<HDOP>,<VDOP>
+         */
+        void parse_gsa(const nmea_sentence<>& frame)
+        {
+            auto& pos = _current;
+            parse_optional(frame[2], 0, pos.fix_type);
+            parse_optional(frame[15], 2, pos.pdop);
+            parse_optional(frame[16], 2, pos.hdop);
+            parse_optional(frame[17], 2, pos.vdop);
+            _has_gsa_dop = pos.hdop >= 0;
+        }
+        /**
+         * @brief 可见的卫星。一个周期内分为多条，每条至多 4 颗卫星。
+         * $GPGSV,<总条数>,<序号>,<可见卫星数>,{<编号>,<仰角>,<方位角>,<载噪比>}
+         */
+        void parse_gsv(const nmea_sentence<>& frame)
+        {
+            auto& pos = _current;
+            int n_in_view{};
+            if (nmea_field::parse_uint(frame[3], n_in_view) &&
+                n_in_view <= INT8_MAX)
+                pos.n_satellites_in_view = static_cast<int8_t>(n_in_view);
+            for (size_t i = 7; i < frame.size(); i += 4)
+            {
+                int snr{};
+                // 没有跟踪到的卫星，载噪比为空。载噪比至多为 99。
+                if (nmea_field::parse_digits(frame[i], 0, 2, snr) &&
+                    frame[i].length() == 2 && snr > pos.max_snr)
+                    pos.max_snr = static_cast<int8_t>(snr);
+            }
+        }
+        /**
+         * @brief 对地速度与航向。
+         * $GPVTG,<航向（真北）>,T,<航向（磁北）>,M,<速度（节）>,N,
+         * <速度（km/h）>,K,...
+         */
+        void parse_vtg(const nmea_sentence<>& frame)
+        {
+            auto& pos = _current;
+            parse_optional(frame[1], 1, pos.course);
+            int16_t speed{};
+            parse_optional(frame[7], 1, speed);
+            if (speed >= 0)
+            {
+                pos.speed = speed;
+                _has_vtg_speed = true;
+            }
+        }
+
+        /**
+         * @brief 由 NAV-STATUS 或 NAV-SOL 的定位类型设置定位质量。
+         * 转换为与 GGA、GSA 相同的取值。
+         */
+        void parse_ubx_fix(uint8_t gps_fix, uint8_t flags)
+        {
+            auto& pos = _current;
+            bool is_fix_ok = flags & 0x01;
+            // 0 未定位，1 航位推算，2 二维，3 三维，
+            // 4 GPS 加航位推算，5 仅时间。
+            bool is_position = 2 <= gps_fix && gps_fix <= 4;
+            _is_ubx_fix_ok = is_fix_ok && is_position;
+            pos.fix_type = gps_fix == 2 ? 2 : is_position ? 3 : 1;
+            if (!is_fix_ok)
+                pos.fix_quality = 0;
+            else if (gps_fix == 1)
+                pos.fix_quality = 6;
+            else
+                pos.fix_quality = flags & 0x02 ? 2 : 1;
+        }
+
+    public:
+        /**
+         * @brief 处理一行。
+         *
+         * @param frame 不包含换行的一行。
+         * @return bool 是否结束了上一个周期。结束时使用 completed 获取结果。
+         */
+        bool feed(std::string_view frame)
+        {
+            nmea_sentence<> sentence{frame};
+            if (!sentence.is_valid()) // 校验失败，不处理。
+                return false;
+
+            // 不区分发送设备，多系统接收机发送的是 $GNRMC 等。
+            auto type = sentence.type();
+            bool is_completed = false;
+            if (type == "RMC") // 推荐的定位信息。
+            {
+                is_completed = begin(sentence[1]);
+                parse_rmc(sentence);
+            }
+            else if (type == "GGA") // 定位数据。
+            {
+                is_completed = begin(sentence[1]);
+                parse_gga(sentence);
+            }
+            else if (type == "GSA") // 精度因子。
+                parse_gsa(sentence);
+            else if (type == "GSV") // 可见的卫星。
+                parse_gsv(sentence);
+            else if (type == "VTG") // 速度与航向。
+                parse_vtg(sentence);
+            else // 未知的地址域，不处理。
+                return false;
+            _is_pending = true;
+            return is_completed;
+        }
+        /**
+         * @brief 处理一条 UBX 消息。只处理 NAV 类中用到的消息。
+         *
+         * @param frame 校验正确的一帧。
+         * @return bool 是否结束了上一个周期。结束时使用 completed 获取结果。
+         */
+        bool feed(const ubx_frame& frame)
+        {
+            if (frame.cls != ubx_codec::class_nav)
+                return false;
+            auto& pos = _current;
+            bool is_completed = false;
+            switch (frame.id)
+            {
+            case ubx_codec::id_nav_posllh: // 坐标。
+            {
+                ubx_nav_posllh_t msg{};
+                if (!ubx_nav_posllh_t::decode(frame, msg))
+                    return false;
+                is_completed = begin_ubx(msg.itow);
+                pos.latitude = msg.lat;
+                pos.longitude = msg.lon;
+                pos.altitude = msg.h_msl / 100;
+                _has_ubx_position = true;
+                break;
+            }
+            case ubx_codec::id_nav_status: // 定位状态。
+            {
+                ubx_nav_status_t msg{};
+                if (!ubx_nav_status_t::decode(frame, msg))
+                    return false;
+                is_completed = begin_ubx(msg.itow);
+                parse_ubx_fix(msg.gps_fix, msg.flags);
+                break;
+            }
+            case ubx_codec::id_nav_sol: // 定位解的质量。
+            {
+                ubx_nav_sol_t msg{};
+                if (!ubx_nav_sol_t::decode(frame, msg))
+                    return false;
+                is_completed = begin_ubx(msg.itow);
+                parse_ubx_fix(msg.gps_fix, msg.flags);
+                pos.n_satellites_used = static_cast<int8_t>(
+                    std::min<int>(msg.num_sv, INT8_MAX));
+                pos.pdop = static_cast<int16_t>(
+                    std::min<int>(msg.p_dop, INT16_MAX));
+                break;
+            }
+            case ubx_codec::id_nav_timeutc: // UTC 时间。
+            {
+                ubx_nav_timeutc_t msg{};
+                if (!ubx_nav_timeutc_t::decode(frame, msg))
+                    return false;
+                is_completed = begin_ubx(msg.itow);
+                if (msg.is_utc_valid())
+                {
+                    pos.utc = static_cast<uint32_t>(
+                        utils::civil_time::to_epoch(
+                            {msg.year, msg.month, msg.day, msg.hour,
+                             msg.minute, msg.second}));
+                    _has_ubx_time = true;
+                }
+                break;
+            }
+            default: // 未使用的消息，不处理。
+                return false;
+            }
+            _is_pending = true;
+            return is_completed;
+        }
+        /**
+         * @brief 结束当前周期。用于一组语句之后串口空闲时。
+         *
+         * @return bool 当前周期是否收到过语句。为 false 时 completed 不变。
+         */
+        bool flush()
+        {
+            if (!_is_pending)
+                return false;
+            // UBX 消息没有 RMC 的有效标志，由各消息共同决定。
+            if (_is_ubx)
+                _current.is_valid =
+                    _is_ubx_fix_ok && _has_ubx_position && _has_ubx_time;
+            _completed = _current;
+            reset();
+            return true;
+        }
+        /**
+         * @brief 最近结束的一个周期的位置信息。
+         */
+        const nmea_position_t& completed() const
+        {
+            return _completed;
+        }
+    };
+} // namespace peripheral
@@ -11,244 +11,324 @@
 
 #include "mbed.h"
 
-#include <algorithm>
-#include <functional>
-#include <numeric>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <string_view>
-#include <vector>
 
-#include "../command_receiver_serial.hpp"
+#include "../command_receiver_base.hpp"
 #include "../peripheral_thread.hpp"
+#include "nmea_epoch.hpp"
+#include "ubx_codec.hpp"
 #include <utils/debug.hpp>
+#include <utils/utc_clock.hpp>
 
 namespace peripheral
 {
     /**
      * @brief 接收 NMEA 数据并解析。内部会创建一个线程不断读串口。
      *
-     * @note 接收到新的位置后不会进行通知。
+     * 串口上也可能有 UBX 二进制消息（配置的应答、导航消息等），
+     * UBX 帧以 0xB5 开头，只会出现在两条 NMEA 语句之间，据此分流。
+     *
+     * @note 每个定位周期结束时调用 set_epoch_callback 设置的回调函数。
+     * 每收到一条 UBX 消息时调用 set_ubx_callback 设置的回调函数。
+     *
+     * @note 接收者一般是串口。也可以是 gps_replay，回放录制的数据。
      */
     class nmea_parser : public peripheral_thread
     {
     private:
-        command_receiver_serial& _receiver;
+        command_receiver_base& _receiver;
 
     private:
         bool _should_exit{};
+        bool _should_pause{};
+        /**
+         * @brief 线程暂停后释放。
+         */
+        rtos::Semaphore _sem_paused{0, 1};
+        /**
+         * @brief 恢复或退出时释放，唤醒暂停的线程。
+         */
+        rtos::Semaphore _sem_resume{0, 1};
 
     public:
-        nmea_parser(command_receiver_serial& receiver) : _receiver(receiver)
+        nmea_parser(command_receiver_base& receiver) : _receiver(receiver)
         {
             peripheral_thread::start();
         }
         ~nmea_parser()
         {
             _should_exit = true;
+            _sem_resume.release();
             peripheral_thread::join();
         }
 
     private:
+        /**
+         * @brief 一行的最大长度。NMEA 规定一条语句至多 82 个字符，
+         * 留出余量给不规范的语句。
+         */
+        static constexpr size_t max_line_length = 128;
+
         /**
          * @brief 不断读取串口信息的线程函数。
          */
         void thread_main() override
         {
-            std::string buf;
+            // 使用定长的缓冲区，解析过程不分配内存。
+            std::array<char, max_line_length> buf;
+            size_t length = 0;
+            bool is_overflow = false; // 超长的行被整行丢弃。
+            // 只计算解析占用的时间，不包括等待串口。
+            mbed::Timer timer;
+            timer.start();
             while (true)
             {
                 using namespace std::literals;
                 if (_should_exit)
                     break;
+                if (_should_pause)
+                {
+                    // 丢弃未完成的语句与定位周期，恢复后重新开始。
+                    length = 0;
+                    is_overflow = false;
+                    _epoch = nmea_epoch{};
+                    _ubx = ubx_decoder<>{};
+                    _sem_paused.release();
+                    _sem_resume.acquire();
+                    continue;
+                }
                 // 非阻塞地读取串口，以保证线程可正常退出。
                 std::string read_str = _receiver.receive_command(10ms);
-                for (char ch : read_str)
+                // 一组语句之后串口空闲，说明当前定位周期的语句已发送完。
+                if (read_str.empty() && !length && !_ubx.is_busy())
                 {
-                    buf.push_back(ch);
-                    if (buf.back() == '\n')
+                    if (_epoch.flush())
+                        on_epoch(_epoch.completed());
+                    continue;
+                }
+                stats_t stats{};
+                auto begin = timer.elapsed_time();
+                stats.n_bytes = read_str.length();
+                auto data = reinterpret_cast<const uint8_t*>(read_str.data());
+                for (size_t i = 0; i < read_str.length(); i++)
+                {
+                    char ch = read_str[i];
+                    if (_ubx.is_busy() ||
+                        (!length && data[i] == ubx_codec::sync_char_1))
+                    {
+                        // 整段交给解码器，直到这一帧结束。
+                        size_t n_consumed{};
+                        if (_ubx.push(data + i, read_str.length() - i,
+                                      n_consumed))
+                        {
+                            stats.n_ubx_frames++;
+                            on_ubx(_ubx.frame());
+                        }
+                        i += n_consumed - 1;
+                    }
+                    else if (ch == '\r' || ch == '\n')
                     {
-                        // 弹出所有的换行。
-                        while (!buf.empty() && buf.back() == '\n')
-                            buf.pop_back();
-                        while (!buf.empty() && buf.back() == '\r')
-                            buf.pop_back();
                         // 如果不是空行，则处理。
-                        if (!buf.empty())
-                            parse_frame(buf);
+                        if (length && !is_overflow)
+                        {
+                            stats.n_sentences++;
+                            parse_frame(std::string_view(buf.data(), length));
+                        }
+                        else if (is_overflow)
+                            stats.n_overflows++;
                         // 处理完成，清空缓冲区。
-                        buf.clear();
+                        length = 0;
+                        is_overflow = false;
                     }
+                    else if (length < buf.size())
+                        buf[length++] = ch;
+                    else
+                        is_overflow = true;
                 }
+                stats.parse_time = std::chrono::duration_cast<
+                    std::chrono::microseconds>(timer.elapsed_time() - begin);
+                add_stats(stats);
             }
         }
 
     private:
         /**
-         * @brief 将 NMEA 帧以逗号为分隔符、星号为结尾符分割，并验证校验值。
-         *
-         * @param frame 不包含换行符的一个 NMEA 帧。
-         * @return std::vector<std::string>
-         * 如果校验成功，则返回各字符串组成的数组。 否则返回一个空数组。
-         */
-        static std::vector<std::string> split_frame_and_verify(
-            std::string_view frame)
-        {
-            std::vector<std::string> ret;
-            // 假设第一个字符是 $。
-            if (frame[0] != '$') // 如果不是 NMEA 帧，则失败。
-                return ret;      // 返回空数组。
-            // 假设最后三个字符是 *XX，校验。
-            if (frame.length() < 3) // 数组长度小于 3 则失败。
-                return ret;         // 返回空数组。
-            if (frame[frame.length() - 3] != '*') // 不是星号结尾，则失败。
-                return ret;                       // 返回空数组。
-            {
-                int desired_check_sum;
-                std::string last_two{frame.substr(frame.length() - 2)};
-                if (1 != sscanf(last_two.c_str(), "%x", &desired_check_sum))
-                    return ret; // 解析失败，返回空数组。
-
-                // 取中间部分。经过前面的检查，长度总是符合要求。
-                std::string_view middle = frame.substr(1, frame.length() - 4);
-                int check_sum = std::accumulate(middle.begin(), middle.end(),
-                                                int{}, std::bit_xor<int>{});
-                if (desired_check_sum != check_sum) // 校验和错误，则失败。
-                    return ret;                     // 返回空数组。
-            }
-
-            // 将 frame 以逗号为分隔符，星号为结尾符切割。
-            std::string buf;
-            for (char ch : frame)
-            {
-                if (ch == ',' || ch == '*')
-                {
-                    ret.push_back(std::move(buf));
-                    buf.clear(); // 假设 move 后的行为是不确定的。
-                    if (ch == '*')
-                        break;
-                }
-                else
-                    buf.push_back(ch);
-            }
-
-            return ret;
-        }
-        /**
-         * @brief 解析 NMEA 帧。
+         * @brief 解析 NMEA 帧。一个定位周期结束时更新位置信息。
          *
          * @param frame 原始帧字符串，不包含结尾的换行符。
          */
         void parse_frame(std::string_view frame)
         {
-            auto parts = split_frame_and_verify(frame);
-            if (parts.empty()) // 为空说明解析失败，不处理。
-                return;
-
-            if (parts[0] == "$GPRMC") // 推荐的定位信息。
-                parse_gprmc(parts);
-            else // 未知的地址域，不处理。
-                return;
+            if (_epoch.feed(frame))
+                on_epoch(_epoch.completed());
         }
 
     public:
         /**
-         * @brief 位置信息类型。
+         * @brief 解析的统计信息。用于测量解析的耗时。
          */
-        struct position_t
+        struct stats_t
         {
-            /**
-             * @brief 位置信息是否有效。为真时其他参数才可用。
-             */
-            bool is_valid;
-            /**
-             * @brief UTC 时间的秒。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int second;
-            /**
-             * @brief UTC 时间的分。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int minute;
-            /**
-             * @brief UTC 时间的时。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int hour;
-            /**
-             * @brief UTC 时间的日。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int day;
-            /**
-             * @brief UTC 时间的月。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int month;
-            /**
-             * @brief UTC 时间的年。
-             *
-             * @note is_valid 为 false 时，时间是也是无效的。
-             */
-            int year;
-            /**
-             * @brief 纬度。度分格式。
-             */
-            std::string latitude;
-            /**
-             * @brief 纬度半球。"N"表示北半球，"S"表示南半球。
-             */
-            std::string latitude_semi;
-            /**
-             * @brief 精度。度分格式。
-             */
-            std::string longitude;
-            /**
-             * @brief 精度半球。"E"表示东经，"W"表示西经。
-             */
-            std::string longitude_semi;
+            // 收到的字节数。
+            uint32_t n_bytes;
+            // 交给 NMEA 解析的语句数，包括校验失败的。
+            uint32_t n_sentences;
+            // 超长而被丢弃的行数。
+            uint32_t n_overflows;
+            // 校验通过的 UBX 消息数。
+            uint32_t n_ubx_frames;
+            // 结束的定位周期数，以及其中有效定位的个数。
+            uint32_t n_epochs;
+            uint32_t n_valid_epochs;
+            // 解析占用的时间，包括回调函数。
+            std::chrono::microseconds parse_time;
         };
 
+        /**
+         * @brief 位置信息类型。
+         */
+        using position_t = nmea_position_t;
+
+        /**
+         * @brief 定位周期结束时的回调函数类型。参数为该周期的位置信息。
+         */
+        using epoch_callback_t = mbed::Callback<void(const position_t&)>;
+        /**
+         * @brief 收到 UBX 消息时的回调函数类型。
+         * 参数在回调函数返回后失效。
+         */
+        using ubx_callback_t = mbed::Callback<void(const ubx_frame&)>;
+
     private:
         rtos::Semaphore _sem{1, 1};
         position_t _pos{};
         position_t _last_valid_pos{};
+        stats_t _stats{};
+        epoch_callback_t _epoch_callback;
+        ubx_callback_t _ubx_callback;
+        /**
+         * @brief 合并同一定位周期的语句。只在读串口的线程中使用。
+         */
+        nmea_epoch _epoch;
+        /**
+         * @brief UBX 消息的解码器。只在读串口的线程中使用。
+         */
+        ubx_decoder<> _ubx;
 
     private:
         /**
-         * @brief 解析推荐的定位信息 $GPRMC。
+         * @brief 一个定位周期结束。
          */
-        void parse_gprmc(const std::vector<std::string>& frame)
+        void on_epoch(const position_t& pos)
         {
             _sem.acquire();
-            _pos.is_valid =
-                frame[2] == "A"; // "A" 表示有效定位，"V" 表示无效定位。
-            _pos.latitude = frame[3];
-            _pos.latitude_semi = frame[4];
-            _pos.longitude = frame[5];
-            _pos.longitude_semi = frame[6];
-
+            _pos = pos;
             if (_pos.is_valid)
-            {
-                // 解析时间。
-                _pos.second = std::stoi(frame[1].substr(4, 2));
-                _pos.minute = std::stoi(frame[1].substr(2, 2));
-                _pos.hour = std::stoi(frame[1].substr(0, 2));
-                _pos.day = std::stoi(frame[9].substr(0, 2));
-                _pos.month = std::stoi(frame[9].substr(2, 2));
-                _pos.year = std::stoi(frame[9].substr(4, 2));
-
                 _last_valid_pos = _pos;
-            }
+            _stats.n_epochs++;
+            _stats.n_valid_epochs += _pos.is_valid;
+            auto callback = _epoch_callback;
+            _sem.release();
+
+            // 有效定位时的时间可以用来校准时钟。
+            if (pos.is_valid)
+                utils::utc.on_sync(pos.utc, utils::utc_clock::source_t::gps);
+
+            // 在锁外调用，回调函数中可以获取位置信息。
+            if (callback)
+                callback(pos);
+        }
+
+        /**
+         * @brief 收到一条 UBX 消息。
+         */
+        void on_ubx(const ubx_frame& frame)
+        {
+            // 导航消息参与定位周期的合并。
+            if (_epoch.feed(frame))
+                on_epoch(_epoch.completed());
+
+            _sem.acquire();
+            auto callback = _ubx_callback;
+            _sem.release();
+            if (callback)
+                callback(frame);
+        }
+
+        /**
+         * @brief 累加一次读取的统计信息。
+         */
+        void add_stats(const stats_t& stats)
+        {
+            _sem.acquire();
+            _stats.n_bytes += stats.n_bytes;
+            _stats.n_sentences += stats.n_sentences;
+            _stats.n_overflows += stats.n_overflows;
+            _stats.n_ubx_frames += stats.n_ubx_frames;
+            _stats.parse_time += stats.parse_time;
             _sem.release();
         }
 
     public:
+        /**
+         * @brief 暂停读串口的线程。返回时线程已经暂停，不再访问串口。
+         * 线程保持存在，由 resume 恢复。
+         *
+         * @note 不应在回调函数中调用。
+         */
+        void pause()
+        {
+            if (_should_pause)
+                return;
+            _should_pause = true;
+            _sem_paused.acquire();
+        }
+        /**
+         * @brief 恢复读串口的线程。
+         */
+        void resume()
+        {
+            if (!_should_pause)
+                return;
+            _should_pause = false;
+            _sem_resume.release();
+        }
+
+        /**
+         * @brief 设置定位周期结束时的回调函数。
+         * 一组语句发送完后立即调用，不需要轮询位置信息。
+         *
+         * @note 回调函数在读串口的线程中运行，应尽快返回。
+         *
+         * @note 该函数是线程安全的。
+         *
+         * @param callback 回调函数。为空时取消回调。
+         */
+        void set_epoch_callback(epoch_callback_t callback)
+        {
+            _sem.acquire();
+            _epoch_callback = callback;
+            _sem.release();
+        }
+        /**
+         * @brief 设置收到 UBX 消息时的回调函数。用于等待配置的应答等。
+         *
+         * @note 回调函数在读串口的线程中运行，应尽快返回。
+         *
+         * @note 该函数是线程安全的。
+         *
+         * @param callback 回调函数。为空时取消回调。
+         */
+        void set_ubx_callback(ubx_callback_t callback)
+        {
+            _sem.acquire();
+            _ubx_callback = callback;
+            _sem.release();
+        }
         /**
          * @brief 获取当前的位置信息。
          *
@@ -275,5 +355,18 @@ namespace peripheral
             _sem.release();
             return ret;
         }
+        /**
+         * @brief 获取解析的统计信息。从构造时开始累计。
+         *
+         * @note 该函数是线程安全的。
+         */
+        stats_t get_stats()
+        {
+            stats_t ret;
+            _sem.acquire();
+            ret = _stats;
+            _sem.release();
+            return ret;
+        }
     };
 } // namespace peripheral
@@ -0,0 +1,253 @@
+/**
+ * @file nmea_tokenizer.hpp
+ * @author UnnamedOrange
+ * @brief NMEA 语句的分词器。不分配内存，不依赖 Mbed。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace peripheral
+{
+    /**
+     * @brief NMEA 字段的解析函数。数字均按位手动解析，不使用 sscanf 与 stoi。
+     */
+    class nmea_field
+    {
+    public:
+        /**
+         * @brief 解析一位十六进制数字。
+         *
+         * @return int 数值。不是十六进制数字时为 -1。
+         */
+        static int hex_digit(char ch)
+        {
+            if ('0' <= ch && ch <= '9')
+                return ch - '0';
+            if ('A' <= ch && ch <= 'F')
+                return ch - 'A' + 10;
+            if ('a' <= ch && ch <= 'f')
+                return ch - 'a' + 10;
+            return -1;
+        }
+        /**
+         * @brief 解析定长的十进制数字。用于时间、日期等定宽的字段。
+         * 例如从 hhmmss.ss 中取出分钟：parse_digits(field, 2, 2, minute)。
+         *
+         * @param field 字段。
+         * @param pos 起始位置。
+         * @param n_digits 数字的位数。
+         * @param value 解析的结果。
+         * @return bool 是否都是数字且没有越界。
+         */
+        static bool parse_digits(std::string_view field, size_t pos,
+                                 size_t n_digits, int& value)
+        {
+            if (pos + n_digits > field.length() || n_digits > 9)
+                return false;
+            int ret = 0;
+            for (size_t i = pos; i < pos + n_digits; i++)
+            {
+                unsigned digit = static_cast<unsigned char>(field[i]) - '0';
+                if (digit > 9)
+                    return false;
+                ret = ret * 10 + static_cast<int>(digit);
+            }
+            value = ret;
+            return true;
+        }
+        /**
+         * @brief 解析不定长的非负整数。例如卫星数。
+         *
+         * @return bool 是否是完整的整数。字段为空时为 false。
+         */
+        static bool parse_uint(std::string_view field, int& value)
+        {
+            return !field.empty() &&
+                   parse_digits(field, 0, field.length(), value);
+        }
+        /**
+         * @brief 把小数解析为定点数。多余的小数位被截断，不足的补 0。
+         * 例如 n_decimals 为 2 时，"-12.3456" 解析为 -1234。
+         *
+         * @param field 字段。可以带有正负号。
+         * @param n_decimals 保留的小数位数。
+         * @param value 解析的结果，为原数乘以 10 的 n_decimals 次方。
+         * @return bool 是否是完整的小数。字段为空时为 false。
+         */
+        static bool parse_fixed(std::string_view field, int n_decimals,
+                                int32_t& value)
+        {
+            bool is_negative = false;
+            if (!field.empty() &&
+                (field.front() == '-' || field.front() == '+'))
+            {
+                is_negative = field.front() == '-';
+                field.remove_prefix(1);
+            }
+            if (field.empty())
+                return false;
+            int64_t ret = 0;
+            int n_fraction = -1; // 小于 0 表示还没有遇到小数点。
+            for (char ch : field)
+            {
+                if (ch == '.' && n_fraction < 0)
+                {
+                    n_fraction = 0;
+                    continue;
+                }
+                unsigned digit = static_cast<unsigned char>(ch) - '0';
+                if (digit > 9)
+                    return false;
+                if (n_fraction >= n_decimals)
+                    continue; // 截断多余的小数位。
+                ret = ret * 10 + digit;
+                if (n_fraction >= 0)
+                    n_fraction++;
+                if (ret > INT32_MAX)
+                    return false;
+            }
+            for (int i = n_fraction < 0 ? 0 : n_fraction; i < n_decimals; i++)
+            {
+                ret *= 10;
+                if (ret > INT32_MAX)
+                    return false;
+            }
+            value = static_cast<int32_t>(is_negative ? -ret : ret);
+            return true;
+        }
+        /**
+         * @brief 把度分格式的坐标解析为以 1e-7 度为单位的定点数。
+         * 例如 "3150.78220" 与 "N" 解析为 318463700。
+         *
+         * @param field 坐标字段。纬度为 ddmm.mmmm，经度为 dddmm.mmmm。
+         * @param hemisphere 半球字段。"S" 与 "W" 为负。
+         * @param value 解析的结果。
+         * @return bool 是否是合法的坐标。
+         */
+        static bool parse_coordinate(std::string_view field,
+                                     std::string_view hemisphere,
+                                     int32_t& value)
+        {
+            // 分的小数部分保留 5 位，1e-5 分约为 1.7e-7 度，不损失精度。
+            // 不接受正负号，由半球决定正负。
+            int32_t fixed{};
+            if (field.empty() || field.front() == '-' ||
+                field.front() == '+' || !parse_fixed(field, 5, fixed))
+                return false;
+            int32_t degree = fixed / 10000000;
+            int32_t minute = fixed % 10000000; // 单位 1e-5 分。
+            if (minute >= 6000000 || degree > 180)
+                return false;
+            // 1e-5 分为 1e-7 度的 100 / 60 倍，四舍五入。
+            int32_t ret = degree * 10000000 + (minute * 5 + 1) / 3;
+            if (hemisphere == "S" || hemisphere == "W")
+                ret = -ret;
+            else if (hemisphere != "N" && hemisphere != "E")
+                return false;
+            value = ret;
+            return true;
+        }
+    };
+
+    /**
+     * @brief 校验并分词后的 NMEA 语句。字段均指向原始输入，不包含 $ 与校验和。
+     *
+     * 语句的格式为 $<地址>,<字段>,...*<校验和>。第 0 个字段是地址，
+     * 例如 GPRMC，前两个字符是发送设备（GP、GN 等），其余是语句类型。
+     *
+     * @note 不分配内存，输入需在使用结果期间有效。
+     *
+     * @tparam max_fields 至多保存的字段数，包含地址。超出的字段被丢弃。
+     * 最长的 GSV 语句有 20 个字段。
+     */
+    template <size_t max_fields = 24>
+    class nmea_sentence
+    {
+    private:
+        std::array<std::string_view, max_fields> _fields;
+        size_t _size{};
+
+    public:
+        /**
+         * @param frame 不包含换行的一行。校验失败时 size() 为 0。
+         */
+        explicit nmea_sentence(std::string_view frame)
+        {
+            // 至少包含 $、地址与 *XX。
+            if (frame.length() < 5 || frame.front() != '$' ||
+                frame[frame.length() - 3] != '*')
+                return;
+            int high = nmea_field::hex_digit(frame[frame.length() - 2]);
+            int low = nmea_field::hex_digit(frame[frame.length() - 1]);
+            if (high < 0 || low < 0)
+                return;
+            std::string_view body = frame.substr(1, frame.length() - 4);
+            // 一次遍历同时计算校验和并分隔字段。
+            unsigned check_sum = 0;
+            size_t size = 0;
+            size_t field_begin = 0;
+            for (size_t i = 0; i < body.length(); i++)
+            {
+                check_sum ^= static_cast<unsigned char>(body[i]);
+                if (body[i] != ',')
+                    continue;
+                if (size < max_fields)
+                    _fields[size++] = body.substr(field_begin, i - field_begin);
+                field_begin = i + 1;
+            }
+            if (size < max_fields)
+                _fields[size++] = body.substr(field_begin);
+            if (check_sum != static_cast<unsigned>(high << 4 | low))
+                return;
+            _size = size;
+        }
+
+    public:
+        /**
+         * @brief 是否校验成功。
+         */
+        bool is_valid() const
+        {
+            return _size != 0;
+        }
+        /**
+         * @brief 字段数，包含地址。
+         */
+        size_t size() const
+        {
+            return _size;
+        }
+        /**
+         * @brief 第 i 个字段。第 0 个是地址。越界时为空。
+         */
+        std::string_view operator[](size_t i) const
+        {
+            return i < _size ? _fields[i] : std::string_view();
+        }
+        /**
+         * @brief 地址。例如 GPRMC。
+         */
+        std::string_view address() const
+        {
+            return (*this)[0];
+        }
+        /**
+         * @brief 语句类型，不包含发送设备。例如 RMC。
+         * 地址不是 5 个字符（例如厂商自定义的语句）时为空。
+         */
+        std::string_view type() const
+        {
+            auto address = this->address();
+            return address.length() == 5 ? address.substr(2)
+                                         : std::string_view();
+        }
+    };
+} // namespace peripheral
@@ -0,0 +1,510 @@
+/**
+ * @file ubx_codec.hpp
+ * @author UnnamedOrange
+ * @brief u-blox UBX 二进制协议的编解码。不分配内存，不依赖 Mbed。
+ *
+ * 参见 doc/modules/ATK-NEO-6M GPS Module/u-blox 6 Receiver Description.pdf
+ * 的 UBX Protocol 一章。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace peripheral
+{
+    /**
+     * @brief 解码后的 UBX 帧。payload 指向解码器的缓冲区。
+     */
+    struct ubx_frame
+    {
+        uint8_t cls;
+        uint8_t id;
+        const uint8_t* payload;
+        size_t length;
+    };
+
+    /**
+     * @brief UBX 帧的编码、校验与字段读取。
+     *
+     * 帧的格式为 0xB5 0x62 <类> <编号> <长度，2 字节小端> <数据>
+     * <CK_A> <CK_B>。
+     * 校验和是从类到数据结束的 8 位 Fletcher 校验和。
+     */
+    class ubx_codec
+    {
+    public:
+        static constexpr uint8_t sync_char_1 = 0xB5;
+        static constexpr uint8_t sync_char_2 = 0x62;
+        /**
+         * @brief 除数据以外的长度：2 字节同步字符、类、编号、2 字节长度、
+         * 2 字节校验和。
+         */
+        static constexpr size_t overhead = 8;
+
+        /**
+         * @brief 消息类。
+         */
+        static constexpr uint8_t class_nav = 0x01;
+        static constexpr uint8_t class_rxm = 0x02;
+        static constexpr uint8_t class_ack = 0x05;
+        static constexpr uint8_t class_cfg = 0x06;
+        static constexpr uint8_t class_aid = 0x0B;
+        static constexpr uint8_t class_nmea = 0xF0;
+
+        /**
+         * @brief 消息编号。
+         */
+        static constexpr uint8_t id_nav_posllh = 0x02;
+        static constexpr uint8_t id_nav_status = 0x03;
+        static constexpr uint8_t id_nav_sol = 0x06;
+        static constexpr uint8_t id_nav_timeutc = 0x21;
+        static constexpr uint8_t id_ack_nak = 0x00;
+        static constexpr uint8_t id_ack_ack = 0x01;
+        static constexpr uint8_t id_cfg_prt = 0x00;
+        static constexpr uint8_t id_cfg_msg = 0x01;
+        static constexpr uint8_t id_cfg_rate = 0x08;
+        static constexpr uint8_t id_cfg_rxm = 0x11;
+        static constexpr uint8_t id_cfg_pm2 = 0x3B;
+        static constexpr uint8_t id_rxm_pmreq = 0x41;
+        static constexpr uint8_t id_aid_ini = 0x01;
+        static constexpr uint8_t id_aid_alm = 0x30;
+        static constexpr uint8_t id_aid_eph = 0x31;
+        static constexpr uint8_t id_nmea_gga = 0x00;
+        static constexpr uint8_t id_nmea_gll = 0x01;
+        static constexpr uint8_t id_nmea_gsa = 0x02;
+        static constexpr uint8_t id_nmea_gsv = 0x03;
+        static constexpr uint8_t id_nmea_rmc = 0x04;
+        static constexpr uint8_t id_nmea_vtg = 0x05;
+
+    public:
+        /**
+         * @brief 在已有的校验和上累加数据。
+         */
+        static void checksum(const uint8_t* data, size_t length, uint8_t& ck_a,
+                             uint8_t& ck_b)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                ck_a += data[i];
+                ck_b += ck_a;
+            }
+        }
+        /**
+         * @brief 编码一帧。
+         *
+         * @param cls 消息类。
+         * @param id 消息编号。
+         * @param payload 数据。长度为 0 时可以为空，用于轮询消息。
+         * @param length 数据的长度。
+         * @param buffer 输出缓冲区。
+         * @param capacity 输出缓冲区的大小。
+         * @return size_t 帧的长度。缓冲区不够时为 0。
+         */
+        static size_t encode(uint8_t cls, uint8_t id, const uint8_t* payload,
+                             size_t length, uint8_t* buffer, size_t capacity)
+        {
+            if (length > UINT16_MAX || capacity < length + overhead)
+                return 0;
+            buffer[0] = sync_char_1;
+            buffer[1] = sync_char_2;
+            buffer[2] = cls;
+            buffer[3] = id;
+            buffer[4] = static_cast<uint8_t>(length);
+            buffer[5] = static_cast<uint8_t>(length >> 8);
+            for (size_t i = 0; i < length; i++)
+                buffer[6 + i] = payload[i];
+            uint8_t ck_a = 0;
+            uint8_t ck_b = 0;
+            checksum(buffer + 2, length + 4, ck_a, ck_b);
+            buffer[6 + length] = ck_a;
+            buffer[7 + length] = ck_b;
+            return length + overhead;
+        }
+
+        /**
+         * @brief 读取小端的无符号整数。
+         *
+         * @tparam n_bytes 字节数。
+         */
+        template <size_t n_bytes>
+        static uint32_t read_u(const uint8_t* data)
+        {
+            uint32_t ret = 0;
+            for (size_t i = 0; i < n_bytes; i++)
+                ret |= static_cast<uint32_t>(data[i]) << (8 * i);
+            return ret;
+        }
+        /**
+         * @brief 读取小端的 4 字节有符号整数。
+         */
+        static int32_t read_i4(const uint8_t* data)
+        {
+            return static_cast<int32_t>(read_u<4>(data));
+        }
+        /**
+         * @brief 以小端写入无符号整数。
+         *
+         * @tparam n_bytes 字节数。
+         */
+        template <size_t n_bytes>
+        static void write_u(uint8_t* data, uint32_t value)
+        {
+            for (size_t i = 0; i < n_bytes; i++)
+                data[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    };
+
+    /**
+     * @brief 流式的 UBX 解码器。逐字节或整段输入。
+     *
+     * @note 不分配内存。不是线程安全的。
+     *
+     * @tparam max_payload 至多接收的数据长度。更长的帧被丢弃。
+     * NAV-SOL 是需要解码的消息中最长的，有 52 字节。
+     */
+    template <size_t max_payload = 128>
+    class ubx_decoder
+    {
+    private:
+        /**
+         * @brief 解码的状态。表示下一个字节是帧的哪一部分。
+         */
+        enum class state_t
+        {
+            sync_1,
+            sync_2,
+            cls,
+            id,
+            length_1,
+            length_2,
+            payload,
+            ck_a,
+            ck_b,
+        };
+
+        state_t _state{state_t::sync_1};
+        std::array<uint8_t, max_payload> _payload;
+        uint8_t _cls{};
+        uint8_t _id{};
+        size_t _length{};
+        size_t _received{};
+        uint8_t _ck_a{};
+        uint8_t _ck_b{};
+
+    private:
+        void accumulate(uint8_t byte)
+        {
+            _ck_a += byte;
+            _ck_b += _ck_a;
+        }
+
+    public:
+        /**
+         * @brief 是否正在接收一帧。为真时后续字节都应交给该解码器。
+         */
+        bool is_busy() const
+        {
+            return _state != state_t::sync_1;
+        }
+        /**
+         * @brief 输入一个字节。
+         *
+         * @return bool 是否收到了完整且校验正确的一帧。
+         * 为真时使用 frame 获取结果，结果在下一次调用 push 前有效。
+         */
+        bool push(uint8_t byte)
+        {
+            switch (_state)
+            {
+            case state_t::sync_1:
+            {
+                if (byte == ubx_codec::sync_char_1)
+                    _state = state_t::sync_2;
+                return false;
+            }
+            case state_t::sync_2:
+            {
+                _state = byte == ubx_codec::sync_char_2 ? state_t::cls
+                                                        : state_t::sync_1;
+                _ck_a = 0;
+                _ck_b = 0;
+                return false;
+            }
+            case state_t::cls:
+            {
+                _cls = byte;
+                accumulate(byte);
+                _state = state_t::id;
+                return false;
+            }
+            case state_t::id:
+            {
+                _id = byte;
+                accumulate(byte);
+                _state = state_t::length_1;
+                return false;
+            }
+            case state_t::length_1:
+            {
+                _length = byte;
+                accumulate(byte);
+                _state = state_t::length_2;
+                return false;
+            }
+            case state_t::length_2:
+            {
+                _length |= static_cast<size_t>(byte) << 8;
+                accumulate(byte);
+                _received = 0;
+                // 超长的帧无法保存，重新寻找同步字符。
+                if (_length > max_payload)
+                    _state = state_t::sync_1;
+                else
+                    _state = _length ? state_t::payload : state_t::ck_a;
+                return false;
+            }
+            case state_t::payload:
+            {
+                _payload[_received++] = byte;
+                accumulate(byte);
+                if (_received == _length)
+                    _state = state_t::ck_a;
+                return false;
+            }
+            case state_t::ck_a:
+            {
+                _state = byte == _ck_a ? state_t::ck_b : state_t::sync_1;
+                return false;
+            }
+            case state_t::ck_b:
+            {
+                _state = state_t::sync_1;
+                return byte == _ck_b;
+            }
+            }
+            return false;
+        }
+        /**
+         * @brief 输入一段字节，直到收到一帧或解码器回到空闲状态。
+         * 数据部分整段复制并累加校验和，比逐字节调用 push 快。
+         *
+         * @param data 输入的字节。
+         * @param length 字节数，不能为 0。
+         * @param n_consumed 输出处理的字节数，至少为 1。
+         * 其余字节不属于当前帧，需要另行处理。
+         * @return bool 是否收到了完整且校验正确的一帧。
+         * 为真时使用 frame 获取结果，结果在下一次调用 push 前有效。
+         */
+        bool push(const uint8_t* data, size_t length, size_t& n_consumed)
+        {
+            size_t i = 0;
+            do
+            {
+                if (_state != state_t::payload)
+                {
+                    if (push(data[i++]))
+                    {
+                        n_consumed = i;
+                        return true;
+                    }
+                    continue;
+                }
+                size_t n = std::min(length - i, _length - _received);
+                // 在局部变量上累加，避免每个字节都写回成员。
+                uint8_t ck_a = _ck_a;
+                uint8_t ck_b = _ck_b;
+                ubx_codec::checksum(data + i, n, ck_a, ck_b);
+                _ck_a = ck_a;
+                _ck_b = ck_b;
+                std::copy(data + i, data + i + n, _payload.data() + _received);
+                _received += n;
+                i += n;
+                if (_received == _length)
+                    _state = state_t::ck_a;
+            } while (i < length && is_busy());
+            n_consumed = i;
+            return false;
+        }
+        /**
+         * @brief 最近收到的一帧。
+         */
+        ubx_frame frame() const
+        {
+            return {_cls, _id, _payload.data(), _length};
+        }
+    };
+
+    /**
+     * @brief NAV-POSLLH。大地坐标。
+     */
+    struct ubx_nav_posllh_t
+    {
+        uint32_t itow;  // GPS 周内时间，单位 ms。
+        int32_t lon;    // 经度，单位 1e-7 度。
+        int32_t lat;    // 纬度，单位 1e-7 度。
+        int32_t height; // 椭球高，单位 mm。
+        int32_t h_msl;  // 海拔高度，单位 mm。
+        uint32_t h_acc; // 水平精度估计，单位 mm。
+        uint32_t v_acc; // 垂直精度估计，单位 mm。
+
+        static constexpr size_t length = 28;
+        /**
+         * @return bool 帧的长度是否正确。
+         */
+        static bool decode(const ubx_frame& frame, ubx_nav_posllh_t& ret)
+        {
+            if (frame.length != length)
+                return false;
+            const uint8_t* p = frame.payload;
+            ret.itow = ubx_codec::read_u<4>(p);
+            ret.lon = ubx_codec::read_i4(p + 4);
+            ret.lat = ubx_codec::read_i4(p + 8);
+            ret.height = ubx_codec::read_i4(p + 12);
+            ret.h_msl = ubx_codec::read_i4(p + 16);
+            ret.h_acc = ubx_codec::read_u<4>(p + 20);
+            ret.v_acc = ubx_codec::read_u<4>(p + 24);
+            return true;
+        }
+    };
+
+    /**
+     * @brief NAV-STATUS。接收机的定位状态。
+     */
+    struct ubx_nav_status_t
+    {
+        uint32_t itow;   // GPS 周内时间，单位 ms。
+        uint8_t gps_fix; // 定位类型。0 未定位，1 航位推算，2 二维，3 三维。
+        uint8_t flags;   // 第 0 位为 gpsFixOk，第 1 位为差分定位。
+        uint32_t ttff;   // 首次定位时间，单位 ms。
+        uint32_t msss;   // 启动以来的时间，单位 ms。
+
+        static constexpr size_t length = 16;
+        /**
+         * @return bool 帧的长度是否正确。
+         */
+        static bool decode(const ubx_frame& frame, ubx_nav_status_t& ret)
+        {
+            if (frame.length != length)
+                return false;
+            const uint8_t* p = frame.payload;
+            ret.itow = ubx_codec::read_u<4>(p);
+            ret.gps_fix = p[4];
+            ret.flags = p[5];
+            ret.ttff = ubx_codec::read_u<4>(p + 8);
+            ret.msss = ubx_codec::read_u<4>(p + 12);
+            return true;
+        }
+    };
+
+    /**
+     * @brief NAV-SOL。定位解的质量。只解码用到的字段。
+     */
+    struct ubx_nav_sol_t
+    {
+        uint32_t itow;   // GPS 周内时间，单位 ms。
+        uint8_t gps_fix; // 定位类型。同 NAV-STATUS。
+        uint8_t flags;   // 第 0 位为 gpsFixOk，第 1 位为差分定位。
+        uint32_t p_acc;  // 三维位置精度估计，单位 cm。
+        uint32_t s_acc;  // 速度精度估计，单位 cm/s。
+        uint16_t p_dop;  // 位置精度因子，单位 0.01。
+        uint8_t num_sv;  // 参与定位的卫星数。
+
+        static constexpr size_t length = 52;
+        /**
+         * @return bool 帧的长度是否正确。
+         */
+        static bool decode(const ubx_frame& frame, ubx_nav_sol_t& ret)
+        {
+            if (frame.length != length)
+                return false;
+            const uint8_t* p = frame.payload;
+            ret.itow = ubx_codec::read_u<4>(p);
+            ret.gps_fix = p[10];
+            ret.flags = p[11];
+            ret.p_acc = ubx_codec::read_u<4>(p + 24);
+            ret.s_acc = ubx_codec::read_u<4>(p + 40);
+            ret.p_dop = static_cast<uint16_t>(ubx_codec::read_u<2>(p + 44));
+            ret.num_sv = p[47];
+            return true;
+        }
+    };
+
+    /**
+     * @brief NAV-TIMEUTC。UTC 时间。
+     */
+    struct ubx_nav_timeutc_t
+    {
+        uint32_t itow;  // GPS 周内时间，单位 ms。
+        uint32_t t_acc; // 时间精度估计，单位 ns。
+        int32_t nano;   // 秒的小数部分，单位 ns。可以为负。
+        int year;
+        int month;
+        int day;
+        int hour;
+        int minute;
+        int second;
+        uint8_t valid; // 第 2 位为 validUTC。
+
+        static constexpr size_t length = 20;
+        /**
+         * @return bool 帧的长度是否正确。
+         */
+        static bool decode(const ubx_frame& frame, ubx_nav_timeutc_t& ret)
+        {
+            if (frame.length != length)
+                return false;
+            const uint8_t* p = frame.payload;
+            ret.itow = ubx_codec::read_u<4>(p);
+            ret.t_acc = ubx_codec::read_u<4>(p + 4);
+            ret.nano = ubx_codec::read_i4(p + 8);
+            ret.year = static_cast<int>(ubx_codec::read_u<2>(p + 12));
+            ret.month = p[14];
+            ret.day = p[15];
+            ret.hour = p[16];
+            ret.minute = p[17];
+            ret.second = p[18];
+            ret.valid = p[19];
+            return true;
+        }
+        /**
+         * @brief UTC 时间是否有效。
+         */
+        bool is_utc_valid() const
+        {
+            return valid & 0x04;
+        }
+    };
+
+    /**
+     * @brief ACK-ACK 与 ACK-NAK。对 CFG 类消息的应答。
+     */
+    struct ubx_ack_t
+    {
+        bool is_ack; // 为假时表示 NAK。
+        uint8_t cls; // 被应答的消息类。
+        uint8_t id;  // 被应答的消息编号。
+
+        static constexpr size_t length = 2;
+        /**
+         * @return bool 是否是 ACK 类的消息且帧的长度正确。
+         */
+        static bool decode(const ubx_frame& frame, ubx_ack_t& ret)
+        {
+            if (frame.cls != ubx_codec::class_ack || frame.length != length ||
+                (frame.id != ubx_codec::id_ack_ack &&
+                 frame.id != ubx_codec::id_ack_nak))
+                return false;
+            ret.is_ack = frame.id == ubx_codec::id_ack_ack;
+            ret.cls = frame.payload[0];
+            ret.id = frame.payload[1];
+            return true;
+        }
+    };
+} // namespace peripheral
@@ -95,6 +95,24 @@ namespace peripheral
          * @param data 消息的额外数据。
          */
         void post_message_unique(int id, std::shared_ptr<void> data)
+        {
+            post_message_unique_if(id, std::move(data),
+                                   [](const std::shared_ptr<void>&) {
+                                       return true;
+                                   });
+        }
+        /**
+         * @brief 向消息队列发送消息。
+         * 如果这种类型的消息已经存在，且满足给定的条件，则覆盖最晚的消息。
+         * 用于同一类型的消息按参数区分，例如不同 Socket 的消息互不覆盖。
+         *
+         * @param id 消息 id。0 表示退出，不要发送 0。
+         * @param data 消息的额外数据。
+         * @param is_same 判断已有消息是否应被覆盖。参数为已有消息的额外数据。
+         */
+        template <typename pred_t>
+        void post_message_unique_if(int id, std::shared_ptr<void> data,
+                                    pred_t is_same)
         {
             if (_should_exit)
                 return;
@@ -104,7 +122,8 @@ namespace peripheral
             // 倒序查找最晚的消息。
             for (auto it = _queue.rbegin(); it != _queue.rend(); it++)
             {
-                if (it->first == id) // 找到了这种类型的消息。
+                // 找到了这种类型的消息。
+                if (it->first == id && is_same(it->second))
                 {
                     _has_found = true;
                     it->second = data; // 将其额外数据覆盖。
@@ -139,6 +158,32 @@ namespace peripheral
             }
             return message;
         }
+        /**
+         * @brief 阻塞地获取消息队列中的消息。如果队列为空则等待，
+         * 至多等待到给定的时刻。
+         *
+         * @param deadline 最晚返回的时刻。
+         * @return raw_message_t 收到的消息。
+         * 如果超时，返回 {0, nullptr}。
+         */
+        raw_message_t get_message_until(Kernel::Clock::time_point deadline)
+        {
+            if (_should_exit)
+                return {0, nullptr};
+
+            raw_message_t message{0, nullptr};
+            {
+                rtos::ScopedMutexLock lock(_mutex_queue);
+                _cond_queue.wait_until(deadline, [this]() {
+                    return _should_exit || !_queue.empty();
+                });
+                if (_should_exit || _queue.empty())
+                    return {0, nullptr};
+                message = _queue.front();
+                _queue.pop_front();
+            }
+            return message;
+        }
         /**
          * @brief 阻塞地获取消息队列中的消息。如果队列中没有范围内的消息则等待。
          *
@@ -0,0 +1,31 @@
+/**
+ * @file main.cpp
+ * @author UnnamedOrange
+ * @brief 在 Linux 上运行不依赖硬件的测试。
+ * 驱动不做任何修改，BC26 模块与串口由 bc26_emulator 代替。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include "mbed.h"
+
+#include <test/peripheral/bc26/test_at_tokenizer.hpp>
+#include <test/peripheral/bc26/test_bc26_emulator.hpp>
+#include <test/peripheral/gps/test_fix_filter.hpp>
+#include <test/peripheral/gps/test_nmea_replay.hpp>
+#include <test/peripheral/gps/test_nmea_tokenizer.hpp>
+#include <test/peripheral/gps/test_ubx_codec.hpp>
+#include <test/test_utils.hpp>
+
+int main()
+{
+    test::test_at_tokenizer();
+    test::test_bc26_emulator();
+    test::test_fix_filter();
+    test::test_nmea_replay();
+    test::test_nmea_tokenizer();
+    test::test_ubx_codec();
+    // 只有测试项的结果计入，驱动自身对失败指令的输出不计入。
+    return test::n_failed() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
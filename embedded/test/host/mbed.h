@@ -0,0 +1,493 @@
+/**
+ * @file mbed.h
+ * @author UnnamedOrange
+ * @brief 在 Linux 上运行测试时代替 Mbed OS 的头文件。
+ *
+ * 只实现驱动与测试用到的部分：Kernel::Clock、rtos 的线程与同步原语、
+ * mbed 的 Callback、Timer、Timeout，以及不连接任何硬件的外设类。
+ * 线程与同步原语基于标准库实现，行为与 Mbed OS 一致，
+ * 例如 rtos::Mutex 可以递归加锁，Semaphore 有计数上限。
+ *
+ * @note 不在目标板上编译。.mbedignore 中忽略了该目录。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <sys/types.h>
+
+#define DEVICE_STDIO_MESSAGES 1
+#define MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE 256
+#define MBED_SUCCESS 0
+
+/**
+ * @brief 引脚。只用于区分，不对应任何硬件。
+ */
+enum PinName
+{
+    NC,
+    PA_5,
+    PA_6,
+    PA_7,
+    PA_9,
+    PA_10,
+    PB_3,
+    PB_5,
+    PB_10,
+    PC_4,
+    PC_5,
+    PC_10,
+    PC_11,
+    PC_12,
+};
+
+inline void debug(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+}
+inline void error(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    std::abort();
+}
+
+namespace Kernel
+{
+    /**
+     * @brief 系统时钟，单位 ms。基于 std::chrono::steady_clock。
+     */
+    struct Clock
+    {
+        using duration = std::chrono::milliseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using duration_u32 = std::chrono::duration<uint32_t, std::milli>;
+        using time_point = std::chrono::time_point<Clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now()
+        {
+            return time_point{std::chrono::duration_cast<duration>(
+                std::chrono::steady_clock::now().time_since_epoch())};
+        }
+    };
+} // namespace Kernel
+
+namespace rtos
+{
+    /**
+     * @brief 可递归加锁的互斥量，与 Mbed OS 一致。
+     */
+    class Mutex
+    {
+    private:
+        std::recursive_mutex _mutex;
+
+    public:
+        void lock()
+        {
+            _mutex.lock();
+        }
+        bool trylock()
+        {
+            return _mutex.try_lock();
+        }
+        void unlock()
+        {
+            _mutex.unlock();
+        }
+        std::recursive_mutex& native()
+        {
+            return _mutex;
+        }
+    };
+    template <typename lockable_t>
+    class ScopedLock
+    {
+    private:
+        lockable_t& _lockable;
+
+    public:
+        ScopedLock(lockable_t& lockable) : _lockable(lockable)
+        {
+            _lockable.lock();
+        }
+        ~ScopedLock()
+        {
+            _lockable.unlock();
+        }
+        ScopedLock(const ScopedLock&) = delete;
+        ScopedLock& operator=(const ScopedLock&) = delete;
+    };
+    using ScopedMutexLock = ScopedLock<Mutex>;
+
+    /**
+     * @brief 条件变量。调用时必须已经持有构造时给定的互斥量。
+     */
+    class ConditionVariable
+    {
+    private:
+        Mutex& _mutex;
+        std::condition_variable_any _cond;
+
+    public:
+        ConditionVariable(Mutex& mutex) : _mutex(mutex)
+        {
+        }
+
+        void wait()
+        {
+            _cond.wait(_mutex.native());
+        }
+        template <typename predicate_t>
+        void wait(predicate_t pred)
+        {
+            _cond.wait(_mutex.native(), pred);
+        }
+        /**
+         * @return bool 是否超时。
+         */
+        bool wait_for(Kernel::Clock::duration_u32 time)
+        {
+            return _cond.wait_for(_mutex.native(), time) ==
+                   std::cv_status::timeout;
+        }
+        /**
+         * @return bool 是否超时。
+         */
+        bool wait_until(Kernel::Clock::time_point time)
+        {
+            return wait_for(std::chrono::duration_cast<
+                            Kernel::Clock::duration_u32>(
+                std::max(time - Kernel::Clock::now(),
+                         Kernel::Clock::duration{})));
+        }
+        /**
+         * @return bool 返回时 pred 的值。
+         */
+        template <typename predicate_t>
+        bool wait_until(Kernel::Clock::time_point time, predicate_t pred)
+        {
+            while (!pred())
+                if (wait_until(time))
+                    return pred();
+            return true;
+        }
+        void notify_one()
+        {
+            _cond.notify_one();
+        }
+        void notify_all()
+        {
+            _cond.notify_all();
+        }
+    };
+
+    /**
+     * @brief 有计数上限的信号量。释放时超过上限的部分被忽略。
+     */
+    class Semaphore
+    {
+    private:
+        std::mutex _mutex;
+        std::condition_variable _cond;
+        int _count;
+        int _max_count;
+
+    public:
+        Semaphore(int count = 0, int max_count = 1)
+            : _count(count), _max_count(max_count)
+        {
+        }
+
+        void acquire()
+        {
+            std::unique_lock lock{_mutex};
+            _cond.wait(lock, [this] { return _count > 0; });
+            _count--;
+        }
+        bool try_acquire()
+        {
+            std::unique_lock lock{_mutex};
+            if (!_count)
+                return false;
+            _count--;
+            return true;
+        }
+        bool try_acquire_for(Kernel::Clock::duration_u32 time)
+        {
+            std::unique_lock lock{_mutex};
+            if (!_cond.wait_for(lock, time, [this] { return _count > 0; }))
+                return false;
+            _count--;
+            return true;
+        }
+        bool try_acquire_until(Kernel::Clock::time_point time)
+        {
+            return try_acquire_for(
+                std::chrono::duration_cast<Kernel::Clock::duration_u32>(
+                    std::max(time - Kernel::Clock::now(),
+                             Kernel::Clock::duration{})));
+        }
+        void release()
+        {
+            std::unique_lock lock{_mutex};
+            if (_count < _max_count)
+                _count++;
+            _cond.notify_one();
+        }
+    };
+
+    /**
+     * @brief 线程。只支持 start、join 与 get_state。
+     */
+    class Thread
+    {
+    public:
+        enum class State
+        {
+            Inactive,
+            Running,
+            Deleted,
+        };
+
+    private:
+        std::thread _thread;
+        std::atomic<bool> _is_started{};
+        std::atomic<bool> _is_finished{};
+
+    public:
+        Thread() = default;
+        Thread(const Thread&) = delete;
+        Thread& operator=(const Thread&) = delete;
+        ~Thread()
+        {
+            if (_thread.joinable())
+                _thread.detach();
+        }
+
+        int start(std::function<void()> task)
+        {
+            _is_started = true;
+            _thread = std::thread([this, task] {
+                task();
+                _is_finished = true;
+            });
+            return 0;
+        }
+        int join()
+        {
+            if (_thread.joinable())
+                _thread.join();
+            return 0;
+        }
+        State get_state() const
+        {
+            if (_is_finished)
+                return State::Deleted;
+            return _is_started ? State::Running : State::Inactive;
+        }
+    };
+
+    namespace ThisThread
+    {
+        template <typename rep_t, typename period_t>
+        void sleep_for(std::chrono::duration<rep_t, period_t> time)
+        {
+            std::this_thread::sleep_for(time);
+        }
+    } // namespace ThisThread
+} // namespace rtos
+
+namespace mbed
+{
+    template <typename signature_t>
+    using Callback = std::function<signature_t>;
+
+    /**
+     * @brief 计时器，单位 us。
+     */
+    class Timer
+    {
+    private:
+        using clock = std::chrono::steady_clock;
+        clock::time_point _start{};
+        std::chrono::microseconds _elapsed{};
+        bool _is_running{};
+
+    public:
+        void start()
+        {
+            if (_is_running)
+                return;
+            _start = clock::now();
+            _is_running = true;
+        }
+        void stop()
+        {
+            if (!_is_running)
+                return;
+            _elapsed += since_start();
+            _is_running = false;
+        }
+        void reset()
+        {
+            _start = clock::now();
+            _elapsed = {};
+        }
+        std::chrono::microseconds elapsed_time() const
+        {
+            return _is_running ? _elapsed + since_start() : _elapsed;
+        }
+
+    private:
+        std::chrono::microseconds since_start() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                clock::now() - _start);
+        }
+    };
+
+    /**
+     * @brief 单次定时器。回调函数在单独的线程中运行，
+     * 对应 Mbed OS 中的中断上下文。
+     */
+    class Timeout
+    {
+    private:
+        /**
+         * @brief 每次 attach 或 detach 时加一，过时的回调不再执行。
+         */
+        std::shared_ptr<std::atomic<int>> _generation =
+            std::make_shared<std::atomic<int>>(0);
+
+    public:
+        ~Timeout()
+        {
+            detach();
+        }
+
+        template <typename rep_t, typename period_t>
+        void attach(Callback<void()> func,
+                    std::chrono::duration<rep_t, period_t> time)
+        {
+            int generation = ++*_generation;
+            std::thread([func, time, generation, current = _generation] {
+                std::this_thread::sleep_for(time);
+                if (*current == generation)
+                    func();
+            }).detach();
+        }
+        void detach()
+        {
+            ++*_generation;
+        }
+    };
+
+    /**
+     * @brief 不连接任何硬件的串口。读不到数据，写入的数据被丢弃。
+     */
+    class BufferedSerial
+    {
+    public:
+        BufferedSerial(PinName tx, PinName rx, int baud = 9600)
+        {
+        }
+
+        ssize_t write(const void* buffer, size_t length)
+        {
+            return static_cast<ssize_t>(length);
+        }
+        ssize_t read(void* buffer, size_t length)
+        {
+            return -EAGAIN;
+        }
+        int set_blocking(bool is_blocking)
+        {
+            return 0;
+        }
+        void set_baud(int baud)
+        {
+        }
+        int enable_input(bool is_enabled)
+        {
+            return 0;
+        }
+        int enable_output(bool is_enabled)
+        {
+            return 0;
+        }
+        short poll(short events) const
+        {
+            return 0;
+        }
+        int sync()
+        {
+            return 0;
+        }
+        void sigio(Callback<void()> func)
+        {
+        }
+    };
+
+    /**
+     * @brief 不连接任何硬件的输出引脚。
+     */
+    class DigitalOut
+    {
+    private:
+        int _value;
+
+    public:
+        DigitalOut(PinName pin, int value = 0) : _value(value)
+        {
+        }
+
+        void write(int value)
+        {
+            _value = value;
+        }
+        int read()
+        {
+            return _value;
+        }
+        DigitalOut& operator=(int value)
+        {
+            write(value);
+            return *this;
+        }
+        operator int()
+        {
+            return read();
+        }
+    };
+} // namespace mbed
+
+// 与 Mbed OS 的 mbed.h 一致。
+using namespace mbed;
+using namespace std;
@@ -0,0 +1,235 @@
+/**
+ * @file test_at_tokenizer.hpp
+ * @author UnnamedOrange
+ * @brief 测试 peripheral/bc26/at_tokenizer.hpp。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include <peripheral/bc26/at_tokenizer.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+namespace test
+{
+    /**
+     * @brief 测试 at_tokenizer。
+     * - 测试典型回复的分词与参数解析。
+     * - 用随机输入测试不变量：结果都在输入之内，行数不超过上限。
+     * - 与原先的 std::string::find 加 sscanf 的解析方式比较耗时。
+     */
+    class test_at_tokenizer
+    {
+    private:
+        using at_line_type_t = peripheral::at_line_type_t;
+        template <size_t max_lines = 16>
+        using at_response = peripheral::at_response<max_lines>;
+
+        static void test_golden()
+        {
+            {
+                utils::debug_printf("[-] OK\n");
+                at_response<> response{"\r\nOK\r\n"};
+                report(response.size() == 1 && response.is_ok() &&
+                           !response.is_error(),
+                       "OK");
+            }
+            {
+                utils::debug_printf("[-] +CME ERROR\n");
+                at_response<> response{"\r\n+CME ERROR: 50\r\n"};
+                report(response.is_error() && !response.is_ok(), "+CME ERROR");
+            }
+            {
+                utils::debug_printf("[-] AT+CIMI\n");
+                at_response<> response{"\r\n460041234567890\r\n\r\nOK\r\n"};
+                auto line = response.find(at_line_type_t::text);
+                report(response.is_ok() && line &&
+                           line->text == "460041234567890",
+                       "AT+CIMI");
+            }
+            {
+                utils::debug_printf("[-] AT+CESQ\n");
+                at_response<> response{
+                    "\r\n+CESQ: 36,99,255,255,12,53\r\n\r\nOK\r\n"};
+                int rxlev{};
+                int ber{};
+                report(response.is_ok() &&
+                           2 == response.parse("+CESQ", rxlev, ber) &&
+                           rxlev == 36 && ber == 99,
+                       "AT+CESQ");
+            }
+            {
+                utils::debug_printf("[-] AT+QIOPEN\n");
+                at_response<> response{
+                    "AT+QIOPEN=1,0,\"TCP\",\"1.2.3.4\",80\r\n"
+                    "\r\nOK\r\n\r\n+QIOPEN: 0,0\r\n"};
+                int connect_id = -1;
+                int result = -1;
+                report(response.is_ok() &&
+                           response.has(at_line_type_t::echo) &&
+                           2 == response.parse("+QIOPEN", connect_id,
+                                               result) &&
+                           connect_id == 0 && result == 0 &&
+                           response.find("+QIOPEN")->type ==
+                               at_line_type_t::information,
+                       "AT+QIOPEN");
+            }
+            {
+                utils::debug_printf("[-] URC\n");
+                at_response<> response{"\r\n+QIURC: \"recv\",0\r\n"
+                                       "\r\n+QMTRECV: 0,1,\"a,b\",x,\"y\"\r\n"};
+                std::string_view type;
+                int connect_id = -1;
+                bool is_success =
+                    response.size() == 2 &&
+                    response.find("+QIURC")->type == at_line_type_t::urc &&
+                    2 == response.parse("+QIURC", type, connect_id) &&
+                    type == "recv" && connect_id == 0;
+                // 引号内的逗号不分隔参数，剩余内容可以包含逗号。
+                peripheral::at_fields fields{response.find("+QMTRECV")->params};
+                int id{};
+                int msg_id{};
+                std::string_view topic;
+                is_success = is_success && fields.next(id) &&
+                             fields.next(msg_id) && fields.next(topic) &&
+                             topic == "a,b" && fields.rest() == "x,\"y\"";
+                report(is_success, "URC");
+            }
+            {
+                utils::debug_printf("[-] prompt\n");
+                at_response<> response{"\r\n> "};
+                report(response.has(at_line_type_t::prompt) &&
+                           response.complete_length() == 4,
+                       "prompt");
+            }
+            {
+                utils::debug_printf("[-] incomplete line\n");
+                at_response<> response{"\r\nSEND OK\r\n\r\n+QIURC: \"cl"};
+                report(response.size() == 1 && response.has_line("SEND OK") &&
+                           response.complete_length() == 13,
+                       "incomplete line");
+            }
+            {
+                utils::debug_printf("[-] parse_int\n");
+                int value{};
+                bool is_success =
+                    peripheral::at_fields::parse_int(" -12 ", value) &&
+                    value == -12 &&
+                    !peripheral::at_fields::parse_int("1a", value) &&
+                    !peripheral::at_fields::parse_int("", value) &&
+                    !peripheral::at_fields::parse_int("99999999999", value);
+                report(is_success, "parse_int");
+            }
+        }
+
+        static void test_fuzz()
+        {
+            constexpr int n_round = 2000;
+            constexpr size_t max_lines = 4;
+            // 偏向于出现在 AT 回复中的字符。
+            constexpr std::string_view alphabet = "\r\n\r\n,,\"\" :+>ATOKER019";
+            xorshift next_random;
+
+            utils::debug_printf("[-] fuzz\n");
+            bool is_success = true;
+            char input[64];
+            for (int round = 0; round < n_round && is_success; round++)
+            {
+                size_t length = next_random() % sizeof(input);
+                for (size_t i = 0; i < length; i++)
+                {
+                    // 偶尔混入任意字节。
+                    uint32_t r = next_random();
+                    input[i] = r & 0x100 ? alphabet[r % alphabet.length()]
+                                         : static_cast<char>(r);
+                }
+                std::string_view view(input, length);
+                at_response<max_lines> response{view};
+                auto inside = [view](std::string_view part) {
+                    return part.empty() ||
+                           (part.data() >= view.data() &&
+                            part.data() + part.length() <=
+                                view.data() + view.length());
+                };
+                is_success = response.size() <= max_lines &&
+                             response.complete_length() <= length;
+                for (const auto& line : response)
+                {
+                    is_success = is_success && !line.text.empty() &&
+                                 inside(line.text) && inside(line.prefix) &&
+                                 inside(line.params) &&
+                                 line.text.find_first_of("\r\n") ==
+                                     std::string_view::npos;
+                    // 解析参数不应越界。
+                    peripheral::at_fields fields{line.params};
+                    std::string_view field;
+                    for (size_t n = 0; fields.next(field); n++)
+                        is_success = is_success && inside(field) &&
+                                     n <= line.params.length();
+                }
+            }
+            report(is_success, "fuzz");
+        }
+
+        static void test_benchmark()
+        {
+            constexpr int n_round = 1000;
+            const std::string received =
+                "\r\nOK\r\n\r\n+QIURC: \"recv\",0\r\n\r\n+QMTOPEN: 0,0\r\n";
+
+            utils::debug_printf("[-] benchmark\n");
+            int checksum = 0;
+
+            // 原先的方式：每个问题各扫描一遍，参数用 sscanf 解析。
+            auto legacy_time = measure(n_round, [&] {
+                bool is_ok = received.find("OK") != std::string::npos;
+                bool is_error = received.find("ERROR") != std::string::npos;
+                int id{};
+                int result{};
+                auto pos = received.find("+QMTOPEN:");
+                auto end = received.find_first_of("\r\n", pos);
+                std::string line = received.substr(pos + 9, end - pos - 9);
+                if (is_ok && !is_error &&
+                    2 == sscanf(line.c_str(), " %d,%d", &id, &result))
+                    checksum += id + result + 1;
+            });
+
+            auto tokenizer_time = measure(n_round, [&] {
+                at_response<> response{received};
+                int id{};
+                int result{};
+                if (response.is_ok() && !response.is_error() &&
+                    2 == response.parse("+QMTOPEN", id, result))
+                    checksum -= id + result + 1;
+            });
+
+            utils::debug_printf(
+                "[I] find + sscanf: %lld us, tokenizer: %lld us.\n",
+                static_cast<long long>(legacy_time.count()),
+                static_cast<long long>(tokenizer_time.count()));
+            report(!checksum && tokenizer_time < legacy_time, "benchmark");
+        }
+
+    public:
+        test_at_tokenizer()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] at_tokenizer test.\n");
+
+            test_golden();
+            test_fuzz();
+            test_benchmark();
+        }
+    };
+} // namespace test
@@ -92,7 +92,9 @@ namespace test
                             msg = fmq.get_message();
                             if (msg.first == fmq_e_t::bc26_send_at_qiclose)
                             {
-                                auto close_succuss = utils::msg_data<bool>(msg);
+                                auto close_succuss = std::get<0>(
+                                    utils::msg_data<std::tuple<bool, int>>(
+                                        msg));
                                 if (close_succuss)
                                     utils::debug_printf("[I] tcp close.\n");
                                 else
@@ -164,7 +166,8 @@ namespace test
                     case fmq_e_t::bc26_send_at_qird:
                     {
                         const auto& data =
-                            utils::msg_data<std::tuple<bool, std::string>>(msg);
+                            utils::msg_data<
+                                std::tuple<bool, std::string, int>>(msg);
                         if (std::get<0>(data))
                         {
                             if (std::get<1>(data).length())
@@ -183,7 +186,8 @@ namespace test
                     }
                     case fmq_e_t::bc26_send_at_qisend:
                     {
-                        const auto& is_ok = utils::msg_data<bool>(msg);
+                        const auto& is_ok = std::get<0>(
+                            utils::msg_data<std::tuple<bool, int>>(msg));
                         if (!is_ok)
                             should_open_tcp = true;
                         break;
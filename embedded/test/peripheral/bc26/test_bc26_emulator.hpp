@@ -0,0 +1,384 @@
+/**
+ * @file test_bc26_emulator.hpp
+ * @author UnnamedOrange
+ * @brief 使用 peripheral/bc26/bc26_emulator.hpp 测试 BC26 模块的驱动。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <string>
+#include <tuple>
+
+#include <peripheral/bc26/bc26.hpp>
+#include <peripheral/bc26/bc26_emulator.hpp>
+#include <peripheral/feedback_message.hpp>
+#include <peripheral/feedback_message_queue.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+#include <utils/msg_data.hpp>
+#include <utils/ring_buffer.hpp>
+
+namespace test
+{
+    /**
+     * @brief 使用模拟器测试 BC26 模块的驱动。不需要模块和服务器。
+     * - 测试初始化、Socket 收发、信号质量、域名解析、MQTT 收发与 URC。
+     * - 测试注入错误、断开连接与失去信号后的行为。
+     * - 输出每条指令从发出到收到反馈消息的时延，以及恢复连接的时间。
+     */
+    class test_bc26_emulator
+    {
+    private:
+        using fmq_e_t = peripheral::feedback_message_enum_t;
+        using emulator_t = peripheral::bc26_emulator;
+        peripheral::feedback_message_queue fmq;
+        // 模拟器需要比 bc26 晚销毁。
+        emulator_t emulator;
+        peripheral::bc26 bc26{fmq, emulator, emulator};
+        mbed::Timer timer;
+
+        /**
+         * @brief 等待给定的反馈消息，忽略其间的其他消息，并输出时延。
+         */
+        peripheral::feedback_message_queue::message_t wait_for(fmq_e_t id,
+                                                               const char* name)
+        {
+            auto msg = fmq.get_message(id, id);
+            utils::debug_printf(
+                "[I] %s: %lld ms.\n", name,
+                static_cast<long long>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        timer.elapsed_time())
+                        .count()));
+            return msg;
+        }
+        /**
+         * @brief 打开 Socket，返回 +QIOPEN 的 <result>。
+         */
+        int open_socket(const char* name, int connect_id = 0)
+        {
+            timer.reset();
+            bc26.send_at_qiopen("127.0.0.1", 8080, connect_id);
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qiopen, name);
+            auto t = utils::msg_data<std::tuple<bool, int, int>>(msg);
+            return std::get<0>(t) ? std::get<2>(t) : -1;
+        }
+
+        void test_init()
+        {
+            utils::debug_printf("[-] init\n");
+            timer.reset();
+            bc26.init();
+            auto msg = wait_for(fmq_e_t::bc26_init, "init");
+            using param_type = std::tuple<bool, std::string, bool, int>;
+            auto t = utils::msg_data<param_type>(msg);
+            report(std::get<0>(t) && std::get<1>(t) == "460001234567890" &&
+                       std::get<2>(t),
+                   "init");
+        }
+        void test_socket()
+        {
+            using namespace std::literals;
+
+            utils::debug_printf("[-] socket\n");
+            bool is_success = !open_socket("qiopen");
+
+            timer.reset();
+            bc26.send_at_qisend("hello");
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qisend, "qisend");
+            is_success = is_success &&
+                         std::get<0>(
+                             utils::msg_data<std::tuple<bool, int>>(msg)) &&
+                         emulator.take_sent() == "hello";
+
+            // 数据模式，数据中包含换行与引号。
+            static const char data[] = "a\r\nb\"c";
+            timer.reset();
+            bc26.send_at_qisend_data(data, sizeof(data) - 1);
+            msg = wait_for(fmq_e_t::bc26_send_at_qisend, "qisend data");
+            is_success = is_success &&
+                         std::get<0>(
+                             utils::msg_data<std::tuple<bool, int>>(msg)) &&
+                         emulator.take_sent() == data;
+
+            // 服务器推送数据，驱动上报 URC 后读取。
+            utils::static_ring_buffer<64> buffer;
+            timer.reset();
+            emulator.push_socket_data(0, "x\r\nOK\r\ny");
+            wait_for(fmq_e_t::bc26_qiurc_recv, "qiurc recv");
+            timer.reset();
+            bc26.send_at_qird_drain(buffer);
+            msg = wait_for(fmq_e_t::bc26_send_at_qird_drain, "qird drain");
+            auto t =
+                utils::msg_data<std::tuple<bool, size_t, bool, int>>(msg);
+            is_success = is_success && std::get<0>(t) && std::get<2>(t) &&
+                         buffer.read_all() == "x\r\nOK\r\ny";
+            report(is_success, "socket");
+        }
+        void test_multi_socket()
+        {
+            using namespace std::literals;
+
+            utils::debug_printf("[-] multi socket\n");
+            bool is_success = !open_socket("qiopen 1", 1) &&
+                              bc26.is_socket_open(0) && bc26.is_socket_open(1);
+
+            // 在 Socket 0 发送期间 Socket 1 收到数据，URC 不应丢失。
+            utils::static_ring_buffer<64> buffer;
+            emulator.set_delay("AT+QISEND", 100ms);
+            timer.reset();
+            bc26.send_at_qisend("report", 0);
+            emulator.push_socket_data(1, "cmd");
+            auto msg = wait_for(fmq_e_t::bc26_qiurc_recv, "qiurc recv 1");
+            is_success = is_success && utils::msg_data<int>(msg) == 1;
+            msg = wait_for(fmq_e_t::bc26_send_at_qisend, "qisend 0");
+            {
+                auto t = utils::msg_data<std::tuple<bool, int>>(msg);
+                is_success = is_success && std::get<0>(t) && !std::get<1>(t) &&
+                             emulator.take_sent() == "report";
+            }
+            emulator.set_delay("AT+QISEND", 0ms);
+            timer.reset();
+            bc26.send_at_qird_drain(buffer, 1);
+            msg = wait_for(fmq_e_t::bc26_send_at_qird_drain, "qird drain 1");
+            {
+                auto t =
+                    utils::msg_data<std::tuple<bool, size_t, bool, int>>(msg);
+                is_success = is_success && std::get<0>(t) &&
+                             std::get<3>(t) == 1 && buffer.read_all() == "cmd";
+            }
+
+            // 关闭后发送立即失败，不发出指令。
+            timer.reset();
+            bc26.send_at_qiclose(1);
+            msg = wait_for(fmq_e_t::bc26_send_at_qiclose, "qiclose 1");
+            is_success =
+                is_success &&
+                std::get<1>(utils::msg_data<std::tuple<bool, int>>(msg)) == 1;
+            int n_commands = emulator.n_commands();
+            timer.reset();
+            bc26.send_at_qisend("closed", 1);
+            msg = wait_for(fmq_e_t::bc26_send_at_qisend, "qisend closed");
+            is_success =
+                is_success &&
+                !std::get<0>(utils::msg_data<std::tuple<bool, int>>(msg)) &&
+                emulator.n_commands() == n_commands && bc26.is_socket_open(0);
+            report(is_success, "multi socket");
+        }
+        void test_signal()
+        {
+            utils::debug_printf("[-] signal\n");
+            using param_type = std::tuple<bool, int, int, int>;
+            // 覆盖良好时 ECL 为 0，小区边缘时为 2。
+            timer.reset();
+            bc26.send_at_qeng();
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qeng, "qeng");
+            auto t = utils::msg_data<param_type>(msg);
+            bool is_success = std::get<0>(t) && !std::get<3>(t);
+
+            emulator.set_signal(5);
+            timer.reset();
+            bc26.send_at_qeng();
+            msg = wait_for(fmq_e_t::bc26_send_at_qeng, "qeng cell edge");
+            t = utils::msg_data<param_type>(msg);
+            is_success = is_success && std::get<0>(t) &&
+                         std::get<1>(t) < -120 && std::get<3>(t) == 2;
+            emulator.set_signal(40);
+            report(is_success, "signal");
+        }
+        void test_dns()
+        {
+            utils::debug_printf("[-] dns\n");
+            using param_type = std::tuple<bool, std::string, int>;
+            emulator.set_dns("example.com", "1.2.3.4", 300);
+            timer.reset();
+            bc26.send_at_qidnsgip("example.com");
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qidnsgip, "qidnsgip");
+            auto t = utils::msg_data<param_type>(msg);
+            bool is_success = std::get<0>(t) && std::get<1>(t) == "1.2.3.4" &&
+                              std::get<2>(t) == 300;
+
+            // 解析失败。
+            timer.reset();
+            bc26.send_at_qidnsgip("unknown.example.com");
+            msg = wait_for(fmq_e_t::bc26_send_at_qidnsgip, "qidnsgip failed");
+            is_success =
+                is_success && !std::get<0>(utils::msg_data<param_type>(msg));
+            report(is_success, "dns");
+        }
+        void test_clock()
+        {
+            utils::debug_printf("[-] clock\n");
+            using param_type = std::tuple<bool, int64_t>;
+            // 尚未从网络获取到时间。
+            timer.reset();
+            bc26.send_at_cclk();
+            auto msg = wait_for(fmq_e_t::bc26_send_at_cclk, "cclk no time");
+            bool is_success = !std::get<0>(utils::msg_data<param_type>(msg));
+
+            // 2024-02-29 12:34:56 UTC。
+            constexpr int64_t epoch = 1709210096;
+            static_assert(utils::civil_time::to_epoch(
+                              {2024, 2, 29, 12, 34, 56}) == epoch);
+            timer.reset();
+            bc26.send_at_ctzr(3);
+            msg = wait_for(fmq_e_t::bc26_send_at_ctzr, "ctzr");
+            is_success = is_success && utils::msg_data<bool>(msg);
+            emulator.set_time(epoch);
+            msg = wait_for(fmq_e_t::bc26_nitz, "nitz");
+            is_success = is_success && utils::msg_data<int64_t>(msg) == epoch;
+
+            timer.reset();
+            bc26.send_at_cclk();
+            msg = wait_for(fmq_e_t::bc26_send_at_cclk, "cclk");
+            auto t = utils::msg_data<param_type>(msg);
+            is_success = is_success && std::get<0>(t) &&
+                         std::get<1>(t) - epoch <= 1;
+            report(is_success, "clock");
+        }
+        void test_fault()
+        {
+            using namespace std::literals;
+
+            utils::debug_printf("[-] fault\n");
+            // 注入错误。
+            emulator.inject_fault("AT+QISEND", emulator_t::fault_t::error);
+            timer.reset();
+            bc26.send_at_qisend("lost");
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qisend, "qisend error");
+            bool is_success =
+                !std::get<0>(utils::msg_data<std::tuple<bool, int>>(msg));
+
+            // 不回复时，驱动应在超时后返回失败，而不是一直等待。
+            emulator.inject_fault("AT+CESQ", emulator_t::fault_t::no_response);
+            timer.reset();
+            bc26.send_at_cesq();
+            msg = wait_for(fmq_e_t::bc26_send_at_cesq, "cesq no response");
+            is_success =
+                is_success &&
+                !std::get<0>(utils::msg_data<std::tuple<bool, int>>(msg));
+
+            // 回复延迟。
+            emulator.set_delay("AT+CESQ", 200ms);
+            timer.reset();
+            bc26.send_at_cesq();
+            msg = wait_for(fmq_e_t::bc26_send_at_cesq, "cesq delayed");
+            is_success =
+                is_success &&
+                std::get<0>(utils::msg_data<std::tuple<bool, int>>(msg));
+            emulator.set_delay("AT+CESQ", 0ms);
+            report(is_success, "fault");
+        }
+        void test_recovery()
+        {
+            using namespace std::literals;
+
+            utils::debug_printf("[-] recovery\n");
+            // 服务器断开连接。
+            emulator.close_socket(0);
+            fmq.get_message(fmq_e_t::bc26_qiurc_closed,
+                            fmq_e_t::bc26_qiurc_closed);
+            bool is_success = !emulator.is_socket_open(0) &&
+                              !open_socket("qiopen after closed");
+
+            // 失去信号，1 s 后恢复。重试直到重新打开。
+            emulator.set_signal(emulator_t::no_signal);
+            fmq.get_message(fmq_e_t::bc26_qiurc_closed,
+                            fmq_e_t::bc26_qiurc_closed);
+            is_success = is_success && open_socket("qiopen without signal") ==
+                                           emulator_t::error_connect_failed;
+            mbed::Timer recovery_timer;
+            recovery_timer.start();
+            rtos::ThisThread::sleep_for(1s);
+            emulator.set_signal(40);
+            int n_retry = 0;
+            while (open_socket("qiopen retry") && n_retry < 10)
+            {
+                n_retry++;
+                rtos::ThisThread::sleep_for(200ms);
+            }
+            recovery_timer.stop();
+            utils::debug_printf(
+                "[I] recovery: %lld ms, %d retries.\n",
+                static_cast<long long>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        recovery_timer.elapsed_time())
+                        .count()),
+                n_retry);
+            is_success = is_success && emulator.is_socket_open(0);
+            report(is_success, "recovery");
+        }
+        void test_mqtt()
+        {
+            utils::debug_printf("[-] mqtt\n");
+            timer.reset();
+            bc26.send_at_qmtopen(0, "127.0.0.1", 1883);
+            auto msg = wait_for(fmq_e_t::bc26_send_at_qmtopen, "qmtopen");
+            bool is_success = std::get<0>(
+                utils::msg_data<std::tuple<bool, int, int>>(msg));
+
+            timer.reset();
+            bc26.send_at_qmtconn(0, "client", "user", "password");
+            msg = wait_for(fmq_e_t::bc26_send_at_qmtconn, "qmtconn");
+            {
+                auto t = utils::msg_data<std::tuple<bool, int, int, int>>(msg);
+                is_success = is_success && std::get<0>(t) && !std::get<2>(t);
+            }
+
+            timer.reset();
+            bc26.send_at_qmtpub(0, 0, 0, false, "topic", "{\"a\":1,\"b\":2}");
+            msg = wait_for(fmq_e_t::bc26_send_at_qmtpub, "qmtpub");
+            is_success =
+                is_success &&
+                std::get<0>(
+                    utils::msg_data<std::tuple<bool, int, int, int>>(msg)) &&
+                emulator.take_sent() == "{\"a\":1,\"b\":2}";
+
+            // 服务器推送的消息内容中包含逗号。
+            timer.reset();
+            emulator.push_mqtt_message(0, 1, "cmd", "a,b");
+            msg = wait_for(fmq_e_t::bc26_mqtt_recv, "qmtrecv");
+            {
+                using param_type =
+                    std::tuple<int, int, std::string, std::string>;
+                auto t = utils::msg_data<param_type>(msg);
+                is_success = is_success && std::get<2>(t) == "cmd" &&
+                             std::get<3>(t) == "a,b";
+            }
+
+            timer.reset();
+            emulator.close_mqtt(0);
+            msg = wait_for(fmq_e_t::bc26_mqtt_stat, "qmtstat");
+            is_success =
+                is_success &&
+                std::get<1>(utils::msg_data<std::tuple<int, int>>(msg)) == 1;
+            report(is_success, "mqtt");
+        }
+
+    public:
+        test_bc26_emulator()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] bc26 emulator test.\n");
+            timer.start();
+
+            test_init();
+            test_socket();
+            test_multi_socket();
+            test_signal();
+            test_dns();
+            test_clock();
+            test_fault();
+            test_recovery();
+            test_mqtt();
+
+            utils::debug_printf("[I] %d commands.\n", emulator.n_commands());
+        }
+    };
+} // namespace test
@@ -0,0 +1,601 @@
+/**
+ * @file nmea_corpus.hpp
+ * @author UnnamedOrange
+ * @brief 供 gps_replay 回放的 GPS 串口数据。
+ *
+ * 没有整段的真实录制，数据由 test_nmea_tokenizer 中录制的一个定位周期
+ * 合成：逐周期修改时间与坐标并重新计算校验和，再加入冷启动、错误与 UBX
+ * 消息。数据块按 9600 波特率的时刻切分，与解析器每次读串口读到的长度相近。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+#include <peripheral/gps/gps_replay.hpp>
+
+namespace test
+{
+    namespace nmea_corpus
+    {
+        using chunk_t = peripheral::gps_replay::chunk_t;
+        using ms = std::chrono::milliseconds;
+
+        /**
+         * @brief NEO-6M 的 5 个定位周期，每秒向北约 1.9 m。
+         * 按 9600 波特率切分为数据块。
+         */
+        inline constexpr chunk_t recorded[] = {
+            {ms(0),
+             std::string_view("$GPRMC,083559.00,A,3150.78220,", 30)},
+            {ms(3),
+             std::string_view("N,11711.92330,E,0.004,77.52,091202,,,A*53", 41)},
+            {ms(7),
+             std::string_view("\r\n$GPVTG,77.52,T,,M,0.004,N,0.008,K,A*06\r\n$G"
+                              "PGGA", 48)},
+            {ms(12),
+             std::string_view(",083559.00,3150.78220,N,11711.92330,E,", 38)},
+            {ms(16),
+             std::string_view("1,08,1.01,499.6,M,48.0,M,,*5C\r\n$GPGSA,A,3,10,0"
+                              "7,05,02,29,04", 59)},
+            {ms(22),
+             std::string_view(",08,13,,,,,1.72,1.03,1.38*0A\r\n$", 31)},
+            {ms(25),
+             std::string_view("GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,29"
+                              "0", 48)},
+            {ms(30),
+             std::string_view(",20,08,54,157,30*70\r\n$GPGSV,3,2,11,02,39,2"
+                              "2", 43)},
+            {ms(35),
+             std::string_view("3,19,13,28,070,17,26,23,252,,04", 31)},
+            {ms(38),
+             std::string_view(",14,186,14*79\r\n$GPGSV,3,3,11,29,09,301,24,16,0"
+                              "9,020,,36,,,*76", 61)},
+            {ms(44),
+             std::string_view("\r\n$GPGLL,3150.78220,N,11711.92330,E,083559"
+                              ".", 43)},
+            {ms(49),
+             std::string_view("00,A,A*6F\r\n", 11)},
+            {ms(1000),
+             std::string_view("$GPRMC,083600.00,A,3150.78320,N,11711.92330,E,0."
+                              "004", 51)},
+            {ms(1005),
+             std::string_view(",77.52,091202,,,A*5D\r\n$GPVTG,77.52,T,,M,0.004,"
+                              "N,0.008,", 54)},
+            {ms(1010),
+             std::string_view("K,A*06\r\n$GPGGA,083600.00,3150.7832", 34)},
+            {ms(1014),
+             std::string_view("0,N,11711.92330,E,1,08,1.01,499.6,M,48.0,M,,*52"
+                              "\r\n$GPGSA,A,3,10,0", 64)},
+            {ms(1021),
+             std::string_view("7,05,02,29,04,08,13,,,,,1.72,1.03,", 34)},
+            {ms(1024),
+             std::string_view("1.38*0A\r\n$GPGSV,3,1,11,10,63,137,17,0", 37)},
+            {ms(1028),
+             std::string_view("7,61,098,15,05,59,290,20,08,54,157,30*70\r\n$GPG"
+                              "SV,3,2,11,02", 58)},
+            {ms(1034),
+             std::string_view(",39,223,19,13,28,070,17,26,23,252,,04,14,186,14*"
+                              "79\r\n$GPGSV,", 59)},
+            {ms(1040),
+             std::string_view("3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n$GPGL"
+                              "L,3", 49)},
+            {ms(1045),
+             std::string_view("150.78320,N,11711.92330,E,083600.00,A,A*61\r"
+                              "\n", 44)},
+            {ms(2000),
+             std::string_view("$GPRMC,083601.00,A,", 19)},
+            {ms(2001),
+             std::string_view("3150.78420,N,11711.92330,E,0.004,77.5", 37)},
+            {ms(2005),
+             std::string_view("2,091202,,,A*5B\r\n$GPVTG,77.52,T,,M,0.004,N,0.0"
+                              "08,K,A*06\r\n$GPGGA,", 64)},
+            {ms(2012),
+             std::string_view("083601.00,3150.78420,N,11711.92330,E,1,08,1.01,4"
+                              "99", 50)},
+            {ms(2017),
+             std::string_view(".6,M,48.0,M,,*54\r\n$GPGSA,A,3,10,07,05,02,29,04"
+                              ",08,13", 52)},
+            {ms(2023),
+             std::string_view(",,,,,1.72,1.03,1.38*0A\r\n$GPGSV,3,1,11,10,63,13"
+                              "7,1", 49)},
+            {ms(2028),
+             std::string_view("7,07,61,098,15,05,59,290,20,08", 30)},
+            {ms(2031),
+             std::string_view(",54,157,30*70\r\n$GPGSV,3,2,11,02,39,223,19,13,2"
+                              "8,070,17,", 55)},
+            {ms(2037),
+             std::string_view("26,23,252,,04,14,186,14*79\r\n$GPGSV,3,3,11,29,0"
+                              "9,301,24,16,09,02", 63)},
+            {ms(2043),
+             std::string_view("0,,36,,,*76\r\n$GPGLL,3150.78420,N,11711.92330,E"
+                              ",083", 50)},
+            {ms(2048),
+             std::string_view("601.00,A,A*67\r\n", 15)},
+            {ms(3000),
+             std::string_view("$GPRMC,083602.00,A,3150.78520,N,11711.92330,E,0."
+                              "004,77.52,091", 61)},
+            {ms(3006),
+             std::string_view("202,,,A*59\r\n$GPVTG,77.52,T,,M,0.", 32)},
+            {ms(3009),
+             std::string_view("004,N,0.008,K,A*06\r\n$GPGGA,083602.00", 36)},
+            {ms(3013),
+             std::string_view(",3150.78520,N,11711.92330,E,1,08,1.01,499.6,M,48"
+                              ".0,M,,*56\r\n$GP", 62)},
+            {ms(3019),
+             std::string_view("GSA,A,3,10,07,05,02,29", 22)},
+            {ms(3022),
+             std::string_view(",04,08,13,,,,,1.72,1.03,1.38*0A\r\n$G", 35)},
+            {ms(3025),
+             std::string_view("PGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,"
+                              "20,08,54,157,3", 62)},
+            {ms(3032),
+             std::string_view("0*70\r\n$GPGSV,3,2,11,02,39,223,19,13,28,070,17,"
+                              "26,23,252,,", 57)},
+            {ms(3038),
+             std::string_view("04,14,186,14*79\r\n$GPGSV,3,3,11,29,09,30"
+                              "1", 40)},
+            {ms(3042),
+             std::string_view(",24,16,09,020,,36,,,*76\r\n$GPGLL,3150.78520,N,1"
+                              "1", 47)},
+            {ms(3047),
+             std::string_view("711.92330,E,083602.00,A,A*65\r\n", 30)},
+            {ms(4000),
+             std::string_view("$GPRMC,083603.00,A,3150.78620,N,11711.92330,E,0."
+                              "004,7", 53)},
+            {ms(4005),
+             std::string_view("7.52,091202,,,A*5B\r\n$GPVTG,77.52", 32)},
+            {ms(4008),
+             std::string_view(",T,,M,0.004,N,0.008,K,A", 23)},
+            {ms(4011),
+             std::string_view("*06\r\n$GPGGA,083603.00,3150.78620,N,11711.92330"
+                              ",E,1,08,1.01,", 59)},
+            {ms(4017),
+             std::string_view("499.6,M,48.0,M,,*54\r\n$GPGSA,A,3,10,07,05,02,29"
+                              ",04,08,", 53)},
+            {ms(4022),
+             std::string_view("13,,,,,1.72,1.03,1.38*0A\r\n$GPGSV,", 33)},
+            {ms(4026),
+             std::string_view("3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08"
+                              ",54,157,30*70", 61)},
+            {ms(4032),
+             std::string_view("\r\n$GPGSV,3,2,11,02,39,223,19,13,28,", 35)},
+            {ms(4036),
+             std::string_view("070,17,26,23,252,,04,14,186,14*79\r\n$GPGS"
+                              "V", 41)},
+            {ms(4040),
+             std::string_view(",3,3,11,29,09,301,24,16,09,020,,3", 33)},
+            {ms(4044),
+             std::string_view("6,,,*76\r\n$GPGLL,3150.78620,N,11711.92330,E,083"
+                              "603.00,A,A", 56)},
+            {ms(4049),
+             std::string_view("*67\r\n", 5)},
+        };
+
+        /**
+         * @brief 冷启动：前 3 个周期未定位，字段为空，之后定位。
+         */
+        inline constexpr chunk_t cold_start[] = {
+            {ms(0),
+             std::string_view("$GPRMC,083559.00,V,,,,,,,091202", 31)},
+            {ms(3),
+             std::string_view(",,,N*77\r\n$GPVTG,,,,,,,,,N*30\r\n$GPGGA,"
+                              "0", 38)},
+            {ms(7),
+             std::string_view("83559.00,,,,,0,00,99.99,,,,,,*64\r\n$GPGSA,A,1,,"
+                              ",,,,,,,,,,,", 57)},
+            {ms(13),
+             std::string_view("99.99,99.99,99.99*30\r\n$GPGSV,1,1,02,10,63,13"
+                              "7", 45)},
+            {ms(17),
+             std::string_view(",,07,61,098,*7B\r\n$GPGLL,,,,,0", 29)},
+            {ms(20),
+             std::string_view("83559.00,V,N*48\r\n", 17)},
+            {ms(1000),
+             std::string_view("$GPRMC,083600.00,V,,,,,,,091202,,,N*78\r\n$GPVTG"
+                              ",", 47)},
+            {ms(1004),
+             std::string_view(",,,,,,,,N*30\r\n$GPGGA,083600.00,,,", 33)},
+            {ms(1008),
+             std::string_view(",,0,00,99.99,,,,,,*6B\r\n$GPGSA,A,1,,,,,,,,,,,,,"
+                              "99.99,99.99,99.", 61)},
+            {ms(1014),
+             std::string_view("99*30\r\n$GPGSV,1,1,02,10,63,", 27)},
+            {ms(1017),
+             std::string_view("137,,07,61,098,*7B\r\n$GPGLL,,", 28)},
+            {ms(1020),
+             std::string_view(",,,083600.00,V,N*47\r", 20)},
+            {ms(1022),
+             std::string_view("\n", 1)},
+            {ms(2000),
+             std::string_view("$GPRMC,083601.00,V,,,,,", 23)},
+            {ms(2002),
+             std::string_view(",,091202,,,N*79\r\n$GPVTG,,,,,,,,,N*30\r\n"
+                              "$", 39)},
+            {ms(2006),
+             std::string_view("GPGGA,083601.00,,,,,0,0", 23)},
+            {ms(2008),
+             std::string_view("0,99.99,,,,,,*6A\r\n$GPGSA,A,1,,,,,,,,,", 37)},
+            {ms(2012),
+             std::string_view(",,,,99.99,99.99,99.99*30\r\n$GPGSV,1,1,02,10,63,"
+                              "137,,07,61,09", 59)},
+            {ms(2018),
+             std::string_view("8,*7B\r\n$GPGLL,,,,,083601.00,V,N*46\r\n", 36)},
+            {ms(3000),
+             std::string_view("$GPRMC,083602.00,A,3150.78220,N,11711.92330,E,0."
+                              "004,77", 54)},
+            {ms(3005),
+             std::string_view(".52,091202,,,A*5E\r\n$GPVTG,77.52,T,,M,0.004,N,0"
+                              ".0", 48)},
+            {ms(3010),
+             std::string_view("08,K,A*06\r\n$GPGGA,083602.00,3150.78220,N,11711"
+                              ".92330,", 53)},
+            {ms(3016),
+             std::string_view("E,1,08,1.01,499.6,M,48.0,M,,*51\r\n$GPGSA,A,3,"
+                              "1", 45)},
+            {ms(3020),
+             std::string_view("0,07,05,02,29,04,08,13,,,,,1.72,1.0", 35)},
+            {ms(3024),
+             std::string_view("3,1.38*0A\r\n$GPGSV,3,1,11,10,63", 30)},
+            {ms(3027),
+             std::string_view(",137,17,07,61,098,15,05,59,290,2", 32)},
+            {ms(3030),
+             std::string_view("0,08,54,157,30*70\r\n$GPGSV,3,2,11,02,39,223,"
+                              "1", 44)},
+            {ms(3035),
+             std::string_view("9,13,28,070,17,26,23,252,,04,14,186,14*7", 40)},
+            {ms(3039),
+             std::string_view("9\r\n$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,"
+                              "*76\r", 50)},
+            {ms(3044),
+             std::string_view("\n$GPGLL,3150.78220,N,11711.92330,E,083602.00,A,"
+                              "A*62\r\n", 53)},
+            {ms(4000),
+             std::string_view("$GPRMC,083603.00,A,3150.78220,N,11711.92330,E,0."
+                              "00", 50)},
+            {ms(4005),
+             std::string_view("4,77.52,091202,,,A*5F\r\n$GPVTG,77.52,T,,M,0.004"
+                              ",N,0.008,K,A*06", 61)},
+            {ms(4011),
+             std::string_view("\r\n$GPGGA,083603.00,3150.78220,N,117", 35)},
+            {ms(4015),
+             std::string_view("11.92330,E,1,08,1.01,499.6,M,48.", 32)},
+            {ms(4018),
+             std::string_view("0,M,,*50\r\n$GPGSA,A,3,10,07,05,02,29,", 36)},
+            {ms(4022),
+             std::string_view("04,08,13,,,,,1.72,1.03,1.", 25)},
+            {ms(4024),
+             std::string_view("38*0A\r\n$GPGSV,3,1,11,10,63,137,17,07,61,09"
+                              "8", 43)},
+            {ms(4029),
+             std::string_view(",15,05,59,290,20,08,54,157,30*70\r", 33)},
+            {ms(4032),
+             std::string_view("\n$GPGSV,3,2,11,02,39,223,19,13,28,070,17,26,23,"
+                              "252,,04,14,186,1", 63)},
+            {ms(4039),
+             std::string_view("4*79\r\n$GPGSV,3,3,", 17)},
+            {ms(4041),
+             std::string_view("11,29,09,301,24,16,09,020,,36,,,*76\r\n$GP"
+                              "G", 41)},
+            {ms(4045),
+             std::string_view("LL,3150.78220,N,11711.92330,E,083603.00,A,A*63\r"
+                              "\n", 48)},
+        };
+
+        /**
+         * @brief 有错误的数据：校验和错误、截断的语句、超长的行、
+         * 伪造的 UBX 帧头、穿插的 UBX 应答、只有 \n 的换行与失去定位。
+         * 第 1、4、7 个周期无效。
+         */
+        inline constexpr chunk_t corrupted[] = {
+            {ms(0),
+             std::string_view("$GPRMC,083559.00,A,3150.78220,N,11711.92330,E,"
+                              "0", 47)},
+            {ms(4),
+             std::string_view(".004,77.52,091202,,,A*53\r\n$GPVTG,77.52,T"
+                              ",", 41)},
+            {ms(9),
+             std::string_view(",M,0.004,N,0.008,K,A*06\r\n$GPG", 29)},
+            {ms(12),
+             std::string_view("GA,083559.00,3150.78220,N,11711.92330", 37)},
+            {ms(16),
+             std::string_view(",E,1,08,1.01,499.6,M,48.0,M,,*5", 31)},
+            {ms(19),
+             std::string_view("C\r\n$GPGSA,A,3,10,07,05,02,2", 27)},
+            {ms(22),
+             std::string_view("9,04,08,13,,,,,1.72,1.03,1", 26)},
+            {ms(24),
+             std::string_view(".38*0A\r\n$GPGSV,3,1,11,10,63,137,17,07,6"
+                              "1", 40)},
+            {ms(28),
+             std::string_view(",098,15,05,59,290,20,08,54,", 27)},
+            {ms(31),
+             std::string_view("157,30*70\r\n$GPGSV,3,2,11,02,39,223,19,13,28,07"
+                              "0,17", 50)},
+            {ms(36),
+             std::string_view(",26,23,252,,04,14,186,14*79\r\n$G", 31)},
+            {ms(40),
+             std::string_view("PGSV,3,3,11,29,0", 16)},
+            {ms(41),
+             std::string_view("9,301,24,16,09,020,,36,,,*76\r\n$GPGLL,3150.78"
+                              "2", 45)},
+            {ms(46),
+             std::string_view("20,N,11711.92330,E,083559.00,A,A*6F\r\n", 37)},
+            {ms(1000),
+             std::string_view("$GPRMC,083600.00,A,3159.78320,N,11711.92330,E,"
+                              "0", 47)},
+            {ms(1004),
+             std::string_view(".004,77.52,091202,,,A*5D\r\n$GPVT", 31)},
+            {ms(1008),
+             std::string_view("G,77.52,T,,M,0.004,N,0.008,K,A*06\r\n$GPGGA,0836"
+                              "00.00,315", 55)},
+            {ms(1013),
+             std::string_view("0.78320,N,11711.92330,E,1,08,1.01,499.6,M,48.0,M"
+                              ",,*52\r\n$GPGS", 60)},
+            {ms(1020),
+             std::string_view("A,A,3,10,07,05,02,29,04,08,1", 28)},
+            {ms(1023),
+             std::string_view("3,,,,,1.72,1.03,", 16)},
+            {ms(1024),
+             std::string_view("1.38*0A\r\n$GPGSV,3,", 18)},
+            {ms(1026),
+             std::string_view("1,11,10,63,137,17,07,61,098,15,05,59,2", 38)},
+            {ms(1030),
+             std::string_view("90,20,08,54,157,30*70", 21)},
+            {ms(1032),
+             std::string_view("\r\n$GPGSV,3,2,11,02,3", 20)},
+            {ms(1034),
+             std::string_view("9,223,19,13,28,070,17,2", 23)},
+            {ms(1037),
+             std::string_view("6,23,252,,04,14,186,14*79\r\n$GPGSV,3", 35)},
+            {ms(1040),
+             std::string_view(",3,11,29,09,301,24,", 19)},
+            {ms(1042),
+             std::string_view("16,09,020,,36,,,*76\r\n$GPGLL,3150.78320,N,11711"
+                              ".92", 49)},
+            {ms(1047),
+             std::string_view("330,E,083600.00,A,A*61\r\n", 24)},
+            {ms(2000),
+             std::string_view("$GPRMC,083601.00,A,3150.78420,N,11711", 37)},
+            {ms(2003),
+             std::string_view(".92330,E,0.004,77.52,091202,,,A*5B\r\n", 36)},
+            {ms(2007),
+             std::string_view("$GPVTG,77.52,T,,M,0.", 20)},
+            {ms(2009),
+             std::string_view("004,N,0.008,K,A*06\r\n$GPGGA,08360", 32)},
+            {ms(2013),
+             std::string_view("1.00,3150.78420,N,11711.92330,E,1,08,1.01,499.6,"
+                              "M,48.", 53)},
+            {ms(2018),
+             std::string_view("0,M,,*54\r\n$GPGSA,A,3,10,07,05,02,29,04,08,13,,"
+                              ",,,1", 50)},
+            {ms(2023),
+             std::string_view(".72,1.03,1.38*0A\r\n$GPGSV,3,1,11,10,63,137,17,0"
+                              "7,61,098,1", 56)},
+            {ms(2029),
+             std::string_view("5,05,59,290,20,08,54,15", 23)},
+            {ms(2031),
+             std::string_view("7,30*70\r\n$GPGSV,3,2,11", 22)},
+            {ms(2034),
+             std::string_view(",02,39,223,19,13,$GPGSV,3,3,11,29,09,30", 39)},
+            {ms(2038),
+             std::string_view("1,24,16,09,020,,36", 18)},
+            {ms(2040),
+             std::string_view(",,,*76\r\n$GPGLL,3150.784", 23)},
+            {ms(2042),
+             std::string_view("20,N,11711.92330,E,083601.00,A,A*67\r\n", 37)},
+            {ms(3000),
+             std::string_view("$GPAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", 38)},
+            {ms(3003),
+             std::string_view("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+                              "A", 44)},
+            {ms(3008),
+             std::string_view("AAAAAAAAAAAAAAAAAAAAAAA", 23)},
+            {ms(3010),
+             std::string_view("AAAAAAAAAAAAAAAAAAAAAAAA", 24)},
+            {ms(3013),
+             std::string_view("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", 36)},
+            {ms(3017),
+             std::string_view("AAAAAAAAAAAAAAAAAAAAAAAAAAA", 27)},
+            {ms(3020),
+             std::string_view("AAAAAAAAAAA\r\n$GPRMC,083602.00,A,3150.78520"
+                              ",", 43)},
+            {ms(3024),
+             std::string_view("N,11711.92330,E,", 16)},
+            {ms(3026),
+             std::string_view("0.004,77.52,091202,,,A*59\r\n$GPVTG,77.52,T,,M,0"
+                              ".004,N,0.008", 58)},
+            {ms(3032),
+             std::string_view(",K,A*06\r\n$GPGGA,083602.", 23)},
+            {ms(3034),
+             std::string_view("00,3150.78520,N,11711.92330,E,1,08,1.01,499.6,M,"
+                              "48", 50)},
+            {ms(3039),
+             std::string_view(".0,M,,*56\r\n$GPGSA,A,3,10,0", 26)},
+            {ms(3042),
+             std::string_view("7,05,02,29,04,08,13,,,,,1.72", 28)},
+            {ms(3045),
+             std::string_view(",1.03,1.38*0A\r\n$GPGSV,3,1,11,10,63,137,17,07,6"
+                              "1,098,15,05", 57)},
+            {ms(3051),
+             std::string_view(",59,290,20,08,54,157,30*7", 25)},
+            {ms(3053),
+             std::string_view("0\r\n$GPGSV,3,2,11,0", 18)},
+            {ms(3055),
+             std::string_view("2,39,223,19,13,28,070,17,26,23,252,,04,14,186"
+                              ",", 46)},
+            {ms(3060),
+             std::string_view("14*79\r\n$GPGSV,3,3,11,29,09,301,24,16,", 37)},
+            {ms(3064),
+             std::string_view("09,020,,36,,,*76\r\n$GPGLL,3150.78520,", 36)},
+            {ms(3068),
+             std::string_view("N,11711.92330,E,083602.00,A,A*65\r\n", 34)},
+            {ms(4000),
+             std::string_view("\xB5\x62\x01\x02\x10\x00\x13\x37\r\n$GPRMC,08360"
+                              "3.00,", 27)},
+            {ms(4002),
+             std::string_view("A,3150.78620,N,11711.92330,E,0.004,77.52,"
+                              "0", 42)},
+            {ms(4007),
+             std::string_view("91202,,,A*5B\r\n$GPVTG,77.52,T,,M,", 32)},
+            {ms(4010),
+             std::string_view("0.004,N,0.008,K,A*06\r\n$GPGGA,083603.00,3150.78"
+                              "620,N,11711.9", 59)},
+            {ms(4016),
+             std::string_view("2330,E,1,08,1.01,499.6,M,48.0,M,,*54\r\n$GPGSA,A"
+                              ",3,10,07,05", 57)},
+            {ms(4022),
+             std::string_view(",02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n$GPGSV,"
+                              "3,", 48)},
+            {ms(4027),
+             std::string_view("1,11,10,63,137,17,07,61,098,15,05,59,290,"
+                              "2", 42)},
+            {ms(4031),
+             std::string_view("0,08,54,157,30*70\r\n$GPGSV,3,2,11,02,39,223,19,"
+                              "13,", 49)},
+            {ms(4037),
+             std::string_view("28,070,17,26,23,252,,04,14,186,14*7", 35)},
+            {ms(4040),
+             std::string_view("9\r\n$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,"
+                              "*76\r\n$GPGL", 56)},
+            {ms(4046),
+             std::string_view("L,3150.78620,N,11711.92330,E,083603.00,A,A*67\r"
+                              "\n", 47)},
+            {ms(5000),
+             std::string_view("$GPRMC,083604.00,", 17)},
+            {ms(5001),
+             std::string_view("A,3150.78720,N,11711.92330,E,0.004,77.52,091202,"
+                              ",,A*5D\r\n$GPVTG,", 63)},
+            {ms(5008),
+             std::string_view("77.52,T,,M,0.004,N,0.008,K,A*06\r\n$GPGGA,083604"
+                              ".00,", 50)},
+            {ms(5013),
+             std::string_view("3150.78720,N,11711.92330,E,", 27)},
+            {ms(5016),
+             std::string_view("1,08,1.01,499.6,M,48.0,M,,*52\r\n\xB5\x62\x05"
+                              "\x01\x02", 36)},
+            {ms(5020),
+             std::string_view("\x00\x06\x01\x0F\x38$GPGSA,A,3,10,07,05,02,29,04"
+                              ",08,13,,,,,1.72,1.03,1.38*0A\r\n", 63)},
+            {ms(5026),
+             std::string_view("$GPGSV,3,1,11,10,63,137", 23)},
+            {ms(5029),
+             std::string_view(",17,07,61,098,15,05,59,290,20,08,54,157,30*70\r"
+                              "\n$GPGSV,3,2,1", 59)},
+            {ms(5035),
+             std::string_view("1,02,39,223,19,13,28,070,17,26,23,252,,04,14,186"
+                              ",14*79\r\n$", 57)},
+            {ms(5041),
+             std::string_view("GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r"
+                              "\n$GPGLL,3150.78720", 64)},
+            {ms(5047),
+             std::string_view(",N,11711.92330,E,083604.00,A,A*61\r\n", 35)},
+            {ms(6000),
+             std::string_view("$GPRMC,083605.00,A,3150.78820,N,11711.92330,E,"
+                              "0", 47)},
+            {ms(6004),
+             std::string_view(".004,77.52,091202,,,A*53\n$GPVTG,77.52,T,,M,0.00"
+                              "4,N,0.008,K,A", 60)},
+            {ms(6011),
+             std::string_view("*06\n$GPGGA,083605.00,3150.78820,N,11711.92330,E"
+                              ",1,08,1.01,499", 61)},
+            {ms(6017),
+             std::string_view(".6,M,48.0,M,,*5C\n$GPGSA,A,3,10,07,05,02,29,04,0"
+                              "8,13,,,,,1.72,1.0", 64)},
+            {ms(6024),
+             std::string_view("3,1.38*0A\n$GPGSV,3,1,11,10,63,137,17,07,61,098,"
+                              "15,05,", 53)},
+            {ms(6029),
+             std::string_view("59,290,20,08,54,157,30*70\n$GPGSV,3,", 35)},
+            {ms(6033),
+             std::string_view("2,11,02,39,223,19,13,28,070,17,26,23,252,,04"
+                              ",", 45)},
+            {ms(6038),
+             std::string_view("14,186,14*79\n$GPGSV,3,3,11,29,09,301,24,16,09,0"
+                              "20,,36,,,*76\n", 60)},
+            {ms(6044),
+             std::string_view("$GPGLL,3150.78820,N,11711.92330,E,0", 35)},
+            {ms(6047),
+             std::string_view("83605.00,A,A*6F\n", 16)},
+            {ms(7000),
+             std::string_view("$GPRMC,083606.00,V,,,,,,,091202,,,N*7E\r\n$"
+                              "G", 42)},
+            {ms(7004),
+             std::string_view("PVTG,,,,,,,,,N*30\r\n$GPGGA,", 26)},
+            {ms(7007),
+             std::string_view("083606.00,,,,,0,00,99.99,,,,,,*6D\r\n$GP", 38)},
+            {ms(7011),
+             std::string_view("GSA,A,1,,,,,,,,,,,,,99.", 23)},
+            {ms(7013),
+             std::string_view("99,99.99,99.99*30\r\n$GPGSV,1,1,02,10,63", 38)},
+            {ms(7017),
+             std::string_view(",137,,07,61,098,*7B\r\n$GPGLL,,,,,083606", 38)},
+            {ms(7021),
+             std::string_view(".00,V,N*41\r\n", 12)},
+        };
+
+        /**
+         * @brief 只输出 UBX 导航消息的 3 个定位周期。
+         */
+        inline constexpr chunk_t ubx_only[] = {
+            {ms(0),
+             std::string_view("\xB5\x62\x01\x02\x1C\x00\x18\x11\x11\x07\x11\x1B"
+                              "\xDB\x45\xD4^\xFB\x12\x10[\x08\x00\x90\x9F\x07"
+                              "\x00\xC4\x09\x00\x00\xA0\x0F\x00\x00\x10\x08\xB5"
+                              "b\x01\x03\x10\x00\x18\x11\x11\x07\x03\r\x00\x00`"
+                              "m\x00\x00\xC0\xD4", 56)},
+            {ms(5),
+             std::string_view("\x01\x00\xC7\x61\xB5\x62\x01\x06\x34\x00\x18\x11"
+                              "\x11\x07\x00\x00\x00\x00\x00\x00\x03\r\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\xAC\x00\x00\x08\x00\x00"
+                              "\x00\x00@", 63)},
+            {ms(12),
+             std::string_view("\x81\xB5\x62\x01!\x14\x00\x18\x11\x11\x07\x32"
+                              "\x00\x00\x00\x00\x00\x00\x00\xD2\x07\x0C\x09\x08"
+                              "#;\x07\x04\xEF", 29)},
+            {ms(1000),
+             std::string_view("\xB5\x62\x01\x02\x1C\x00\x00\x15\x11\x07\x11\x1B"
+                              "\xDB\x45\x0E\x66\xFB\x12\x10[\x08\x00\x90\x9F"
+                              "\x07\x00\xC4\x09\x00\x00\xA0\x0F\x00\x00>\xF4"
+                              "\xB5", 37)},
+            {ms(1003),
+             std::string_view("b\x01\x03\x10\x00\x00\x15\x11\x07\x03\r\x00\x00`"
+                              "m\x00\x00\xC0\xD4\x01\x00\xB3\x1D\xB5\x62\x01"
+                              "\x06\x34\x00\x00\x15\x11\x07\x00\x00\x00\x00\x00"
+                              "\x00\x03\r\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00", 63)},
+            {ms(1010),
+             std::string_view("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xAC\x00"
+                              "\x00\x08\x00\x00\x00\x00,m\xB5\x62\x01!\x14\x00"
+                              "\x00\x15\x11\x07\x32\x00\x00\x00\x00\x00\x00\x00"
+                              "\xD2\x07\x0C\x09\x08#<\x07\xF1]", 48)},
+            {ms(2000),
+             std::string_view("\xB5\x62\x01\x02\x1C\x00\xE8\x18\x11\x07\x11\x1B"
+                              "\xDB\x45Hm\xFB\x12\x10[\x08\x00\x90\x9F\x07\x00"
+                              "\xC4\x09\x00\x00\xA0\x0F\x00\x00j\xB2\xB5\x62"
+                              "\x01\x03\x10\x00\xE8\x18\x11\x07\x03\r\x00\x00`"
+                              "m", 52)},
+            {ms(2005),
+             std::string_view("\x00\x00\xC0\xD4\x01\x00\x9E\xCA\xB5\x62\x01\x06"
+                              "4\x00\xE8\x18", 16)},
+            {ms(2007),
+             std::string_view("\x11\x07\x00\x00\x00\x00\x00\x00\x03\r\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                              "\x00\x00\x00\x00\x00\x00\xAC", 43)},
+            {ms(2011),
+             std::string_view("\x00\x00\x08\x00\x00\x00\x00\x17&\xB5\x62\x01!"
+                              "\x14\x00\xE8\x18\x11\x07\x32\x00\x00\x00\x00\x00"
+                              "\x00\x00\xD2\x07\x0C\x09\x08#=\x07\xDD", 36)},
+            {ms(2015),
+             std::string_view("\xB8", 1)},
+        };
+    } // namespace nmea_corpus
+} // namespace test
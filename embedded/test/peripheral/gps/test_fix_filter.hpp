@@ -0,0 +1,194 @@
+/**
+ * @file test_fix_filter.hpp
+ * @author UnnamedOrange
+ * @brief 测试 peripheral/gps/fix_filter.hpp。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <peripheral/gps/fix_filter.hpp>
+#include <peripheral/gps/nmea_epoch.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+namespace test
+{
+    /**
+     * @brief 测试 fix_filter。
+     * - 静止时带噪声的定位被平滑，且不重复报告。
+     * - 单次跳变被剔除，连续跳变后从新位置重新开始。
+     * - 匀速移动时跟上真实位置。
+     * - 测量每次更新的耗时。
+     */
+    class test_fix_filter
+    {
+    private:
+        using fix_filter = peripheral::fix_filter;
+        using result_t = fix_filter::result_t;
+
+        /**
+         * @brief 起点：北纬 31°50.7822'，东经 117°11.9233'。
+         */
+        static constexpr int32_t origin_latitude = 318463700;
+        static constexpr int32_t origin_longitude = 1171987217;
+        static constexpr uint32_t origin_utc = 1039422959;
+        /**
+         * @brief 起点处 1e-7 度经度对应的长度约为 0.946 cm。
+         */
+        static constexpr int64_t lon_per_m = 106;
+        static constexpr int64_t lat_per_m = 90;
+
+        static peripheral::nmea_position_t make_fix(uint32_t t,
+                                                    int64_t north_m,
+                                                    int64_t east_m)
+        {
+            peripheral::nmea_position_t pos{};
+            pos.latitude =
+                static_cast<int32_t>(origin_latitude + north_m * lat_per_m);
+            pos.longitude =
+                static_cast<int32_t>(origin_longitude + east_m * lon_per_m);
+            pos.utc = origin_utc + t;
+            pos.altitude = INT32_MIN;
+            pos.hdop = 100;
+            pos.is_valid = true;
+            return pos;
+        }
+        /**
+         * @brief 伪随机的噪声，范围为 [-amplitude, amplitude]，单位 m。
+         */
+        static int64_t noise(xorshift& random, int amplitude)
+        {
+            return static_cast<int64_t>(random() % (2 * amplitude + 1)) -
+                   amplitude;
+        }
+
+        static void test_stationary()
+        {
+            constexpr int n_epochs = 50;
+            utils::debug_printf("[-] stationary\n");
+            fix_filter filter;
+            xorshift random;
+            int n_moved = 0;
+            int64_t raw_error = 0;
+            int64_t filtered_error = 0;
+            for (int t = 0; t < n_epochs; t++)
+            {
+                auto pos = make_fix(t, noise(random, 8), noise(random, 8));
+                int64_t error = std::abs(pos.latitude - origin_latitude);
+                n_moved += filter.update(pos) == result_t::moved;
+                // 前几次定位时滤波器尚未收敛，不计入。
+                if (t >= 10)
+                {
+                    raw_error += error;
+                    filtered_error += std::abs(pos.latitude - origin_latitude);
+                }
+            }
+            // 只在开始时报告一次。
+            utils::debug_printf("[I] error: raw %lld, filtered %lld.\n",
+                                static_cast<long long>(raw_error),
+                                static_cast<long long>(filtered_error));
+            report(n_moved == 1 && filtered_error * 4 < raw_error * 3,
+                   "stationary");
+        }
+
+        static void test_outlier()
+        {
+            utils::debug_printf("[-] outlier\n");
+            fix_filter filter;
+            bool is_success = true;
+            uint32_t t = 0;
+            for (; t < 10; t++)
+            {
+                auto pos = make_fix(t, 0, 0);
+                is_success = is_success &&
+                             filter.update(pos) != result_t::rejected;
+            }
+            // 1 s 内跳到 5 km 以外是不可能的。
+            auto jump = make_fix(t++, 5000, 0);
+            is_success = is_success &&
+                         filter.update(jump) == result_t::rejected &&
+                         jump.latitude == origin_latitude + 5000 * lat_per_m;
+            auto back = make_fix(t++, 0, 0);
+            is_success =
+                is_success && filter.update(back) == result_t::unchanged &&
+                std::abs(back.latitude - origin_latitude) < lat_per_m;
+            // 连续的跳变说明确实移动了，例如出隧道后。
+            result_t result{};
+            for (int i = 0; i < gps_filter_max_rejects; i++)
+            {
+                jump = make_fix(t++, 5000, 0);
+                result = filter.update(jump);
+            }
+            is_success = is_success && result == result_t::moved &&
+                         jump.latitude == origin_latitude + 5000 * lat_per_m;
+            report(is_success, "outlier");
+        }
+
+        static void test_moving()
+        {
+            constexpr int n_epochs = 60;
+            constexpr int speed = 10; // 向东 10 m/s。
+            utils::debug_printf("[-] moving\n");
+            fix_filter filter;
+            xorshift random{88172645u};
+            int n_moved = 0;
+            int64_t max_error = 0;
+            for (int t = 0; t < n_epochs; t++)
+            {
+                auto pos =
+                    make_fix(t, noise(random, 5), t * speed + noise(random, 5));
+                n_moved += filter.update(pos) == result_t::moved;
+                if (t >= 10)
+                {
+                    int64_t truth = origin_longitude + t * speed * lon_per_m;
+                    max_error = std::max<int64_t>(
+                        max_error, std::abs(pos.longitude - truth));
+                }
+            }
+            utils::debug_printf("[I] %d reports, max error %lld.\n", n_moved,
+                                static_cast<long long>(max_error));
+            // 每 2 s 移动 20 m，约报告 30 次。误差小于噪声与滞后之和。
+            report(n_moved >= 20 && n_moved <= 35 &&
+                       max_error < 8 * lon_per_m,
+                   "moving");
+        }
+
+        static void test_benchmark()
+        {
+            constexpr int n_round = 1000;
+            utils::debug_printf("[-] benchmark\n");
+            fix_filter filter;
+            xorshift random{123456789u};
+            int n_accepted = 0;
+            uint32_t t = 0;
+            auto time = measure(n_round, [&] {
+                auto pos = make_fix(t++, noise(random, 10), noise(random, 10));
+                n_accepted += filter.update(pos) != result_t::rejected;
+            });
+            utils::debug_printf(
+                "[I] %d updates, %lld us.\n", n_round,
+                static_cast<long long>(time.count()));
+            report(n_accepted == n_round, "benchmark");
+        }
+
+    public:
+        test_fix_filter()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] fix_filter test.\n");
+
+            test_stationary();
+            test_outlier();
+            test_moving();
+            test_benchmark();
+        }
+    };
+} // namespace test
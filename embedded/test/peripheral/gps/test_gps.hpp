@@ -20,6 +20,7 @@
 #include <peripheral/gps/gps.hpp>
 #include <peripheral/gps/nmea_parser.hpp>
 #include <utils/app.hpp>
+#include <utils/civil_time.hpp>
 #include <utils/debug.hpp>
 #include <utils/msg_data.hpp>
 
@@ -34,7 +35,6 @@ namespace test
     {
         peripheral::feedback_message_queue fmq;
         peripheral::gps gps{fmq};
-        mbed::DigitalOut gps_en{PIN_GPS_EN};
 
     public:
         test_gps()
@@ -46,7 +46,6 @@ namespace test
             // 初始化 GPS 模块。
             {
                 utils::debug_printf("[-] Init gps.\n");
-                gps_en = 0;
                 gps.init();
             }
 
@@ -86,16 +85,19 @@ namespace test
                             peripheral::nmea_parser::position_t>(msg);
                         utils::debug_printf("[D] Request.\n");
 
-                        utils::debug_printf("[I] La: %s%s\n",
-                                            pos.latitude.c_str(),
-                                            pos.latitude_semi.c_str());
-                        utils::debug_printf("[I] Lo: %s%s\n",
-                                            pos.longitude.c_str(),
-                                            pos.longitude_semi.c_str());
-                        utils::debug_printf("[I] Date: %02d.%02d.%02d\n",
-                                            pos.year, pos.month, pos.day);
+                        auto t = utils::civil_time::from_epoch(pos.utc);
+                        utils::debug_printf("[I] La: %ld (1e-7 deg)\n",
+                                            static_cast<long>(pos.latitude));
+                        utils::debug_printf("[I] Lo: %ld (1e-7 deg)\n",
+                                            static_cast<long>(pos.longitude));
+                        utils::debug_printf("[I] Date: %04d.%02d.%02d\n",
+                                            t.year, t.month, t.day);
                         utils::debug_printf("[I] Time: %02d:%02d:%02d\n",
-                                            pos.hour, pos.minute, pos.second);
+                                            t.hour, t.minute, t.second);
+                        utils::debug_printf(
+                            "[I] Fix: %d, Sats: %d/%d, HDOP: %d, SNR: %d\n",
+                            pos.fix_type, pos.n_satellites_used,
+                            pos.n_satellites_in_view, pos.hdop, pos.max_snr);
 
                         // 再次等待 GPS 更新位置信息。
                         utils::debug_printf("[-] Request.\n");
@@ -0,0 +1,110 @@
+/**
+ * @file test_gps_aiding.hpp
+ * @author UnnamedOrange
+ * @brief 测试 peripheral/gps/gps_aiding.hpp。
+ *
+ * @note 位置保存在 KVStore 中，只在目标板上运行。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <peripheral/gps/gps_aiding.hpp>
+#include <peripheral/gps/nmea_epoch.hpp>
+#include <peripheral/gps/ubx_codec.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+namespace test
+{
+    /**
+     * @brief 测试 gps_aiding。
+     * - 由位置与时间生成 AID-INI。
+     * - 保存并重放星历。
+     */
+    class test_gps_aiding
+    {
+    private:
+        using gps_aiding = peripheral::gps_aiding;
+        using ubx_codec = peripheral::ubx_codec;
+
+        static void test_ini()
+        {
+            utils::debug_printf("[-] ini\n");
+            gps_aiding aiding("/kv/test");
+            std::array<uint8_t, gps_aiding::ini_length> ini;
+            // 没有位置与时间时不注入。
+            bool is_success = !aiding.make_ini(ini, std::nullopt, 0, 0);
+
+            peripheral::nmea_position_t pos{};
+            pos.latitude = 318463700;
+            pos.longitude = 1171987217;
+            pos.altitude = 4996;
+            pos.is_valid = true;
+            aiding.on_position(pos);
+            // 2002-12-09 08:35:59.250 UTC。
+            is_success = is_success &&
+                         aiding.make_ini(ini, 1039422959250, 1000000, 2000);
+            is_success =
+                is_success &&
+                ubx_codec::read_i4(ini.data()) == 318463700 &&
+                ubx_codec::read_i4(ini.data() + 4) == 1171987217 &&
+                ubx_codec::read_i4(ini.data() + 8) == 49960 &&
+                ubx_codec::read_u<4>(ini.data() + 12) == 1000000 &&
+                ubx_codec::read_u<2>(ini.data() + 18) == 212 &&
+                ubx_codec::read_u<4>(ini.data() + 20) == 9083559 &&
+                ubx_codec::read_u<4>(ini.data() + 24) == 250000000 &&
+                ubx_codec::read_u<4>(ini.data() + 28) == 2000 &&
+                ubx_codec::read_u<4>(ini.data() + 44) == 0x0423;
+            report(is_success, "ini");
+        }
+
+        static void test_ephemeris()
+        {
+            utils::debug_printf("[-] ephemeris\n");
+            gps_aiding aiding("/kv/test");
+            // 5 号卫星有星历，6 号卫星没有。
+            uint8_t eph[gps_aiding::eph_length]{};
+            ubx_codec::write_u<4>(eph, 5);
+            eph[8] = 0x5A;
+            uint8_t empty[8]{};
+            ubx_codec::write_u<4>(empty, 6);
+            bool is_success =
+                aiding.on_frame({ubx_codec::class_aid, ubx_codec::id_aid_eph,
+                                 eph, sizeof(eph)}) &&
+                aiding.on_frame({ubx_codec::class_aid, ubx_codec::id_aid_eph,
+                                 empty, sizeof(empty)}) &&
+                !aiding.on_frame({ubx_codec::class_ack, ubx_codec::id_ack_ack,
+                                  empty, 2});
+            int n_records = 0;
+            aiding.for_each_record(
+                [&](uint8_t id, const uint8_t* data, size_t length) {
+                    n_records++;
+                    is_success = is_success &&
+                                 id == ubx_codec::id_aid_eph &&
+                                 length == sizeof(eph) && data[8] == 0x5A;
+                });
+            report(is_success && n_records == 1 && aiding.needs_almanac(),
+                   "ephemeris");
+        }
+
+    public:
+        test_gps_aiding()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] gps_aiding test.\n");
+
+            test_ini();
+            test_ephemeris();
+        }
+    };
+} // namespace test
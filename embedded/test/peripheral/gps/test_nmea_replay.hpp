@@ -0,0 +1,269 @@
+/**
+ * @file test_nmea_replay.hpp
+ * @author UnnamedOrange
+ * @brief 通过 gps_replay 回放串口数据，测试 peripheral/gps/nmea_parser.hpp。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include <peripheral/gps/gps_replay.hpp>
+#include <peripheral/gps/nmea_parser.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+#include "nmea_corpus.hpp"
+
+namespace test
+{
+    /**
+     * @brief 测试 nmea_parser。
+     * - 尽快回放每份数据，检查定位周期数、有效定位数与最后一次定位。
+     * - 有错误的数据中，错误只影响所在的定位周期。
+     * - 按原始时刻回放一份数据，结果与尽快回放相同。
+     * - 统计解析的吞吐量，以及每种语句的平均耗时。
+     */
+    class test_nmea_replay
+    {
+    private:
+        using gps_replay = peripheral::gps_replay;
+        using nmea_parser = peripheral::nmea_parser;
+        using chunk_t = gps_replay::chunk_t;
+        using position_t = nmea_parser::position_t;
+        using stats_t = nmea_parser::stats_t;
+        using ubx_codec = peripheral::ubx_codec;
+
+        /**
+         * @brief 一份数据的期望结果。
+         */
+        struct golden_t
+        {
+            const char* name;
+            const chunk_t* chunks;
+            size_t n_chunks;
+            uint32_t n_epochs;
+            uint32_t n_valid_epochs;
+            uint32_t n_overflows;
+            uint32_t n_ubx_frames;
+            // 最后一次有效定位。
+            int32_t latitude;
+            int32_t longitude;
+            uint32_t utc;
+        };
+        /**
+         * @brief 数据从 2002-12-09 08:35:59 UTC 开始。
+         */
+        static constexpr uint32_t start_utc = 1039422959;
+        static constexpr int32_t longitude = 1171987217;
+        static constexpr golden_t goldens[] = {
+            {"recorded", nmea_corpus::recorded,
+             std::size(nmea_corpus::recorded), 5, 5, 0, 0, 318464367,
+             longitude, start_utc + 4},
+            {"cold_start", nmea_corpus::cold_start,
+             std::size(nmea_corpus::cold_start), 5, 2, 0, 0, 318463700,
+             longitude, start_utc + 4},
+            {"corrupted", nmea_corpus::corrupted,
+             std::size(nmea_corpus::corrupted), 8, 5, 1, 1, 318464700,
+             longitude, start_utc + 6},
+            {"ubx_only", nmea_corpus::ubx_only,
+             std::size(nmea_corpus::ubx_only), 3, 3, 0, 12, 318467400,
+             longitude, start_utc + 2},
+        };
+
+        /**
+         * @brief 一种消息，以及它在所有数据中的每次出现。
+         */
+        struct message_type_t
+        {
+            const char* name;
+            bool is_ubx;
+            std::vector<std::string_view> messages;
+        };
+
+        /**
+         * @brief 回放一份数据，直到解析器处理完所有的定位周期。
+         *
+         * @param last_valid 输出最后一次有效定位。
+         * @return stats_t 解析的统计信息。
+         */
+        static stats_t replay(const golden_t& golden, bool is_realtime,
+                              position_t& last_valid)
+        {
+            using namespace std::literals;
+            gps_replay replay{golden.chunks, golden.n_chunks, is_realtime};
+            nmea_parser parser{replay};
+            while (!replay.is_finished())
+                rtos::ThisThread::sleep_for(50ms);
+            // 等待串口空闲，结束最后一个定位周期。
+            rtos::ThisThread::sleep_for(100ms);
+            last_valid = parser.get_last_valid_position();
+            return parser.get_stats();
+        }
+        static bool check(const golden_t& golden, const stats_t& stats,
+                          const position_t& last_valid)
+        {
+            bool is_success = stats.n_epochs == golden.n_epochs &&
+                              stats.n_valid_epochs == golden.n_valid_epochs &&
+                              stats.n_overflows == golden.n_overflows &&
+                              stats.n_ubx_frames == golden.n_ubx_frames &&
+                              last_valid.latitude == golden.latitude &&
+                              last_valid.longitude == golden.longitude &&
+                              last_valid.utc == golden.utc;
+            if (!is_success)
+                utils::debug_printf(
+                    "[I] %lu/%lu epochs, %lu overflows, %lu UBX, "
+                    "(%ld, %ld) at %lu.\n",
+                    static_cast<unsigned long>(stats.n_valid_epochs),
+                    static_cast<unsigned long>(stats.n_epochs),
+                    static_cast<unsigned long>(stats.n_overflows),
+                    static_cast<unsigned long>(stats.n_ubx_frames),
+                    static_cast<long>(last_valid.latitude),
+                    static_cast<long>(last_valid.longitude),
+                    static_cast<unsigned long>(last_valid.utc));
+            return is_success;
+        }
+
+        static void test_golden()
+        {
+            utils::debug_printf("[-] golden\n");
+            stats_t total{};
+            for (const auto& golden : goldens)
+            {
+                position_t last_valid;
+                auto stats = replay(golden, false, last_valid);
+                report(check(golden, stats, last_valid), golden.name);
+                total.n_bytes += stats.n_bytes;
+                total.n_sentences += stats.n_sentences;
+                total.n_ubx_frames += stats.n_ubx_frames;
+                total.parse_time += stats.parse_time;
+            }
+
+            // 吞吐量，包括校验、分词与合并。每条消息的耗时见 test_per_type。
+            auto us = static_cast<long long>(total.parse_time.count());
+            auto n_messages = total.n_sentences + total.n_ubx_frames;
+            utils::debug_printf(
+                "[I] %lu bytes, %lu messages, %lld us.\n",
+                static_cast<unsigned long>(total.n_bytes),
+                static_cast<unsigned long>(n_messages), us);
+            if (us)
+                utils::debug_printf("[I] %lld KiB/s.\n",
+                                    total.n_bytes * 1000000ll / 1024 / us);
+        }
+
+        static void test_realtime()
+        {
+            utils::debug_printf("[-] realtime\n");
+            const auto& golden = goldens[0];
+            position_t last_valid;
+            auto stats = replay(golden, true, last_valid);
+            report(check(golden, stats, last_valid), golden.name);
+        }
+
+        /**
+         * @brief 按解析器的方式把字节流拆分为消息，按类型分组。
+         * 行首的同步字符开始一个 UBX 帧，其余为以换行结束的 NMEA 语句。
+         * 校验失败的语句与未知的类型不计入。
+         */
+        static void split_messages(std::string_view stream,
+                                   std::vector<message_type_t>& types)
+        {
+            auto data = reinterpret_cast<const uint8_t*>(stream.data());
+            size_t i = 0;
+            while (i < stream.length())
+            {
+                if (data[i] == ubx_codec::sync_char_1)
+                {
+                    peripheral::ubx_decoder<> decoder;
+                    size_t n_consumed{};
+                    if (decoder.push(data + i, stream.length() - i,
+                                     n_consumed))
+                        types.back().messages.push_back(
+                            stream.substr(i, n_consumed));
+                    i += n_consumed;
+                    continue;
+                }
+                auto end = std::min(stream.find_first_of("\r\n", i),
+                                    stream.length());
+                auto line = stream.substr(i, end - i);
+                i = end + 1;
+                peripheral::nmea_sentence<> sentence{line};
+                if (!sentence.is_valid())
+                    continue;
+                for (auto& type : types)
+                    if (!type.is_ubx && sentence.type() == type.name)
+                        type.messages.push_back(line);
+            }
+        }
+        /**
+         * @brief 每种消息的平均耗时，包括校验、分词与合并到定位周期。
+         * 单条消息的耗时远小于计时器的分辨率，因此重复多轮后取平均。
+         */
+        static void test_per_type()
+        {
+            constexpr int n_round = 100;
+            utils::debug_printf("[-] per type\n");
+            std::vector<message_type_t> types = {
+                {"RMC", false, {}}, {"VTG", false, {}}, {"GGA", false, {}},
+                {"GSA", false, {}}, {"GSV", false, {}}, {"GLL", false, {}},
+                {"UBX", true, {}},
+            };
+            std::string stream;
+            for (const auto& golden : goldens)
+                for (size_t i = 0; i < golden.n_chunks; i++)
+                    stream += golden.chunks[i].data;
+            split_messages(stream, types);
+
+            bool is_success = true;
+            for (const auto& type : types)
+            {
+                is_success = is_success && !type.messages.empty();
+                if (type.messages.empty())
+                    continue;
+                peripheral::nmea_epoch epoch;
+                auto time = measure(n_round, [&] {
+                    for (auto message : type.messages)
+                    {
+                        if (!type.is_ubx)
+                        {
+                            epoch.feed(message);
+                            continue;
+                        }
+                        peripheral::ubx_decoder<> decoder;
+                        size_t n_consumed{};
+                        if (decoder.push(reinterpret_cast<const uint8_t*>(
+                                             message.data()),
+                                         message.length(), n_consumed))
+                            epoch.feed(decoder.frame());
+                    }
+                });
+                auto n_messages = type.messages.size();
+                utils::debug_printf(
+                    "[I] %s: %u messages, %lld ns each.\n", type.name,
+                    static_cast<unsigned>(n_messages),
+                    static_cast<long long>(time.count()) * 1000 /
+                        static_cast<long long>(n_round * n_messages));
+            }
+            report(is_success, "per type");
+        }
+
+    public:
+        test_nmea_replay()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] nmea_parser replay test.\n");
+
+            test_golden();
+            test_realtime();
+            test_per_type();
+        }
+    };
+} // namespace test
@@ -0,0 +1,332 @@
+/**
+ * @file test_nmea_tokenizer.hpp
+ * @author UnnamedOrange
+ * @brief 测试 peripheral/gps/nmea_tokenizer.hpp 与 nmea_epoch.hpp。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <peripheral/gps/nmea_epoch.hpp>
+#include <peripheral/gps/nmea_tokenizer.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+namespace test
+{
+    /**
+     * @brief 测试 nmea_tokenizer。
+     * - 测试典型语句的校验、分词与数字解析。
+     * - 用随机输入测试不变量：结果都在输入之内，字段数不超过上限。
+     * - 测试把一个定位周期的多条语句合并为一条位置信息。
+     * - 在录制的日志上与原先的 std::vector<std::string> 加 sscanf、stoi
+     *   的解析方式比较耗时。
+     */
+    class test_nmea_tokenizer
+    {
+    private:
+        using nmea_field = peripheral::nmea_field;
+        template <size_t max_fields = 24>
+        using nmea_sentence = peripheral::nmea_sentence<max_fields>;
+
+        /**
+         * @brief 录制的一个定位周期的输出。
+         */
+        static constexpr std::string_view recorded_log =
+            "$GPRMC,083559.00,A,3150.78220,N,11711.92330,E,0.004,77.52,"
+            "091202,,,A*53\r\n"
+            "$GPVTG,77.52,T,,M,0.004,N,0.008,K,A*06\r\n"
+            "$GPGGA,083559.00,3150.78220,N,11711.92330,E,1,08,1.01,499.6,M,"
+            "48.0,M,,*5C\r\n"
+            "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n"
+            "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,"
+            "30*70\r\n"
+            "$GPGSV,3,2,11,02,39,223,19,13,28,070,17,26,23,252,,04,14,186,"
+            "14*79\r\n"
+            "$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n"
+            "$GPGLL,3150.78220,N,11711.92330,E,083559.00,A,A*6F\r\n"
+            "$GPRMC,083600.00,V,,,,,,,091202,,,N*78\r\n";
+
+        /**
+         * @brief 依次对日志中的每一行调用 func。
+         */
+        template <typename func_t>
+        static void for_each_line(std::string_view log, func_t&& func)
+        {
+            while (!log.empty())
+            {
+                auto end = log.find("\r\n");
+                if (end == std::string_view::npos)
+                    end = log.length();
+                if (end)
+                    func(log.substr(0, end));
+                log.remove_prefix(std::min(end + 2, log.length()));
+            }
+        }
+
+        static void test_golden()
+        {
+            {
+                utils::debug_printf("[-] RMC\n");
+                nmea_sentence<> sentence{
+                    "$GPRMC,083559.00,A,3150.78220,N,11711.92330,E,0.004,"
+                    "77.52,091202,,,A*53"};
+                int hour{};
+                int year{};
+                report(sentence.is_valid() && sentence.size() == 13 &&
+                           sentence.address() == "GPRMC" &&
+                           sentence.type() == "RMC" && sentence[2] == "A" &&
+                           sentence[3] == "3150.78220" && sentence[10] == "" &&
+                           sentence[13] == "" &&
+                           nmea_field::parse_digits(sentence[1], 0, 2, hour) &&
+                           hour == 8 &&
+                           nmea_field::parse_digits(sentence[9], 4, 2, year) &&
+                           year == 2,
+                       "RMC");
+            }
+            {
+                utils::debug_printf("[-] checksum\n");
+                // 改动一个字符，或校验和不是十六进制数。
+                report(!nmea_sentence<>{"$GPVTG,77.52,T,,M,0.004,N,0.008,K,"
+                                        "B*06"}
+                                .is_valid() &&
+                           !nmea_sentence<>{"$GPVTG,77.52,T,,M,0.004,N,0.008,"
+                                            "K,A*0G"}
+                                .is_valid() &&
+                           !nmea_sentence<>{"GPVTG,77.52*06"}.is_valid() &&
+                           !nmea_sentence<>{"$*00"}.is_valid() &&
+                           nmea_sentence<>{"$GPVTG,77.52,T,,M,0.004,N,0.008,"
+                                           "K,A*06"}
+                               .is_valid(),
+                       "checksum");
+            }
+            {
+                utils::debug_printf("[-] too many fields\n");
+                // 超出的字段被丢弃，但校验和仍然覆盖整条语句。
+                nmea_sentence<4> sentence{
+                    "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A"};
+                report(sentence.size() == 4 && sentence[3] == "10",
+                       "too many fields");
+            }
+            {
+                utils::debug_printf("[-] parse_fixed\n");
+                int32_t value{};
+                bool is_success =
+                    nmea_field::parse_fixed("3150.78220", 4, value) &&
+                    value == 31507822 &&
+                    nmea_field::parse_fixed("-12.3", 2, value) &&
+                    value == -1230 &&
+                    nmea_field::parse_fixed("499", 1, value) && value == 4990 &&
+                    !nmea_field::parse_fixed("", 1, value) &&
+                    !nmea_field::parse_fixed("1.2.3", 1, value) &&
+                    !nmea_field::parse_fixed("99999999999", 0, value);
+                report(is_success, "parse_fixed");
+            }
+            {
+                utils::debug_printf("[-] parse_digits\n");
+                int value{};
+                bool is_success =
+                    nmea_field::parse_digits("091202", 2, 2, value) &&
+                    value == 12 &&
+                    !nmea_field::parse_digits("0912", 2, 4, value) &&
+                    !nmea_field::parse_digits("09a202", 2, 2, value) &&
+                    nmea_field::parse_uint("08", value) && value == 8 &&
+                    !nmea_field::parse_uint("", value);
+                report(is_success, "parse_digits");
+            }
+            {
+                utils::debug_printf("[-] parse_coordinate\n");
+                int32_t value{};
+                bool is_success =
+                    nmea_field::parse_coordinate("3150.78220", "N", value) &&
+                    value == 318463700 &&
+                    nmea_field::parse_coordinate("11711.9233", "W", value) &&
+                    value == -1171987217 &&
+                    nmea_field::parse_coordinate("0000.00001", "S", value) &&
+                    value == -2 &&
+                    !nmea_field::parse_coordinate("3160.00000", "N", value) &&
+                    !nmea_field::parse_coordinate("-3150.7822", "N", value) &&
+                    !nmea_field::parse_coordinate("3150.78220", "", value) &&
+                    !nmea_field::parse_coordinate("", "N", value);
+                report(is_success, "parse_coordinate");
+            }
+        }
+
+        static void test_fuzz()
+        {
+            constexpr int n_round = 2000;
+            constexpr size_t max_fields = 8;
+            // 偏向于出现在 NMEA 语句中的字符。
+            constexpr std::string_view alphabet = "$$,,,**..GPRMC0123456789AF";
+            xorshift next_random;
+
+            utils::debug_printf("[-] fuzz\n");
+            bool is_success = true;
+            char input[64];
+            for (int round = 0; round < n_round && is_success; round++)
+            {
+                size_t length = next_random() % sizeof(input);
+                for (size_t i = 0; i < length; i++)
+                {
+                    // 偶尔混入任意字节。
+                    uint32_t r = next_random();
+                    input[i] = r & 0x100 ? alphabet[r % alphabet.length()]
+                                         : static_cast<char>(r);
+                }
+                std::string_view view(input, length);
+                nmea_sentence<max_fields> sentence{view};
+                auto inside = [view](std::string_view part) {
+                    return part.empty() ||
+                           (part.data() >= view.data() &&
+                            part.data() + part.length() <=
+                                view.data() + view.length());
+                };
+                is_success = sentence.size() <= max_fields;
+                for (size_t i = 0; i <= sentence.size(); i++)
+                {
+                    int value{};
+                    int32_t fixed{};
+                    // 解析数字不应越界。
+                    nmea_field::parse_digits(sentence[i], 4, 2, value);
+                    nmea_field::parse_fixed(sentence[i], 4, fixed);
+                    is_success = is_success && inside(sentence[i]) &&
+                                 sentence[i].find(',') ==
+                                     std::string_view::npos;
+                }
+            }
+            report(is_success, "fuzz");
+        }
+
+        static void test_epoch()
+        {
+            utils::debug_printf("[-] epoch\n");
+            peripheral::nmea_epoch epoch;
+            int n_completed = 0;
+            bool is_success = true;
+            for_each_line(recorded_log, [&](std::string_view line) {
+                if (!epoch.feed(line))
+                    return;
+                // 下一个周期的 RMC 结束了录制的周期。
+                n_completed++;
+                const auto& pos = epoch.completed();
+                // 2002-12-09 08:35:59 UTC。
+                is_success =
+                    is_success && pos.is_valid && pos.utc == 1039422959 &&
+                    pos.latitude == 318463700 && pos.longitude == 1171987217 &&
+                    pos.speed == 0 && pos.course == 775 &&
+                    pos.fix_quality == 1 &&
+                    pos.fix_type == 3 && pos.n_satellites_used == 8 &&
+                    pos.n_satellites_in_view == 11 && pos.max_snr == 30 &&
+                    pos.hdop == 103 && pos.pdop == 172 && pos.vdop == 138 &&
+                    pos.altitude == 4996;
+            });
+            // 串口空闲时结束只有 RMC 的无效周期，其余字段未知。
+            is_success = is_success && n_completed == 1 && epoch.flush() &&
+                         !epoch.completed().is_valid &&
+                         epoch.completed().fix_type == -1 &&
+                         epoch.completed().hdop == -1 && !epoch.flush();
+            report(is_success, "epoch");
+        }
+
+        /**
+         * @brief 原先的分词方式。
+         */
+        static std::vector<std::string> legacy_split(std::string_view frame)
+        {
+            std::vector<std::string> ret;
+            if (frame.length() < 3 || frame[0] != '$' ||
+                frame[frame.length() - 3] != '*')
+                return ret;
+            int desired_check_sum;
+            std::string last_two{frame.substr(frame.length() - 2)};
+            if (1 != sscanf(last_two.c_str(), "%x", &desired_check_sum))
+                return ret;
+            std::string_view middle = frame.substr(1, frame.length() - 4);
+            int check_sum = std::accumulate(middle.begin(), middle.end(),
+                                            int{}, std::bit_xor<int>{});
+            if (desired_check_sum != check_sum)
+                return ret;
+            std::string buf;
+            for (char ch : frame)
+            {
+                if (ch == ',' || ch == '*')
+                {
+                    ret.push_back(std::move(buf));
+                    buf.clear();
+                    if (ch == '*')
+                        break;
+                }
+                else
+                    buf.push_back(ch);
+            }
+            return ret;
+        }
+        static void test_benchmark()
+        {
+            constexpr int n_round = 200;
+
+            utils::debug_printf("[-] benchmark\n");
+            int checksum = 0;
+
+            // 原先的方式：每条语句分配字符串数组，时间用 stoi 解析。
+            auto legacy_time = measure(n_round, [&] {
+                for_each_line(recorded_log, [&checksum](std::string_view line) {
+                    auto parts = legacy_split(line);
+                    if (parts.empty())
+                        return;
+                    checksum += static_cast<int>(parts.size());
+                    if (parts[0] == "$GPRMC" && parts[2] == "A")
+                        checksum += std::stoi(parts[1].substr(2, 2)) +
+                                    std::stoi(parts[9].substr(4, 2));
+                });
+            });
+
+            auto tokenizer_time = measure(n_round, [&] {
+                for_each_line(recorded_log, [&checksum](std::string_view line) {
+                    nmea_sentence<> sentence{line};
+                    if (!sentence.is_valid())
+                        return;
+                    checksum -= static_cast<int>(sentence.size());
+                    int minute{};
+                    int year{};
+                    if (sentence.type() == "RMC" && sentence[2] == "A" &&
+                        nmea_field::parse_digits(sentence[1], 2, 2, minute) &&
+                        nmea_field::parse_digits(sentence[9], 4, 2, year))
+                        checksum -= minute + year;
+                });
+            });
+
+            utils::debug_printf(
+                "[I] vector + sscanf: %lld us, tokenizer: %lld us.\n",
+                static_cast<long long>(legacy_time.count()),
+                static_cast<long long>(tokenizer_time.count()));
+            report(!checksum && tokenizer_time < legacy_time, "benchmark");
+        }
+
+    public:
+        test_nmea_tokenizer()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] nmea_tokenizer test.\n");
+
+            test_golden();
+            test_fuzz();
+            test_epoch();
+            test_benchmark();
+        }
+    };
+} // namespace test
@@ -0,0 +1,296 @@
+/**
+ * @file test_ubx_codec.hpp
+ * @author UnnamedOrange
+ * @brief 测试 peripheral/gps/ubx_codec.hpp。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <peripheral/gps/nmea_epoch.hpp>
+#include <peripheral/gps/ubx_codec.hpp>
+#include <test/test_utils.hpp>
+#include <utils/debug.hpp>
+
+namespace test
+{
+    /**
+     * @brief 测试 ubx_codec。
+     * - 与手册中的帧比较编码结果，解码 ACK。
+     * - 用随机输入测试不变量：任意输入之后，解码器都能重新同步，
+     *   整段输入与逐字节输入的结果相同。
+     * - 把一个定位周期的 NAV 消息合并为位置信息。
+     * - 与内容相同的 NMEA 语句比较字节数与解析耗时。
+     */
+    class test_ubx_codec
+    {
+    private:
+        using ubx_codec = peripheral::ubx_codec;
+        template <size_t max_payload = 128>
+        using ubx_decoder = peripheral::ubx_decoder<max_payload>;
+
+        /**
+         * @brief 一个定位周期的 UBX 消息，由 make_epoch 生成。
+         * 内容与 nmea_log 相同：2002-12-09 08:35:59 UTC，北纬 31°50.7822'，
+         * 东经 117°11.9233'，三维定位，8 颗卫星。
+         */
+        struct epoch_stream_t
+        {
+            std::array<uint8_t, 256> data;
+            size_t size;
+        };
+        /**
+         * @brief 内容相同的 NMEA 语句。
+         */
+        static constexpr std::string_view nmea_log =
+            "$GPRMC,083559.00,A,3150.78220,N,11711.92330,E,0.004,77.52,"
+            "091202,,,A*53\r\n"
+            "$GPGGA,083559.00,3150.78220,N,11711.92330,E,1,08,1.01,499.6,M,"
+            "48.0,M,,*5C\r\n"
+            "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n";
+
+        static void append(epoch_stream_t& stream, uint8_t cls, uint8_t id,
+                           const uint8_t* payload, size_t length)
+        {
+            stream.size += ubx_codec::encode(
+                cls, id, payload, length, stream.data.data() + stream.size,
+                stream.data.size() - stream.size);
+        }
+        static epoch_stream_t make_epoch(uint32_t itow)
+        {
+            epoch_stream_t stream{};
+            {
+                uint8_t p[28]{};
+                ubx_codec::write_u<4>(p, itow);
+                ubx_codec::write_u<4>(p + 4, 1171987217); // 经度。
+                ubx_codec::write_u<4>(p + 8, 318463700);  // 纬度。
+                ubx_codec::write_u<4>(p + 12, 547600);    // 椭球高。
+                ubx_codec::write_u<4>(p + 16, 499600);    // 海拔。
+                ubx_codec::write_u<4>(p + 20, 2500);      // 水平精度。
+                ubx_codec::write_u<4>(p + 24, 4000);      // 垂直精度。
+                append(stream, ubx_codec::class_nav, ubx_codec::id_nav_posllh,
+                       p, sizeof(p));
+            }
+            {
+                uint8_t p[16]{};
+                ubx_codec::write_u<4>(p, itow);
+                p[4] = 3;    // 三维定位。
+                p[5] = 0x0D; // gpsFixOk、周数有效、周内时间有效。
+                ubx_codec::write_u<4>(p + 8, 28000);
+                ubx_codec::write_u<4>(p + 12, 120000);
+                append(stream, ubx_codec::class_nav, ubx_codec::id_nav_status,
+                       p, sizeof(p));
+            }
+            {
+                uint8_t p[52]{};
+                ubx_codec::write_u<4>(p, itow);
+                p[10] = 3;
+                p[11] = 0x0D;
+                ubx_codec::write_u<2>(p + 44, 172); // PDOP。
+                p[47] = 8;                          // 卫星数。
+                append(stream, ubx_codec::class_nav, ubx_codec::id_nav_sol, p,
+                       sizeof(p));
+            }
+            {
+                uint8_t p[20]{};
+                ubx_codec::write_u<4>(p, itow);
+                ubx_codec::write_u<2>(p + 12, 2002);
+                p[14] = 12;
+                p[15] = 9;
+                p[16] = 8;
+                p[17] = 35;
+                p[18] = 59;
+                p[19] = 0x07; // UTC 时间有效。
+                append(stream, ubx_codec::class_nav, ubx_codec::id_nav_timeutc,
+                       p, sizeof(p));
+            }
+            return stream;
+        }
+
+        static void test_golden()
+        {
+            {
+                utils::debug_printf("[-] encode\n");
+                // 手册中打开 NAV-POSLLH 输出的 CFG-MSG。
+                constexpr uint8_t expected[] = {0xB5, 0x62, 0x06, 0x01,
+                                                0x03, 0x00, 0x01, 0x02,
+                                                0x01, 0x0E, 0x47};
+                const uint8_t payload[] = {0x01, 0x02, 0x01};
+                uint8_t buffer[16];
+                size_t size = ubx_codec::encode(0x06, 0x01, payload, 3, buffer,
+                                                sizeof(buffer));
+                bool is_success = size == sizeof(expected);
+                for (size_t i = 0; i < size && is_success; i++)
+                    is_success = buffer[i] == expected[i];
+                // 缓冲区不够时不编码。
+                is_success = is_success && !ubx_codec::encode(0x06, 0x01,
+                                                              payload, 3,
+                                                              buffer, 10);
+                report(is_success, "encode");
+            }
+            {
+                utils::debug_printf("[-] ack\n");
+                constexpr uint8_t ack[] = {0xB5, 0x62, 0x05, 0x01, 0x02,
+                                           0x00, 0x06, 0x01, 0x0F, 0x38};
+                ubx_decoder<> decoder;
+                int n_frames = 0;
+                peripheral::ubx_ack_t result{};
+                for (auto byte : ack)
+                    if (decoder.push(byte) &&
+                        peripheral::ubx_ack_t::decode(decoder.frame(), result))
+                        n_frames++;
+                // 改动校验和后不应解码。
+                bool is_corrupted_decoded = false;
+                for (size_t i = 0; i < sizeof(ack); i++)
+                    is_corrupted_decoded =
+                        decoder.push(i + 1 == sizeof(ack) ? 0x39 : ack[i]) ||
+                        is_corrupted_decoded;
+                report(n_frames == 1 && result.is_ack && result.cls == 0x06 &&
+                           result.id == 0x01 && !is_corrupted_decoded &&
+                           !decoder.is_busy(),
+                       "ack");
+            }
+        }
+
+        static void test_fuzz()
+        {
+            constexpr int n_round = 500;
+            constexpr size_t max_payload = 32;
+            xorshift next_random;
+            constexpr uint8_t ack[] = {0xB5, 0x62, 0x05, 0x01, 0x02,
+                                       0x00, 0x06, 0x01, 0x0F, 0x38};
+
+            utils::debug_printf("[-] fuzz\n");
+            bool is_success = true;
+            for (int round = 0; round < n_round && is_success; round++)
+            {
+                ubx_decoder<max_payload> decoder;
+                ubx_decoder<max_payload> bulk_decoder;
+                uint8_t input[256];
+                size_t length = next_random() % sizeof(input);
+                for (size_t i = 0; i < length; i++)
+                {
+                    // 偏向于出现同步字符。
+                    uint32_t r = next_random();
+                    input[i] = r & 0x100 ? (r & 1 ? 0xB5 : 0x62)
+                                         : static_cast<uint8_t>(r);
+                }
+                int n_received = 0;
+                for (size_t i = 0; i < length; i++)
+                    if (decoder.push(input[i]))
+                    {
+                        n_received++;
+                        is_success =
+                            is_success && decoder.frame().length <= max_payload;
+                    }
+                // 整段输入与逐字节输入的结果相同。
+                size_t n_consumed{};
+                for (size_t i = 0; i < length; i += n_consumed)
+                    n_received -= bulk_decoder.push(input + i, length - i,
+                                                    n_consumed);
+                is_success = is_success && !n_received &&
+                             bulk_decoder.is_busy() == decoder.is_busy();
+                // 输入足够多的非同步字符后，解码器一定回到空闲状态，
+                // 之后的帧能被正确解码。
+                for (size_t i = 0; i < max_payload + ubx_codec::overhead; i++)
+                    decoder.push(0x00);
+                int n_frames = 0;
+                for (auto byte : ack)
+                    n_frames += decoder.push(byte);
+                is_success = is_success && n_frames == 1;
+            }
+            report(is_success, "fuzz");
+        }
+
+        static void test_epoch()
+        {
+            utils::debug_printf("[-] epoch\n");
+            peripheral::nmea_epoch epoch;
+            ubx_decoder<> decoder;
+            auto first = make_epoch(118559000);
+            auto second = make_epoch(118560000);
+            int n_completed = 0;
+            for (size_t i = 0; i < first.size; i++)
+                if (decoder.push(first.data[i]))
+                    n_completed += epoch.feed(decoder.frame());
+            // 下一个周期的第一条消息结束了上一个周期。
+            for (size_t i = 0; i < second.size; i++)
+                if (decoder.push(second.data[i]))
+                    n_completed += epoch.feed(decoder.frame());
+            const auto& pos = epoch.completed();
+            // 2002-12-09 08:35:59 UTC。
+            report(n_completed == 1 && pos.is_valid &&
+                       pos.utc == 1039422959 && pos.latitude == 318463700 &&
+                       pos.longitude == 1171987217 && pos.altitude == 4996 &&
+                       pos.fix_type == 3 && pos.fix_quality == 1 &&
+                       pos.n_satellites_used == 8 && pos.pdop == 172 &&
+                       epoch.flush() && epoch.completed().is_valid,
+                   "epoch");
+        }
+
+        static void test_benchmark()
+        {
+            constexpr int n_round = 200;
+
+            utils::debug_printf("[-] benchmark\n");
+            int checksum = 0;
+            auto stream = make_epoch(118559000);
+
+            auto nmea_time = measure(n_round, [&] {
+                peripheral::nmea_epoch epoch;
+                std::string_view log = nmea_log;
+                while (!log.empty())
+                {
+                    auto end = log.find("\r\n");
+                    epoch.feed(log.substr(0, end));
+                    log.remove_prefix(end + 2);
+                }
+                epoch.flush();
+                checksum += epoch.completed().n_satellites_used;
+            });
+
+            auto ubx_time = measure(n_round, [&] {
+                peripheral::nmea_epoch epoch;
+                ubx_decoder<> decoder;
+                size_t n_consumed{};
+                for (size_t j = 0; j < stream.size; j += n_consumed)
+                    if (decoder.push(stream.data.data() + j, stream.size - j,
+                                     n_consumed))
+                        epoch.feed(decoder.frame());
+                epoch.flush();
+                checksum -= epoch.completed().n_satellites_used;
+            });
+
+            utils::debug_printf(
+                "[I] NMEA: %u bytes, %lld us. UBX: %u bytes, %lld us.\n",
+                static_cast<unsigned>(nmea_log.length()),
+                static_cast<long long>(nmea_time.count()),
+                static_cast<unsigned>(stream.size),
+                static_cast<long long>(ubx_time.count()));
+            report(!checksum && stream.size < nmea_log.length() &&
+                       ubx_time < nmea_time,
+                   "benchmark");
+        }
+
+    public:
+        test_ubx_codec()
+        {
+            utils::debug_printf("\n");
+            utils::debug_printf("[I] ubx_codec test.\n");
+
+            test_golden();
+            test_fuzz();
+            test_epoch();
+            test_benchmark();
+        }
+    };
+} // namespace test
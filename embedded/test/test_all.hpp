@@ -11,7 +11,14 @@
 
 #include <utils/app.hpp>
 
+#include "peripheral/bc26/test_at_tokenizer.hpp"
+#include "peripheral/bc26/test_bc26_emulator.hpp"
 #include "peripheral/buzzer/test_buzzer.hpp"
+#include "peripheral/gps/test_fix_filter.hpp"
+#include "peripheral/gps/test_gps_aiding.hpp"
+#include "peripheral/gps/test_nmea_replay.hpp"
+#include "peripheral/gps/test_nmea_tokenizer.hpp"
+#include "peripheral/gps/test_ubx_codec.hpp"
 #include "peripheral/test_feedback_message_queue.hpp"
 #include "peripheral/test_peripheral_std_framework.hpp"
 #include "peripheral/test_peripheral_thread.hpp"
@@ -28,7 +35,14 @@ namespace test
     inline void test_all()
     {
         // 在此处添加要测试的 app 类。
+        utils::run_app<test_at_tokenizer>();
+        utils::run_app<test_bc26_emulator>();
         utils::run_app<test_buzzer>();
+        utils::run_app<test_fix_filter>();
+        utils::run_app<test_gps_aiding>();
+        utils::run_app<test_nmea_replay>();
+        utils::run_app<test_nmea_tokenizer>();
+        utils::run_app<test_ubx_codec>();
         utils::run_app<test_feedback_message_queue>();
         utils::run_app<test_peripheral_thread>();
         utils::run_app<test_peripheral_std_framework>();
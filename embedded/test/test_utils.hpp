@@ -0,0 +1,87 @@
+/**
+ * @file test_utils.hpp
+ * @author UnnamedOrange
+ * @brief 测试共用的工具函数：输出结果、生成伪随机数、计时。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include <utils/debug.hpp>
+
+namespace test
+{
+    namespace details
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+        inline int _n_failed{};
+#pragma GCC diagnostic pop
+    } // namespace details
+
+    /**
+     * @brief 输出一项测试的结果，并记录失败的项数。
+     *
+     * @param is_success 是否通过。
+     * @param name 测试项的名称。
+     */
+    inline void report(bool is_success, const char* name)
+    {
+        utils::debug_printf("[%c] %s\n", is_success ? 'D' : 'F', name);
+        details::_n_failed += !is_success;
+    }
+    /**
+     * @brief 到目前为止失败的测试项数。
+     */
+    inline int n_failed()
+    {
+        return details::_n_failed;
+    }
+
+    /**
+     * @brief 伪随机数生成器（xorshift32）。种子相同时序列相同，
+     * 便于复现模糊测试中的失败。
+     */
+    class xorshift
+    {
+    private:
+        uint32_t _state;
+
+    public:
+        /**
+         * @param seed 种子，不能为 0。
+         */
+        xorshift(uint32_t seed = 2463534242u) : _state(seed)
+        {
+        }
+
+        uint32_t operator()()
+        {
+            _state ^= _state << 13;
+            _state ^= _state >> 17;
+            _state ^= _state << 5;
+            return _state;
+        }
+    };
+
+    /**
+     * @brief 重复执行 n_round 次 func，返回总耗时。
+     */
+    template <typename func_t>
+    std::chrono::microseconds measure(int n_round, func_t&& func)
+    {
+        mbed::Timer timer;
+        timer.start();
+        for (int i = 0; i < n_round; i++)
+            func();
+        timer.stop();
+        return timer.elapsed_time();
+    }
+} // namespace test
@@ -0,0 +1,95 @@
+/**
+ * @file civil_time.hpp
+ * @author UnnamedOrange
+ * @brief 公历日期与 UNIX 时间戳的互相转换。不依赖 Mbed。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace utils
+{
+    /**
+     * @brief 公历日期与 UNIX 时间戳的互相转换。均为 constexpr，不查表。
+     */
+    class civil_time
+    {
+    public:
+        /**
+         * @brief 日期与时间。
+         */
+        struct date_time_t
+        {
+            int year;   // 四位年份。
+            int month;  // 1-12。
+            int day;    // 1-31。
+            int hour;   // 0-23。
+            int minute; // 0-59。
+            int second; // 0-59。
+        };
+
+    public:
+        /**
+         * @brief 公历日期到 1970-01-01 的天数。
+         */
+        static constexpr int64_t days_from_civil(int year, int month, int day)
+        {
+            // 以 3 月为一年的开始，闰日位于年末。
+            year -= month <= 2;
+            int64_t era = (year >= 0 ? year : year - 399) / 400;
+            int64_t year_of_era = year - era * 400;
+            int64_t day_of_year =
+                (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+            int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+                                 year_of_era / 100 + day_of_year;
+            return era * 146097 + day_of_era - 719468;
+        }
+        /**
+         * @brief 日期与时间转换为 UNIX 时间戳，单位 s。
+         */
+        static constexpr int64_t to_epoch(const date_time_t& t)
+        {
+            return days_from_civil(t.year, t.month, t.day) * 86400 +
+                   t.hour * 3600 + t.minute * 60 + t.second;
+        }
+        /**
+         * @brief UNIX 时间戳转换为日期与时间。
+         *
+         * @param epoch UNIX 时间戳，单位 s。
+         */
+        static constexpr date_time_t from_epoch(int64_t epoch)
+        {
+            int64_t days = epoch / 86400;
+            int64_t seconds = epoch % 86400;
+            if (seconds < 0)
+            {
+                seconds += 86400;
+                days--;
+            }
+            days += 719468;
+            int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            int64_t day_of_era = days - era * 146097;
+            int64_t year_of_era =
+                (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+                 day_of_era / 146096) /
+                365;
+            int64_t day_of_year = day_of_era - (365 * year_of_era +
+                                                year_of_era / 4 -
+                                                year_of_era / 100);
+            int64_t mp = (5 * day_of_year + 2) / 153;
+            int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+            date_time_t ret{};
+            ret.year = static_cast<int>(year_of_era + era * 400 + (month <= 2));
+            ret.month = month;
+            ret.day = static_cast<int>(day_of_year - (153 * mp + 2) / 5 + 1);
+            ret.hour = static_cast<int>(seconds / 3600);
+            ret.minute = static_cast<int>(seconds / 60 % 60);
+            ret.second = static_cast<int>(seconds % 60);
+            return ret;
+        }
+    };
+} // namespace utils
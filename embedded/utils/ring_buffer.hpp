@@ -0,0 +1,160 @@
+/**
+ * @file ring_buffer.hpp
+ * @author UnnamedOrange
+ * @brief 字节环形缓冲区。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace utils
+{
+    /**
+     * @brief 字节环形缓冲区。存储空间由调用者提供。
+     * 写满后不再写入，不覆盖未读出的数据。
+     *
+     * @note 这个类是线程安全的。
+     */
+    class ring_buffer
+    {
+    private:
+        rtos::Mutex _mutex;
+        char* _data;
+        size_t _capacity;
+        // 最早的未读出字节的位置。
+        size_t _head{};
+        // 未读出的字节数。
+        size_t _size{};
+
+    public:
+        /**
+         * @param storage 存储空间。生命周期应长于该对象。
+         * @param capacity 存储空间的大小。
+         */
+        ring_buffer(char* storage, size_t capacity)
+            : _data(storage), _capacity(capacity)
+        {
+        }
+        ring_buffer(const ring_buffer&) = delete;
+        ring_buffer& operator=(const ring_buffer&) = delete;
+
+    public:
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+        /**
+         * @brief 未读出的字节数。
+         */
+        size_t size()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _size;
+        }
+        /**
+         * @brief 还能写入的字节数。
+         */
+        size_t free_space()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _capacity - _size;
+        }
+        bool empty()
+        {
+            return !size();
+        }
+        void clear()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            _head = 0;
+            _size = 0;
+        }
+
+    public:
+        /**
+         * @brief 写入数据。空间不足时只写入能写入的部分。
+         *
+         * @return size_t 实际写入的字节数。
+         */
+        size_t write(const char* data, size_t length)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            length = std::min(length, _capacity - _size);
+            for (size_t i = 0; i < length; i++)
+                _data[(_head + _size + i) % _capacity] = data[i];
+            _size += length;
+            return length;
+        }
+        /**
+         * @brief 读出数据。
+         *
+         * @param out 读出的数据。
+         * @param max_length 至多读出的字节数。
+         * @return size_t 实际读出的字节数。
+         */
+        size_t read(char* out, size_t max_length)
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            size_t length = std::min(max_length, _size);
+            for (size_t i = 0; i < length; i++)
+                out[i] = _data[(_head + i) % _capacity];
+            _head = (_head + length) % _capacity;
+            _size -= length;
+            return length;
+        }
+        /**
+         * @brief 读出所有数据。
+         */
+        std::string read_all()
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            std::string ret(_size, '\0');
+            for (size_t i = 0; i < _size; i++)
+                ret[i] = _data[(_head + i) % _capacity];
+            _head = 0;
+            _size = 0;
+            return ret;
+        }
+    };
+
+    namespace details
+    {
+        /**
+         * @brief 保证存储空间先于 ring_buffer 构造。
+         */
+        template <size_t buffer_size>
+        struct ring_buffer_storage
+        {
+            std::array<char, buffer_size> _storage;
+        };
+    } // namespace details
+
+    /**
+     * @brief 自带存储空间的字节环形缓冲区。
+     *
+     * @tparam buffer_size 缓冲区的大小。
+     */
+    template <size_t buffer_size>
+    class static_ring_buffer
+        : private details::ring_buffer_storage<buffer_size>,
+          public ring_buffer
+    {
+    private:
+        using storage_t = details::ring_buffer_storage<buffer_size>;
+
+    public:
+        static_ring_buffer()
+            : ring_buffer(storage_t::_storage.data(), buffer_size)
+        {
+        }
+    };
+} // namespace utils
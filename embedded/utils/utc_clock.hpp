@@ -0,0 +1,215 @@
+/**
+ * @file utc_clock.hpp
+ * @author UnnamedOrange
+ * @brief UTC 时钟。由网络时间或 GPS 校准，在两次校准之间按 Kernel::Clock 走时。
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include "mbed.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+
+#include "civil_time.hpp"
+
+namespace utils
+{
+    /**
+     * @brief UTC 时钟。
+     *
+     * 记录最近一次校准时 Kernel::Clock 与 UTC 的对应关系，之后的时间由
+     * Kernel::Clock 推算，读取时不需要访问外设。两次 GPS 校准间隔足够长时，
+     * 根据两者的 UTC 与本地时钟之差估计本地晶振的频偏，之后推算时加以补偿。
+     *
+     * GPS 的时间比网络时间准确。GPS 校准后的一段时间内忽略网络时间。
+     *
+     * @note 该类是线程安全的。
+     */
+    class utc_clock
+    {
+    public:
+        using clock = Kernel::Clock;
+
+        /**
+         * @brief 时间的来源。按准确程度排序。
+         */
+        enum class source_t
+        {
+            /**
+             * @brief 未校准。
+             */
+            none,
+            /**
+             * @brief 网络时间。来自 AT+CCLK? 或 NITZ。
+             */
+            network,
+            /**
+             * @brief GPS 时间。
+             */
+            gps,
+        };
+
+        /**
+         * @brief GPS 校准后忽略网络时间的时长。
+         */
+        static constexpr auto gps_holdover = std::chrono::hours(1);
+        /**
+         * @brief 估计频偏所需的两次 GPS 校准的最短间隔。
+         * 网络时间只精确到 1 s，30 min 内就相当于 500 ppm 以上，
+         * 远大于晶振常见的 20-50 ppm 的频偏，因此不用于估计频偏。
+         * GPS 语句到达的时延有数十毫秒的抖动，间隔 2 h 时误差在 10 ppm 以内。
+         */
+        static constexpr auto min_discipline_interval = std::chrono::hours(2);
+        /**
+         * @brief 频偏估计的上限，单位 ppm。超过时认为是校准出错。
+         */
+        static constexpr int32_t max_drift_ppm = 500;
+
+    private:
+        mutable rtos::Mutex _mutex;
+        source_t _source{source_t::none};
+        /**
+         * @brief 校准时 Kernel::Clock 的时刻。
+         */
+        clock::time_point _sync_time{};
+        /**
+         * @brief 校准时的 UTC 时间，单位 ms。
+         */
+        int64_t _sync_epoch_ms{};
+        /**
+         * @brief 估计的频偏，单位 ppm。为正表示本地时钟偏慢。
+         */
+        int32_t _drift_ppm{};
+        /**
+         * @brief 估计频偏的起点：某次 GPS 校准时 Kernel::Clock 的时刻与
+         * UTC 时间，单位 ms。中间的网络时间校准不影响起点。
+         */
+        std::optional<clock::time_point> _anchor_time;
+        int64_t _anchor_epoch_ms{};
+
+    private:
+        int64_t epoch_ms_at(clock::time_point time) const
+        {
+            int64_t elapsed =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    time - _sync_time)
+                    .count();
+            return _sync_epoch_ms + elapsed + elapsed * _drift_ppm / 1000000;
+        }
+
+        /**
+         * @brief 与起点间隔足够长时，由两次 GPS 校准估计频偏，
+         * 并以本次校准作为新的起点。
+         */
+        void discipline(clock::time_point now, int64_t epoch_ms)
+        {
+            if (_anchor_time && now - *_anchor_time < min_discipline_interval)
+                return;
+            if (_anchor_time)
+            {
+                int64_t local_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now - *_anchor_time)
+                        .count();
+                int64_t drift_ppm =
+                    (epoch_ms - _anchor_epoch_ms - local_ms) * 1000000 /
+                    local_ms;
+                // 超出上限时认为是校准出错，不采用。
+                if (std::abs(drift_ppm) <= max_drift_ppm)
+                    _drift_ppm = static_cast<int32_t>(drift_ppm);
+            }
+            _anchor_time = now;
+            _anchor_epoch_ms = epoch_ms;
+        }
+
+    public:
+        /**
+         * @brief 校准时钟。来源不如当前的准确且当前的仍然可信时忽略。
+         *
+         * @param epoch 当前的 UNIX 时间戳，单位 s。
+         * @param source 时间的来源。
+         * @return bool 是否采用了该时间。
+         */
+        bool on_sync(int64_t epoch, source_t source)
+        {
+            auto now = clock::now();
+            rtos::ScopedMutexLock lock{_mutex};
+            if (source < _source && now - _sync_time < gps_holdover)
+                return false;
+            int64_t epoch_ms = epoch * 1000;
+            if (source == source_t::gps)
+                discipline(now, epoch_ms);
+            _source = source;
+            _sync_time = now;
+            _sync_epoch_ms = epoch_ms;
+            return true;
+        }
+        /**
+         * @brief 是否已校准。未校准时时间戳不可用。
+         */
+        bool is_valid() const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _source != source_t::none;
+        }
+        /**
+         * @brief 当前时间的来源。
+         */
+        source_t source() const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            return _source;
+        }
+        /**
+         * @brief 距离上次校准的时长。未校准时为最大值。
+         */
+        clock::duration since_sync() const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            if (_source == source_t::none)
+                return clock::duration::max();
+            return clock::now() - _sync_time;
+        }
+        /**
+         * @brief 给定时刻对应的 UNIX 时间戳，单位 ms。未校准时为 0。
+         *
+         * @param time Kernel::Clock 的时刻。可以早于校准的时刻，
+         * 用于给校准前记录的事件补上时间戳。
+         */
+        int64_t epoch_ms(clock::time_point time) const
+        {
+            rtos::ScopedMutexLock lock{_mutex};
+            if (_source == source_t::none)
+                return 0;
+            return epoch_ms_at(time);
+        }
+        /**
+         * @brief 当前的 UNIX 时间戳，单位 ms。未校准时为 0。
+         */
+        int64_t now_ms() const
+        {
+            return epoch_ms(clock::now());
+        }
+        /**
+         * @brief 当前的 UNIX 时间戳，单位 s。未校准时为 0。
+         */
+        int64_t now() const
+        {
+            return now_ms() / 1000;
+        }
+    };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+    /**
+     * @brief 全局的 UTC 时钟。
+     */
+    inline utc_clock utc;
+#pragma GCC diagnostic pop
+} // namespace utils
@@ -5,6 +5,7 @@ import threading
 from datetime import datetime, timedelta
 import requests
 from util.coord_trans import wgs84_to_gcj02
+from util.report import RECORD, parse_binary_reports
 
 
 HOST = '172.24.132.39'               # 允许任意host接入
@@ -34,15 +35,14 @@ def set_keepalive_linux(sock, after_idle_sec=1, interval_sec=3, max_fails=5):
 
 
 
-def deg2dec(deg, min, sec):
-    return deg + min/60 + sec/3600
-
-
-def degmin2deg(degmin):
-    deg_sep = degmin.find('.') - 2
-    deg = int(degmin[:deg_sep])
-    min = float(degmin[deg_sep:])
-    return deg2dec(deg, min, 0)
+def post_reports(data):
+    # 断开期间暂存的上报合并为一次发送，按时间顺序逐条上传
+    for t, latitude, longitude in parse_binary_reports(data):
+        longitude, latitude = wgs84_to_gcj02(longitude, latitude)
+        requests.post(CLOUDBASE + 'position',
+            json={"longitude": longitude, "latitude": latitude}) #注意这里是json=，否则会报500
+        print('debug:', t, longitude, latitude)
+    print(datetime.now())
 
 buzz_state = 0
 last_pulse_time = datetime.now() - timedelta(minutes=2)
@@ -58,36 +58,36 @@ while True:
 
         # 打印请求此次服务的客户端的地址
         print('...connection from: {}'.format(addr))
+        # 一次recv可能只收到一条上报的前半部分，留到下次
+        received = b''
         while True:
             # 通过客户socket获取客户端信息(bytes类型)，并解码为字符串类型
             try:
                 # 用于判别异常类型的flag
                 istimeout = False
 
-                # 维护心跳的计时
+                # 维护心跳的计时。每条指令以换行结束，设备按换行拆分
                 if datetime.now() - last_pulse_time > timedelta(minutes=1):
                     last_pulse_time = datetime.now()
-                    tcpCliSock.send('pulse'.encode('utf8'))
+                    tcpCliSock.send('pulse\n'.encode('utf8'))
 
                 # get云容器上保存的buzz信息
                 if requests.get(CLOUDBASE + 'buzz').json().get('data') == 1 and buzz_state == 0:
-                    tcpCliSock.send('buzz'.encode('utf8'))
+                    tcpCliSock.send('buzz\n'.encode('utf8'))
                     buzz_state = 1
                     print('1', end='')
                 else:
                     buzz_state = 0
                     print('0', end='')
 
-                data = tcpCliSock.recv(BUFSIZ).decode('utf8') # recv是阻塞的，所以发get请求应该放在前面
+                data = tcpCliSock.recv(BUFSIZ) # recv是阻塞的，所以发get请求应该放在前面
                 if data:
-                    latitude, longitude = data[data.rfind('pos:')+4:-1].split(',')
-                    longitude = degmin2deg(longitude)
-                    latitude = degmin2deg(latitude)
-                    longitude, latitude = wgs84_to_gcj02(longitude, latitude)
-                    x = requests.post(CLOUDBASE + 'position',
-                        json={"longitude": longitude, "latitude": latitude}) #注意这里是json=，否则会报500
-                    print('debug:', longitude, latitude)
-                    print(datetime.now())
+                    received += data
+                    # 上报是定长的二进制记录，处理到最后一条完整的记录
+                    end = len(received) - len(received) % RECORD.size
+                    if end:
+                        post_reports(received[:end])
+                        received = received[end:]
 
             except socket.timeout:
                 data = ''
@@ -0,0 +1,89 @@
+import socket
+from datetime import datetime
+import requests
+from util.coord_trans import wgs84_to_gcj02
+from util.report import parse_binary_reports
+
+
+HOST = '172.24.132.39'               # 与 tcpserver 使用相同的地址与端口
+PORT = 12345
+BUFSIZ = 1024
+ADDR = (HOST, PORT)
+
+CLOUDBASE = 'https://django-qix2-1901017-1311749828.ap-shanghai.run.tcloudbase.com/api/'
+
+udpSerSock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+udpSerSock.setsockopt(
+    socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)  # 强制使用端口，防止被占用的情况
+udpSerSock.bind(ADDR)   # 绑定地址
+
+
+def post_reports(content):
+    # 断开期间暂存的上报合并为一次发送，按时间顺序逐条上传
+    reports = parse_binary_reports(content)
+    if not reports:
+        raise ValueError(content)
+    for t, latitude, longitude in reports:
+        longitude, latitude = wgs84_to_gcj02(longitude, latitude)
+        requests.post(CLOUDBASE + 'position',
+                      json={"longitude": longitude, "latitude": latitude})  # 注意这里是json=，否则会报500
+        print('debug:', t, longitude, latitude)
+    print(datetime.now())
+
+
+def get_command():
+    """
+    @Description:
+    获取要捎带在确认中的指令。没有指令时为空字符串。
+    UDP 经过运营商的 NAT，服务器只能在收到上报后回复，不能主动发送指令或心跳。
+    """
+    global buzz_state
+    # get云容器上保存的buzz信息。获取失败时也要回复确认
+    try:
+        buzz = requests.get(CLOUDBASE + 'buzz').json().get('data')
+    except (requests.RequestException, ValueError):
+        return ''
+    if buzz == 1 and buzz_state == 0:
+        buzz_state = 1
+        return 'buzz'
+    buzz_state = 0
+    return ''
+
+
+buzz_state = 0
+# 每个地址最近一次处理的序号。重传的上报只再次确认，不重复处理。
+last_seq = {}
+
+print('waiting for datagram...')
+while True:
+    try:
+        data, addr = udpSerSock.recvfrom(BUFSIZ)
+        # 上报帧格式：<序号>|<内容>，内容是二进制上报
+        seq, sep, content = data.partition(b'|')
+        seq = seq.decode('utf8', errors='ignore')
+        if not sep or not seq.isdigit():
+            print('bad datagram from {}: {}'.format(addr, data))
+            continue
+
+        if last_seq.get(addr) != seq:
+            last_seq[addr] = seq
+            try:
+                post_reports(content)
+            except ValueError:
+                print('bad report from {}: {}'.format(addr, content))
+            except requests.RequestException:
+                # 不确认，设备稍后重传。
+                del last_seq[addr]
+                print('post failed')
+                continue
+
+        # 确认帧格式：ack <序号>[;<指令>]
+        reply = 'ack ' + seq
+        command = get_command()
+        if command:
+            reply += ';' + command
+        udpSerSock.sendto(reply.encode('utf8'), addr)
+    except KeyboardInterrupt:
+        udpSerSock.close()
+        print("closing")
+        break
@@ -0,0 +1,80 @@
+# -*- coding: utf-8 -*-
+
+import struct
+
+# 二进制上报：UNIX 时间戳（u32，未知时为 0）、纬度、经度（i32，1e-7 度），小端
+RECORD = struct.Struct('<Iii')
+
+
+def deg2dec(deg, min, sec):
+    return deg + min/60 + sec/3600
+
+
+def degmin2deg(degmin):
+    deg_sep = degmin.find('.') - 2
+    deg = int(degmin[:deg_sep])
+    min = float(degmin[deg_sep:])
+    return deg2dec(deg, min, 0)
+
+
+def parse_reports(data):
+    """
+    @Description:
+    拆分设备通过 MQTT 发布的文本上报。断开连接期间暂存的上报会合并为一次发送，
+    每条上报形如`t: <UNIX 时间戳>;pos: <纬度>,<经度>;`，时间可能没有。
+    ---------
+    @Returns:
+    按时间排序的`[(t, latitude, longitude)]`，经纬度为度，t 可能为 None。
+    没有时间的上报排在前一条上报之后。格式错误的部分被跳过。
+    -------
+    """
+
+    reports = []
+    t = None
+    for item in data.split(';'):
+        key, _, value = item.strip().partition(':')
+        try:
+            if key == 't':
+                t = int(value)
+            elif key == 'pos':
+                latitude, longitude = value.split(',')
+                reports.append((t, degmin2deg(latitude.strip()),
+                                degmin2deg(longitude.strip())))
+                t = None
+        except ValueError:
+            t = None
+
+    return sort_reports(reports)
+
+
+def parse_binary_reports(data):
+    """
+    @Description:
+    拆分设备一次发送的二进制上报。每条上报定长 RECORD.size 字节，
+    合并发送时直接拼接。
+    ---------
+    @Returns:
+    与 parse_reports 相同。末尾不足一条的部分被忽略，
+    由调用者留到下次。
+    -------
+    """
+
+    reports = []
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        t, latitude, longitude = RECORD.unpack_from(data, offset)
+        reports.append((t or None, latitude / 1e7, longitude / 1e7))
+    return sort_reports(reports)
+
+
+def sort_reports(reports):
+    """
+    @Description:
+    稳定排序。没有时间的上报沿用前一条上报的时间。
+    """
+
+    keys = []
+    for report in reports:
+        keys.append(report[0] if report[0] is not None
+                    else (keys[-1] if keys else 0))
+    order = sorted(range(len(reports)), key=lambda i: keys[i])
+    return [reports[i] for i in order]